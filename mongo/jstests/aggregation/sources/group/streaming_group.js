@@ -0,0 +1,61 @@
+/**
+ * Tests that a $group whose input comes from a covered index scan sorted on the group key is
+ * executed as a streaming $group, and that it returns the same groups as a blocking $group.
+ *
+ * Relies on the $match being pushed into the query system and on the explain output of an
+ * unsharded collection.
+ * @tags: [do_not_wrap_aggregations_in_facets, assumes_unsharded_collection]
+ */
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");  // For 'aggPlanHasStage'.
+
+    const coll = db.streaming_group;
+    coll.drop();
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 300; ++i) {
+        bulk.insert({_id: i, a: i % 3, b: i % 7, c: i});
+    }
+    // Equal numbers of different types, null and missing values must each form a single group.
+    bulk.insert({_id: 1000, a: 1, b: NumberLong(2)});
+    bulk.insert({_id: 1001, a: 1, b: NumberInt(2)});
+    bulk.insert({_id: 1002, a: 1, b: null});
+    bulk.insert({_id: 1003, a: 1});
+    bulk.insert({_id: 1004, a: 1, b: null});
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+
+    function sortById(results) {
+        return results.sort((x, y) => bsonWoCompare({_id: x._id}, {_id: y._id}));
+    }
+
+    function assertStreamingMatchesBlocking(pipeline, expectStreaming) {
+        const explain = coll.explain().aggregate(pipeline);
+        assert(!aggPlanHasStage(explain, "FETCH"), tojson(explain));
+        assert.eq(expectStreaming, tojson(explain.stages).indexOf("$streamingGroup") >= 0,
+                  tojson(explain));
+
+        // Hinting a collection scan makes the input unsorted, so the $group must block.
+        const expected = coll.aggregate(pipeline, {hint: {$natural: 1}}).toArray();
+        const actual = coll.aggregate(pipeline).toArray();
+        assert.eq(sortById(expected), sortById(actual));
+    }
+
+    assertStreamingMatchesBlocking([{$match: {a: 1}}, {$group: {_id: "$b", n: {$sum: 1}}}], true);
+    assertStreamingMatchesBlocking(
+        [{$match: {a: {$gte: 1}}}, {$group: {_id: {x: "$a", y: "$b"}, n: {$sum: 1}}}], true);
+    assertStreamingMatchesBlocking(
+        [{$match: {a: 1}}, {$group: {_id: "$b", lo: {$min: "$a"}, hi: {$max: "$b"}}}], true);
+
+    // A multikey index does not cover the query, so the documents must be grouped in memory.
+    assert.writeOK(coll.insert({_id: 2000, a: 1, b: [2, 6]}));
+    const explain =
+        coll.explain().aggregate([{$match: {a: 1}}, {$group: {_id: "$b", n: {$sum: 1}}}]);
+    assert(aggPlanHasStage(explain, "FETCH"), tojson(explain));
+    assert.eq(-1, tojson(explain.stages).indexOf("$streamingGroup"), tojson(explain));
+    const results =
+        coll.aggregate([{$match: {a: 1}}, {$group: {_id: "$b", n: {$sum: 1}}}]).toArray();
+    assert.eq(1, results.filter((group) => friendlyEqual(group._id, [2, 6])).length);
+}());
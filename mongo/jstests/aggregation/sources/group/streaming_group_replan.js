@@ -0,0 +1,48 @@
+/**
+ * Tests that a $group over a cached plan which provided the group-key sort does not stream once the
+ * cached plan is replanned to one which does not provide that sort.
+ *
+ * Relies on the plan cache and on the current replanning behaviour of the query planner.
+ * @tags: [do_not_wrap_aggregations_in_facets, assumes_unsharded_collection]
+ */
+(function() {
+    "use strict";
+
+    const coll = db.streaming_group_replan;
+    coll.drop();
+
+    // Both indexes cover the pipeline, but only a scan of {a: 1, b: 1, c: 1} with an equality on
+    // 'a' is sorted on 'b'.
+    assert.commandWorked(coll.createIndex({a: 1, b: 1, c: 1}));
+    assert.commandWorked(coll.createIndex({c: 1, a: 1, b: 1}));
+
+    // Ordered by 'c', the 'b' values alternate, so streaming over that order splits the groups.
+    for (let i = 0; i < 5; ++i) {
+        assert.writeOK(coll.insert({a: 1, b: 1000 + i % 2, c: i}));
+    }
+    for (let i = 0; i < 200; ++i) {
+        assert.writeOK(coll.insert({a: 2, b: i, c: 10 + i}));
+    }
+
+    const pipeline = [{$match: {a: 1, c: {$gte: 0}}}, {$group: {_id: "$b", n: {$sum: 1}}}];
+    const expected = [{_id: 1000, n: 3}, {_id: 1001, n: 2}];
+
+    function runPipeline() {
+        return coll.aggregate(pipeline).toArray().sort((x, y) => x._id - y._id);
+    }
+
+    // The scan on 'a' wins and is cached.
+    assert.eq(expected, runPipeline());
+
+    // Make the cached scan on 'a' examine many keys before producing a result, so that it is
+    // replanned, and make the scan on 'c' cheap, so that replanning picks it. Stay well below
+    // the number of writes which flushes the plan cache.
+    assert.writeOK(coll.remove({a: 2}));
+    for (let i = 0; i < 300; ++i) {
+        assert.writeOK(coll.insert({a: 1, b: i - 300, c: -1}));
+    }
+
+    assert.eq(expected, runPipeline());
+    assert.eq(expected, coll.aggregate(pipeline, {hint: {$natural: 1}}).toArray().sort(
+                            (x, y) => x._id - y._id));
+}());
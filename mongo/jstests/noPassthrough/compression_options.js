@@ -38,6 +38,7 @@
     assert.isnull(MongoRunner.runMongod({networkMessageCompressors: "snappy,disabled"}));
 
     runTest("snappy", ["snappy"]);
+    runTest("zlibDictionary,snappy", ["snappy"]);
     runTest("disabled", undefined);
     runTest("", undefined);
 
@@ -0,0 +1,71 @@
+// Tests that cursors opened with the find command's 'readAhead' option return the same results as
+// other cursors, that their batches are read ahead, and that they can still be killed.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("test");
+    const coll = testDB.cursor_read_ahead;
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, x: "x".repeat(100)});
+    }
+    assert.writeOK(bulk.execute());
+
+    function prefetchMetrics() {
+        return testDB.serverStatus().metrics.cursor.prefetch;
+    }
+
+    // Drains the cursor with getMore commands of 'batchSize' and returns the _ids it returned.
+    function drain(cmdRes, batchSize) {
+        let ids = cmdRes.cursor.firstBatch.map(doc => doc._id);
+        let cursorId = cmdRes.cursor.id;
+        while (cursorId != 0) {
+            const res = assert.commandWorked(testDB.runCommand(
+                {getMore: cursorId, collection: coll.getName(), batchSize: batchSize}));
+            ids = ids.concat(res.cursor.nextBatch.map(doc => doc._id));
+            cursorId = res.cursor.id;
+        }
+        return ids;
+    }
+
+    function find(batchSize, readAhead) {
+        return assert.commandWorked(testDB.runCommand(
+            {find: coll.getName(), sort: {_id: 1}, batchSize: batchSize, readAhead: readAhead}));
+    }
+
+    const expected = drain(find(7, false), 7);
+    assert.eq(1000, expected.length);
+
+    // A getMore waits for a running read-ahead of its cursor, so it finds its batch already read.
+    let before = prefetchMetrics();
+    assert.eq(expected, drain(find(7, true), 7));
+    let after = prefetchMetrics();
+    assert.gt(after.scheduled, before.scheduled, tojson(after));
+    assert.gt(after.hits, before.hits, tojson(after));
+    assert.eq(0, after.bufferedBytes, tojson(after));
+
+    // A getMore asking for smaller batches than were read ahead gets the rest on the next getMore.
+    assert.eq(expected, drain(find(50, true), 3));
+
+    // A cursor being read ahead can be killed, which releases what it buffered.
+    const res = find(10, true);
+    assert.commandWorked(
+        testDB.runCommand({killCursors: coll.getName(), cursors: [res.cursor.id]}));
+    assert.commandFailedWithCode(
+        testDB.runCommand({getMore: res.cursor.id, collection: coll.getName()}),
+        ErrorCodes.CursorNotFound);
+    assert.eq(0, prefetchMetrics().bufferedBytes);
+
+    // Read-ahead stops once cursors buffer more than cursorPrefetchMaxMemoryBytes.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, cursorPrefetchMaxMemoryBytes: 0}));
+    before = prefetchMetrics();
+    assert.eq(expected, drain(find(100, true), 100));
+    after = prefetchMetrics();
+    assert.eq(after.scheduled, before.scheduled, tojson(after));
+    assert.gt(after.overBudget, before.overBudget, tojson(after));
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,60 @@
+// Tests that a collection scan started while another is in progress joins it where it has got to,
+// wraps around at the end of the collection, and still returns every document once.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod(
+        {setParameter: {internalQueryExecEnableSharedCollectionScans: true}});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("test");
+
+    // MMAPv1 does not return records in RecordId order, so it never shares collection scans.
+    if (testDB.serverStatus().storageEngine.name === "mmapv1") {
+        MongoRunner.stopMongod(conn);
+        return;
+    }
+
+    const coll = testDB.shared_collection_scans;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; i++) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function collScanStage(explain) {
+        const plan = explain.queryPlanner.winningPlan;
+        assert.eq("COLLSCAN", plan.stage, tojson(explain));
+        return plan;
+    }
+
+    // Only scans that need not return documents in natural order are shared.
+    assert.eq(true, collScanStage(coll.find().explain()).sharedScan);
+    assert(!collScanStage(coll.find().hint({$natural: 1}).explain()).hasOwnProperty("sharedScan"));
+    assert(!collScanStage(coll.find().sort({$natural: 1}).explain()).hasOwnProperty("sharedScan"));
+
+    // Leave a scan part way through the collection.
+    const first = assert.commandWorked(
+        testDB.runCommand({find: coll.getName(), filter: {}, batchSize: 100}));
+    assert.eq(100, first.cursor.firstBatch.length);
+
+    assert.commandWorked(testDB.setProfilingLevel(2));
+    const ids = coll.find().comment("second scan").toArray().map(doc => doc._id);
+    assert.commandWorked(testDB.setProfilingLevel(0));
+
+    // The second scan starts where the first has got to and wraps around to read the rest.
+    assert.neq(0, ids[0], tojson(ids));
+    assert.eq(1000, ids.length);
+    ids.sort((a, b) => a - b);
+    for (let i = 0; i < 1000; i++) {
+        assert.eq(i, ids[i]);
+    }
+
+    // The plan summary reported by currentOp and the profiler shows that the scan is shared.
+    const profile = testDB.system.profile.findOne({"command.comment": "second scan"});
+    assert.neq(null, profile);
+    assert.eq("COLLSCAN (shared)", profile.planSummary, tojson(profile));
+
+    assert.commandWorked(
+        testDB.runCommand({killCursors: coll.getName(), cursors: [first.cursor.id]}));
+    MongoRunner.stopMongod(conn);
+}());
@@ -23,4 +23,18 @@
     if (m) {
         MongoRunner.stopMongod(m);
     }
+
+    m = MongoRunner.runMongod(
+        {dbpath: dbpath, transportLayer: 'asio', serviceExecutor: 'threadPerCore'});
+    assert(m, 'MongoDB with transportLayer=asio and serviceExecutor=threadPerCore failed to start up');
+    MongoRunner.stopMongod(m);
+
+    m = MongoRunner.runMongod(
+        {dbpath: dbpath, transportLayer: 'legacy', serviceExecutor: 'threadPerCore'});
+    assert.isnull(
+        m,
+        'MongoDB with transportLayer=legacy and serviceExecutor=threadPerCore managed to startup which is an unsupported combination');
+    if (m) {
+        MongoRunner.stopMongod(m);
+    }
 }());
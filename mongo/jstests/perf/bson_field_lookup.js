@@ -0,0 +1,49 @@
+/**
+ *  Measures insert throughput, which validates each document, and the throughput of collection
+ *  scans whose filters look up several fields of wide documents.
+ */
+
+var calls = 5;
+var size = 100000;
+var t = db.perf.bson_field_lookup;
+
+function makeDoc(i) {
+    var doc = {_id: i, name: "user" + i, email: "user" + i + "@example.com", age: i % 90};
+    doc.address = {street: i + " Main St", city: "city" + (i % 100), zip: "" + (10000 + i % 9000)};
+    doc.tags = ["t" + (i % 7), "t" + (i % 11), "t" + (i % 13)];
+    for (var j = 0; j < 30; j++) {
+        doc["attr" + j] = (i * 31 + j) % 1000;
+    }
+    return doc;
+}
+
+function insertDocs() {
+    t.drop();
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert(makeDoc(i));
+    }
+    assert.writeOK(bulk.execute());
+}
+
+// Each predicate looks up a different field, and the last fields of the document are the most
+// expensive to reach by scanning.
+var filter = {
+    attr29: {$gte: 0},
+    attr25: {$lt: 1000},
+    attr20: {$ne: -1},
+    age: {$lt: 50},
+    "address.city": {$ne: "nowhere"},
+    attr10: {$exists: true}
+};
+
+function runFind() {
+    return t.find(filter).itcount();
+}
+
+var insertTime = Date.timeFunc(insertDocs, 1);
+var expected = runFind();
+var findTime = Date.timeFunc(runFind, calls);
+
+print("insert: " + Math.round(size / insertTime) + " docs/ms   find: " +
+      Math.round(size / findTime) + " docs/ms   matched: " + expected);
@@ -0,0 +1,60 @@
+/**
+ *  Measures finds through mongos whose $in lists up to thousands of shard key values, against a
+ *  collection with many chunks, so that most of the time goes to targeting the chunks. The chunks
+ *  are written straight into the config metadata, because splitting that many chunks one at a
+ *  time would take far longer than the measurement itself.
+ */
+
+var numChunks = 200000;
+var inSizes = [10, 1000, 10000];
+var calls = 5;
+
+var st = new ShardingTest({shards: 2, mongos: 1, other: {enableBalancer: false}});
+var mongos = st.s0;
+var config = mongos.getDB("config");
+var ns = "perf.chunk_targeting";
+var t = mongos.getCollection(ns);
+
+assert.commandWorked(mongos.adminCommand({enableSharding: "perf"}));
+st.ensurePrimaryShard("perf", st.shard0.shardName);
+assert.commandWorked(mongos.adminCommand({shardCollection: ns, key: {x: 1}}));
+
+// Replace the single chunk with 'numChunks' chunks alternating between the two shards.
+var chunk = config.chunks.findOne({ns: ns});
+var shards = [st.shard0.shardName, st.shard1.shardName];
+assert.writeOK(config.chunks.remove({ns: ns}));
+
+var bulk = config.chunks.initializeUnorderedBulkOp();
+for (var i = 0; i < numChunks; i++) {
+    var min = (i === 0) ? {x: MinKey} : {x: i * 10};
+    var max = (i === numChunks - 1) ? {x: MaxKey} : {x: (i + 1) * 10};
+    bulk.insert({
+        _id: ns + "-x_" + i,
+        ns: ns,
+        min: min,
+        max: max,
+        shard: shards[i % 2],
+        lastmod: Timestamp(2, i),
+        lastmodEpoch: chunk.lastmodEpoch
+    });
+}
+assert.writeOK(bulk.execute());
+assert.commandWorked(mongos.adminCommand({flushRouterConfig: 1}));
+
+// Loads the new routing table on mongos and on both shards.
+t.find().itcount();
+
+inSizes.forEach(function(inSize) {
+    var values = [];
+    var step = Math.floor(numChunks * 10 / inSize);
+    for (var i = 0; i < inSize; i++) {
+        values.push(i * step + 5);
+    }
+
+    var time = Date.timeFunc(function() {
+        t.find({x: {$in: values}}).itcount();
+    }, calls);
+    print("$in of " + inSize + " values over " + numChunks + " chunks: " + time + "ms");
+});
+
+st.stop();
@@ -0,0 +1,45 @@
+/**
+ *  Measures foreground build time and on-disk size of a compound index whose keys share long
+ *  prefixes, for index versions 1 and 2 and with WiredTiger prefix compression on and off.
+ */
+
+var size = 500000;
+var t = db.perf.compound_index_build;
+
+function testSetup() {
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({
+            tenantId: "tenant-" + (i % 20),
+            userId: "user-" + (i % 5000),
+            ts: new Date(1500000000000 + i * 1000)
+        });
+    }
+    assert.writeOK(bulk.execute());
+}
+
+function buildIndex(name, options) {
+    var spec = Object.extend({name: name}, options);
+    var time = Date.timeFunc(function() {
+        assert.commandWorked(t.createIndex({tenantId: 1, userId: 1, ts: 1}, spec));
+    }, 1);
+    var indexSize = t.stats().indexSizes[name];
+    assert.commandWorked(t.dropIndex(name));
+    return {time: time, size: indexSize};
+}
+
+testSetup();
+
+var configs = {
+    v1: {v: 1},
+    v2: {v: 2},
+    v2_no_prefix_compression:
+        {v: 2, storageEngine: {wiredTiger: {configString: "prefix_compression=false"}}}
+};
+
+for (var name in configs) {
+    var result = buildIndex(name, configs[name]);
+    print(name + ": " + result.time + "ms   " + Math.round(result.size / 1024) + "KB");
+}
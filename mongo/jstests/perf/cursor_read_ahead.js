@@ -0,0 +1,48 @@
+/**
+ *  Compares the time to drain a large result set in small batches with and without the find
+ *  command's readAhead option, and prints the read-ahead hit counters.
+ */
+
+var calls = 5;
+var size = 200000;
+var batchSize = 1000;
+var t = db.perf.cursor_read_ahead;
+
+function testSetup() {
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({_id: i, a: i % 100, s: "abcdefghijklmnopqrstuvwxyz" + i});
+    }
+    assert.writeOK(bulk.execute());
+}
+
+function drain(readAhead) {
+    var res = assert.commandWorked(db.runCommand(
+        {find: t.getName(), filter: {a: {$lt: 50}}, batchSize: batchSize, readAhead: readAhead}));
+    var n = res.cursor.firstBatch.length;
+    var cursorId = res.cursor.id;
+    while (cursorId != 0) {
+        res = assert.commandWorked(
+            db.runCommand({getMore: cursorId, collection: t.getName(), batchSize: batchSize}));
+        n += res.cursor.nextBatch.length;
+        cursorId = res.cursor.id;
+    }
+    return n;
+}
+
+testSetup();
+
+var expected = drain(false);
+assert.eq(expected, drain(true));
+
+var plain = Date.timeFunc(function() {
+    drain(false);
+}, calls);
+var readAhead = Date.timeFunc(function() {
+    drain(true);
+}, calls);
+
+print("no read-ahead: " + plain + "ms   read-ahead: " + readAhead + "ms");
+printjson(db.serverStatus().metrics.cursor.prefetch);
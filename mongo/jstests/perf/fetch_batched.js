@@ -0,0 +1,43 @@
+/**
+ *  Compares fetching documents one at a time and in batches read in RecordId order, for an index
+ *  scan whose keys are in a random order relative to the documents.
+ */
+
+var calls = 5;
+var size = 500000;
+var t = db.perf.fetch_batched;
+
+function testSetup() {
+    t.drop();
+
+    var padding = "x".repeat(200);
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({r: Math.random(), padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.createIndex({r: 1}));
+}
+
+function setFetchBatchSize(batchSize) {
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalQueryExecFetchBatchSize: batchSize}));
+}
+
+function runFind() {
+    return t.find({r: {$gte: 0.25, $lt: 0.75}}).hint({r: 1}).itcount();
+}
+
+testSetup();
+
+setFetchBatchSize(1);
+var expected = runFind();
+var oneAtATime = Date.timeFunc(runFind, calls);
+
+setFetchBatchSize(256);
+assert.eq(expected, runFind());
+var batched = Date.timeFunc(runFind, calls);
+
+setFetchBatchSize(1);
+
+print("one at a time: " + oneAtATime + "ms   batched: " + batched + "ms");
@@ -0,0 +1,53 @@
+/**
+ *  Compares row-at-a-time and batched execution of a $group over field paths.
+ */
+
+var calls = 5;
+var size = 500000;
+var t = db.perf.group_batched;
+
+function testSetup() {
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({k: i % 1000, x: i, y: i % 7});
+    }
+    assert.writeOK(bulk.execute());
+}
+
+function setBatchedExecution(enabled) {
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalDocumentSourceGroupEnableBatchedExecution: enabled}));
+}
+
+var pipeline = [{
+    $group: {
+        _id: "$k",
+        total: {$sum: "$x"},
+        mean: {$avg: "$x"},
+        smallest: {$min: "$y"},
+        largest: {$max: "$y"},
+        count: {$sum: 1}
+    }
+}];
+
+function runGroup() {
+    return t.aggregate(pipeline).toArray().sort(function(a, b) {
+        return a._id - b._id;
+    });
+}
+
+testSetup();
+
+setBatchedExecution(false);
+var expected = runGroup();
+var rowAtATime = Date.timeFunc(runGroup, calls);
+
+setBatchedExecution(true);
+assert.eq(expected, runGroup());
+var batched = Date.timeFunc(runGroup, calls);
+
+setBatchedExecution(false);
+
+print("row at a time: " + rowAtATime + "ms   batched: " + batched + "ms");
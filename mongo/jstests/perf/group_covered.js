@@ -0,0 +1,36 @@
+/**
+ *  Measures a $match and $group answered by a covered index scan, which groups the documents as
+ *  they stream in, against the same pipeline grouping the documents of a collection scan in
+ *  memory.
+ */
+
+var calls = 5;
+var size = 500000;
+var t = db.perf.group_covered;
+
+function testSetup() {
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({a: i % 4, b: i % 50000, payload: "x".repeat(200)});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.createIndex({a: 1, b: 1}));
+}
+
+var pipeline = [{$match: {a: 1}}, {$group: {_id: "$b", n: {$sum: 1}}}];
+
+function runGroup(options) {
+    return function() {
+        t.aggregate(pipeline, options).itcount();
+    };
+}
+
+testSetup();
+
+var coveredTime = Date.timeFunc(runGroup({}), calls);
+var scanTime = Date.timeFunc(runGroup({hint: {$natural: 1}}), calls);
+
+print("covered streaming $group: " + coveredTime + "ms   collection scan $group: " + scanTime +
+      "ms");
@@ -0,0 +1,49 @@
+/**
+ *  Compares the throughput of short reads and updates over many connections for each service
+ *  executor, and prints the per-worker statistics of the threadPerCore executor.
+ */
+
+var seconds = 10;
+var connectionCounts = [64, 512];
+var executors = ["synchronous", "adaptive", "threadPerCore"];
+
+function runWorkload(conn, parallel) {
+    var t = conn.getDB("perf").service_executor;
+    t.drop();
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(t.insert({_id: i, x: 0}));
+    }
+
+    var res = benchRun({
+        ops: [
+            {op: "findOne", ns: t.getFullName(), query: {_id: {"#RAND_INT": [0, 100]}}},
+            {
+              op: "update",
+              ns: t.getFullName(),
+              query: {_id: {"#RAND_INT": [0, 100]}},
+              update: {$inc: {x: 1}}
+            }
+        ],
+        parallel: parallel,
+        seconds: seconds,
+        host: conn.host
+    });
+    return Math.round(res.findOne + res.update);
+}
+
+executors.forEach(function(executor) {
+    var conn = MongoRunner.runMongod({serviceExecutor: executor});
+    assert.neq(null, conn, "mongod failed to start with serviceExecutor " + executor);
+
+    connectionCounts.forEach(function(parallel) {
+        print(executor + " with " + parallel + " connections: " + runWorkload(conn, parallel) +
+              " ops/sec");
+    });
+
+    if (executor === "threadPerCore") {
+        var stats = conn.getDB("admin").serverStatus().network.serviceExecutorTaskStats;
+        printjson(stats);
+    }
+
+    MongoRunner.stopMongod(conn);
+});
@@ -0,0 +1,51 @@
+/**
+ *  Measures the throughput of concurrent full scans of a collection larger than the WiredTiger
+ *  cache, with and without shared collection scans.
+ */
+
+var seconds = 20;
+var parallel = 8;
+var size = 2000000;
+var conn = MongoRunner.runMongod({wiredTigerCacheSizeGB: 0.25});
+assert.neq(null, conn, "mongod failed to start");
+var t = conn.getDB("perf").shared_collection_scan;
+
+function testSetup() {
+    t.drop();
+
+    var padding = "x".repeat(500);
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({_id: i, x: i % 1000, padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+}
+
+function setSharedScans(enabled) {
+    assert.commandWorked(conn.getDB("admin").runCommand(
+        {setParameter: 1, internalQueryExecEnableSharedCollectionScans: enabled}));
+}
+
+function runScans() {
+    var res = benchRun({
+        ops: [{op: "find", ns: t.getFullName(), query: {x: -1}}],
+        parallel: parallel,
+        seconds: seconds,
+        host: conn.host
+    });
+    return res.query;
+}
+
+testSetup();
+
+setSharedScans(false);
+var independent = runScans();
+
+setSharedScans(true);
+var shared = runScans();
+
+setSharedScans(false);
+
+print("independent: " + independent + " scans/sec   shared: " + shared + " scans/sec");
+
+MongoRunner.stopMongod(conn);
@@ -0,0 +1,50 @@
+/**
+ *  Measures the throughput of the external sorter by building an index whose keys do not fit in
+ *  memory under several index build memory limits, and by sorting the same data with allowDiskUse.
+ */
+
+var size = 1000000;
+var memoryLimitsMB = [100, 200, 400];
+var t = db.perf.sorter_spill;
+
+function testSetup() {
+    t.drop();
+
+    var padding = new Array(100).join("x");
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({k: Random.rand() + padding, n: i});
+    }
+    assert.writeOK(bulk.execute());
+}
+
+function setMemoryLimitMB(megabytes) {
+    var res = db.adminCommand({setParameter: 1, maxIndexBuildMemoryUsageMegabytes: megabytes});
+    assert.commandWorked(res);
+    return res.was;
+}
+
+function buildIndex() {
+    assert.commandWorked(t.createIndex({k: 1}));
+    assert.commandWorked(t.dropIndex({k: 1}));
+}
+
+function sortWithDiskUse() {
+    var pipeline = [{$sort: {k: 1}}, {$group: {_id: null, count: {$sum: 1}}}];
+    var res = t.aggregate(pipeline, {allowDiskUse: true}).toArray();
+    assert.eq(size, res[0].count);
+}
+
+Random.setRandomSeed();
+testSetup();
+
+var originalLimit = setMemoryLimitMB(memoryLimitsMB[0]);
+memoryLimitsMB.forEach(function(megabytes) {
+    setMemoryLimitMB(megabytes);
+    var time = Date.timeFunc(buildIndex, 1);
+    print("index build with " + megabytes + "MB: " + Math.round(size / time) + " docs/ms");
+});
+setMemoryLimitMB(originalLimit);
+
+print("$sort with allowDiskUse: " + Math.round(size / Date.timeFunc(sortWithDiskUse, 1)) +
+      " docs/ms");
@@ -0,0 +1,46 @@
+// Tests that a chunk cloned by several streams at once, with a throttle on the clone rate, arrives
+// complete on the recipient shard, and that the throttle can be changed while the migration runs.
+(function() {
+    "use strict";
+
+    var st = new ShardingTest({shards: 2});
+    var testDB = st.s.getDB("test");
+    var coll = testDB.migration_parallel_clone;
+
+    assert.commandWorked(testDB.adminCommand({enableSharding: testDB.getName()}));
+    st.ensurePrimaryShard(testDB.getName(), st.shard0.shardName);
+    assert.commandWorked(testDB.adminCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+
+    var numDocs = 5000;
+    var padding = "x".repeat(1000);
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, x: i, padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+
+    var recipient = st.shard1;
+    assert.commandWorked(recipient.adminCommand({setParameter: 1, migrateCloneFetchStreams: 4}));
+
+    // At 1MB per second, cloning the 5MB chunk takes several seconds until the limit is lifted.
+    assert.commandWorked(
+        recipient.adminCommand({setParameter: 1, migrateCloneMaxBytesPerSec: 1024 * 1024}));
+
+    var awaitMoveChunk = startParallelShell(
+        "assert.commandWorked(db.adminCommand({moveChunk: " + tojson(coll.getFullName()) +
+            ", find: {x: 0}, to: " + tojson(recipient.shardName) + ", _waitForDelete: true}));",
+        st.s.port);
+
+    assert.soon(function() {
+        var status = recipient.adminCommand({_recvChunkStatus: 1});
+        return status.active && status.counts.cloned > 0;
+    });
+    assert.commandWorked(recipient.adminCommand({setParameter: 1, migrateCloneMaxBytesPerSec: 0}));
+    awaitMoveChunk();
+
+    assert.eq(0, st.shard0.getCollection(coll.getFullName()).count());
+    assert.eq(numDocs, recipient.getCollection(coll.getFullName()).count());
+    assert.eq(numDocs, coll.find().itcount());
+
+    st.stop();
+})();
@@ -32,6 +32,8 @@
 
 #include "mongo/db/catalog/index_create_impl.h"
 
+#include <deque>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/init.h"
 #include "mongo/client/dbclientinterface.h"
@@ -48,7 +50,9 @@
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -122,6 +126,26 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+// The memory that maxIndexBuildMemoryUsageMegabytes allows is divided between the threads.
+AtomicInt32 maxIndexBuildThreads(1);
+
+class ExportedMaxIndexBuildThreadsParameter
+    : public ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedMaxIndexBuildThreadsParameter()
+        : ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(), "maxIndexBuildThreads", &maxIndexBuildThreads) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue, "maxIndexBuildThreads must be between 1 and 64");
+        }
+
+        return Status::OK();
+    }
+
+} exportedMaxIndexBuildThreadsParameter;
+
 
 /**
  * On rollback sets MultiIndexBlockImpl::_needToCleanup to true.
@@ -157,6 +181,160 @@ private:
     MultiIndexBlockImpl* const _indexer;
 };
 
+/**
+ * Generates the keys of a foreground index build on several threads. The collection scan stays on
+ * the thread running the build, which hands the documents it reads to the workers in batches. Each
+ * worker feeds its own BulkBuilder for every index, so that every worker produces an independent
+ * sorted run over a disjoint set of records.
+ */
+class MultiIndexBlockImpl::ParallelKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+
+public:
+    // A batch is handed to the workers once it holds this many documents or bytes.
+    static const size_t kMaxBatchDocuments = 1024;
+    static const size_t kMaxBatchBytes = 1024 * 1024;
+
+    ParallelKeyGenerator(std::vector<IndexToBuild>* indexes, size_t numThreads)
+        : _indexes(indexes) {
+        for (size_t worker = 0; worker < numThreads; ++worker) {
+            _threads.emplace_back([this, worker] { _generateKeys(worker); });
+        }
+    }
+
+    ~ParallelKeyGenerator() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _queue.clear();
+            _shutdown = true;
+        }
+        _batchAvailable.notify_all();
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Queues 'doc' for key generation. Returns the first error any worker has encountered.
+     */
+    Status insert(const BSONObj& doc, const RecordId& loc) {
+        _batch.emplace_back(doc.getOwned(), loc);
+        _batchBytes += doc.objsize();
+        if (_batch.size() < kMaxBatchDocuments && _batchBytes < kMaxBatchBytes) {
+            return Status::OK();
+        }
+        return _pushBatch();
+    }
+
+    /**
+     * Waits until the keys of every queued document have been generated.
+     */
+    Status finish() {
+        Status status = _pushBatch();
+        if (!status.isOK()) {
+            return status;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _workerProgress.wait(
+            lk, [this] { return (_queue.empty() && _busyWorkers == 0) || !_status.isOK(); });
+        return _status;
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    Status _pushBatch() {
+        Batch batch;
+        batch.swap(_batch);
+        _batchBytes = 0;
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        // Keep at most two batches per worker queued, which bounds the memory used by documents
+        // that have been read but not yet indexed.
+        _workerProgress.wait(
+            lk, [this] { return _queue.size() < 2 * _threads.size() || !_status.isOK(); });
+        if (!_status.isOK()) {
+            return _status;
+        }
+        if (!batch.empty()) {
+            _queue.push_back(std::move(batch));
+            _batchAvailable.notify_one();
+        }
+        return Status::OK();
+    }
+
+    void _generateKeys(size_t worker) {
+        while (true) {
+            Batch batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _batchAvailable.wait(lk, [this] { return _shutdown || !_queue.empty(); });
+                if (_shutdown) {
+                    return;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+                ++_busyWorkers;
+            }
+            _workerProgress.notify_all();
+
+            Status status = Status::OK();
+            try {
+                for (const auto& doc : batch) {
+                    _insert(worker, doc.first, doc.second);
+                }
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                --_busyWorkers;
+                if (_status.isOK()) {
+                    _status = status;
+                }
+            }
+            _workerProgress.notify_all();
+        }
+    }
+
+    void _insert(size_t worker, const BSONObj& doc, const RecordId& loc) {
+        for (auto& index : *_indexes) {
+            if (index.filterExpression && !index.filterExpression->matchesBSON(doc)) {
+                continue;
+            }
+
+            auto& bulk = worker == 0 ? index.bulk : index.workerBulks[worker - 1];
+            int64_t unused;
+            // BulkBuilder::insert() does not use its OperationContext, which belongs to the
+            // thread running the index build.
+            uassertStatusOK(bulk->insert(nullptr, doc, loc, index.options, &unused));
+        }
+    }
+
+    std::vector<IndexToBuild>* const _indexes;
+
+    // The batch the collection scan is filling. Only used by the thread running the build.
+    Batch _batch;
+    size_t _batchBytes = 0;
+
+    std::vector<stdx::thread> _threads;
+
+    stdx::mutex _mutex;
+
+    // Signaled when a batch is queued or the workers must exit.
+    stdx::condition_variable _batchAvailable;
+
+    // Signaled when a worker takes a batch off the queue or finishes one.
+    stdx::condition_variable _workerProgress;
+
+    std::deque<Batch> _queue;
+    size_t _busyWorkers = 0;
+    Status _status = Status::OK();
+    bool _shutdown = false;
+};
+
 MultiIndexBlockImpl::MultiIndexBlockImpl(OperationContext* opCtx, Collection* collection)
     : _collection(collection),
       _opCtx(opCtx),
@@ -325,13 +503,15 @@ db.things.ensureIndex({name:1}, {background:true});
 	//Ϣ
     indexInfoObjs.reserve(indexSpecs.size());
     std::size_t eachIndexBuildMaxMemoryUsageBytes = 0;
+    _keyGenerationThreads =
+        _buildInBackground ? 1 : static_cast<size_t>(maxIndexBuildThreads.load());
     if (!indexSpecs.empty()) {
 		//һͬʱֻʹôڴ棬
 		//ڴΪ500Mͬʱ5ÿʹ100M
 		
         eachIndexBuildMaxMemoryUsageBytes =
             static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
-            indexSpecs.size();
+            indexSpecs.size() / _keyGenerationThreads;
     }
 
     for (size_t i = 0; i < indexSpecs.size(); i++) {
@@ -370,6 +550,10 @@ db.things.ensureIndex({name:1}, {background:true});
             // under it.
             //IndexAccessMethod::initiateBulk  bulkʼһBulkBuilder
             index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes);
+            for (size_t worker = 1; worker < _keyGenerationThreads; ++worker) {
+                index.workerBulks.push_back(
+                    index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes));
+            }
         }
 
 		//ȡӦIndexDescriptor
@@ -386,8 +570,10 @@ db.things.ensureIndex({name:1}, {background:true});
 		
 		log() << "build index on: " << ns << " properties: " << descriptor->toString();
         if (index.bulk)
-            log() << "\t building index using bulk method; build may temporarily use up to "
-                  << eachIndexBuildMaxMemoryUsageBytes / 1024 / 1024 << " megabytes of RAM";
+            log() << "\t building index using bulk method on " << _keyGenerationThreads
+                  << " thread(s); build may temporarily use up to "
+                  << eachIndexBuildMaxMemoryUsageBytes * _keyGenerationThreads / 1024 / 1024
+                  << " megabytes of RAM";
 
         index.filterExpression = index.block->getEntry()->getFilterExpression();
 
@@ -466,6 +652,11 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
     auto exec =
         InternalPlanner::collectionScan(_opCtx, _collection->ns().ns(), _collection, yieldPolicy);
 
+    std::unique_ptr<ParallelKeyGenerator> keyGenerator;
+    if (_keyGenerationThreads > 1) {
+        keyGenerator = stdx::make_unique<ParallelKeyGenerator>(&_indexes, _keyGenerationThreads);
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -503,7 +694,8 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
 
             WriteUnitOfWork wunit(_opCtx);
 			//ÿݶӦһKVKVд洢
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret = keyGenerator ? keyGenerator->insert(objToIndex.value(), loc)
+                                      : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (ret.isOK()) {
@@ -552,6 +744,13 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
                 WorkingSetCommon::toStatusString(objToIndex.value()),
             state == PlanExecutor::IS_EOF);
 
+    if (keyGenerator) {
+        Status status = keyGenerator->finish();
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
     if (MONGO_FAIL_POINT(hangAfterStartingIndexBuildUnlocked)) {
         // Unlock before hanging so replication recognizes we've completed.
         Locker::LockSnapshot lockInfo;
@@ -647,8 +846,15 @@ Status MultiIndexBlockImpl::doneInserting(std::set<RecordId>* dupsOut) {
                << _indexes[i].block->getEntry()->descriptor()->indexName();
 		//MultiIndexBlockImpl::insertӿĶ
 		//IndexAccessMethod::commitBulkbulkʽдKV洢
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulks;
+        bulks.push_back(std::move(_indexes[i].bulk));
+        for (auto& workerBulk : _indexes[i].workerBulks) {
+            bulks.push_back(std::move(workerBulk));
+        }
+        _indexes[i].workerBulks.clear();
+
         Status status = _indexes[i].real->commitBulk(_opCtx,
-                                                     std::move(_indexes[i].bulk),
+                                                     std::move(bulks),
                                                      _allowInterruption,
                                                      _indexes[i].options.dupsAllowed,
                                                      dupsOut);
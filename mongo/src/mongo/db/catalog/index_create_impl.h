@@ -41,6 +41,7 @@
 #include "mongo/db/catalog/index_catalog_impl.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -49,6 +50,9 @@ class BSONObj;
 class Collection;
 class OperationContext;
 
+// The number of threads a foreground index build generates and sorts keys on.
+extern AtomicInt32 maxIndexBuildThreads;
+
 /**
  * Builds one or more indexes.
  *
@@ -219,6 +223,7 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelKeyGenerator;
 
     //MultiIndexBlockImpl._indexesΪͣ_indexes
     //MultiIndexBlockImpl::initʼ
@@ -236,6 +241,10 @@ private:
         //ӦBulkBuilder,
         std::unique_ptr<IndexAccessMethod::BulkBuilder> bulk;
 
+        // One more BulkBuilder for each additional thread generating keys for a foreground build.
+        // Each holds an independent sorted run that is merged with 'bulk' by doneInserting().
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> workerBulks;
+
         InsertDeleteOptions options;
     };
 
@@ -259,6 +268,10 @@ private:
     bool _ignoreUnique;
 
     bool _needToCleanup;
+
+    // The number of threads insertAllDocumentsInCollection() generates keys on. Always 1 for
+    // background builds.
+    size_t _keyGenerationThreads = 1;
 };
 
 }  // namespace mongo
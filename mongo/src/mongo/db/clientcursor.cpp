@@ -62,6 +62,7 @@ static Counter64 cursorStatsOpen;           // gauge
 static Counter64 cursorStatsOpenPinned;     // gauge
 static Counter64 cursorStatsOpenNoTimeout;  // gauge
 static Counter64 cursorStatsTimedOut;
+static Counter64 cursorStatsPrefetchedBytes;  // gauge
 
 static ServerStatusMetricField<Counter64> dCursorStatsOpen("cursor.open.total", &cursorStatsOpen);
 static ServerStatusMetricField<Counter64> dCursorStatsOpenPinned("cursor.open.pinned",
@@ -70,11 +71,17 @@ static ServerStatusMetricField<Counter64> dCursorStatsOpenNoTimeout("cursor.open
                                                                     &cursorStatsOpenNoTimeout);
 static ServerStatusMetricField<Counter64> dCursorStatusTimedout("cursor.timedOut",
                                                                 &cursorStatsTimedOut);
+static ServerStatusMetricField<Counter64> dCursorStatsPrefetchedBytes(
+    "cursor.prefetch.bufferedBytes", &cursorStatsPrefetchedBytes);
 
 long long ClientCursor::totalOpen() {
     return cursorStatsOpen.get();
 }
 
+long long ClientCursor::totalPrefetchedBytes() {
+    return cursorStatsPrefetchedBytes.get();
+}
+
 ClientCursor::ClientCursor(ClientCursorParams params,
                            CursorManager* cursorManager,
                            CursorId cursorId,
@@ -111,6 +118,7 @@ ClientCursor::~ClientCursor() {
     if (isNoTimeout()) {
         cursorStatsOpenNoTimeout.decrement();
     }
+    cursorStatsPrefetchedBytes.decrement(_prefetchedBytes);
 }
 
 void ClientCursor::markAsKilled(const std::string& reason) {
@@ -126,6 +134,45 @@ void ClientCursor::dispose(OperationContext* opCtx) {
     _disposed = true;
 }
 
+PlanExecutor::ExecState ClientCursor::getNext(BSONObj* objOut) {
+    if (!_prefetched.empty()) {
+        *objOut = std::move(_prefetched.front());
+        _prefetched.pop_front();
+        _prefetchedBytes -= objOut->objsize();
+        cursorStatsPrefetchedBytes.decrement(objOut->objsize());
+        return PlanExecutor::ADVANCED;
+    }
+
+    if (_prefetchErrorState) {
+        const auto state = *_prefetchErrorState;
+        _prefetchErrorState = boost::none;
+        *objOut = std::move(_prefetchError);
+        _prefetchError = BSONObj();
+        return state;
+    }
+
+    return _exec->getNext(objOut, nullptr);
+}
+
+void ClientCursor::stashNext(const BSONObj& obj) {
+    _prefetched.push_front(obj.getOwned());
+    _prefetchedBytes += obj.objsize();
+    cursorStatsPrefetchedBytes.increment(obj.objsize());
+}
+
+void ClientCursor::appendPrefetched(const BSONObj& obj) {
+    invariant(!_prefetchErrorState);
+    _prefetched.push_back(obj.getOwned());
+    _prefetchedBytes += obj.objsize();
+    cursorStatsPrefetchedBytes.increment(obj.objsize());
+}
+
+void ClientCursor::setPrefetchError(PlanExecutor::ExecState state, const BSONObj& errorObj) {
+    invariant(state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD);
+    _prefetchErrorState = state;
+    _prefetchError = errorObj.getOwned();
+}
+
 void ClientCursor::updateSlaveLocation(OperationContext* opCtx) {
     if (_slaveReadTill.isNull())
         return;
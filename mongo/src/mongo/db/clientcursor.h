@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/auth/user_name.h"
@@ -207,6 +208,51 @@ public:
         _leftoverMaxTimeMicros = leftoverMaxTimeMicros;
     }
 
+    //
+    // Read-ahead.
+    //
+
+    /**
+     * Returns the next result of this cursor, with the same contract as PlanExecutor::getNext().
+     * Results that a CursorPrefetcher read ahead of this getMore come first, followed by the error
+     * which stopped the read-ahead, if any. Only then is the PlanExecutor run.
+     */
+    PlanExecutor::ExecState getNext(BSONObj* objOut);
+
+    /**
+     * Puts 'obj' back at the front of this cursor's results, so that the next call to getNext()
+     * returns it. Used for a result which does not fit in the batch being built.
+     */
+    void stashNext(const BSONObj& obj);
+
+    /**
+     * Appends a result read ahead of the next getMore. Only used by the CursorPrefetcher.
+     */
+    void appendPrefetched(const BSONObj& obj);
+
+    /**
+     * Records the error which stopped a read-ahead, to be returned by getNext() after the results
+     * read before it. Only used by the CursorPrefetcher.
+     */
+    void setPrefetchError(PlanExecutor::ExecState state, const BSONObj& errorObj);
+
+    bool hasPrefetchedResults() const {
+        return !_prefetched.empty() || _prefetchErrorState;
+    }
+
+    std::size_t numPrefetched() const {
+        return _prefetched.size();
+    }
+
+    long long prefetchedBytes() const {
+        return _prefetchedBytes;
+    }
+
+    /**
+     * Returns the number of bytes of read-ahead results held by all cursors on this server.
+     */
+    static long long totalPrefetchedBytes();
+
     //
     // Replication-related methods.
     //
@@ -322,6 +368,13 @@ private:
     // The underlying query execution machinery. Must be non-null.
     std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _exec;
 
+    // Results read ahead of the next getMore, their total size, and the error which stopped the
+    // read-ahead, if any. They are returned by getNext() before the PlanExecutor is run again.
+    std::deque<BSONObj> _prefetched;
+    long long _prefetchedBytes = 0;
+    boost::optional<PlanExecutor::ExecState> _prefetchErrorState;
+    BSONObj _prefetchError;
+
     //
     // The following fields are used by the CursorManager and the ClientCursorPin. In most
     // conditions, they can only be used while holding the CursorManager's mutex. Exceptions
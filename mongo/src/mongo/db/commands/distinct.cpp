@@ -32,6 +32,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_arena.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/find_common.h"
@@ -213,7 +215,14 @@ public:
         char* start = bb.buf();
 
         BSONArrayBuilder arr(bb);
-        BSONElementSet values(executor.getValue()->getCanonicalQuery()->getCollator());
+
+        // The set of values seen so far is discarded when the command returns, so its nodes come
+        // from the operation's arena rather than being freed one at a time.
+        using DistinctValueSet = std::
+            set<BSONElement, BSONElementCmpWithoutField, OperationArenaAllocator<BSONElement>>;
+        DistinctValueSet values(
+            BSONElementCmpWithoutField(executor.getValue()->getCanonicalQuery()->getCollator()),
+            OperationArenaAllocator<BSONElement>(OperationArena::get(opCtx)));
 
         BSONObj obj;
         PlanExecutor::ExecState state;
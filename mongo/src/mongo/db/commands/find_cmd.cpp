@@ -37,6 +37,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/run_aggregate.h"
 #include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
@@ -458,6 +459,10 @@ pad: "	  13080577566-76793693218-00011035587-01443926745-80818518372", yangtest1
 
             // Fill out curop based on the results.
             endQueryOp(opCtx, collection, *cursorExec, numResults, cursorId);
+
+            // Start reading the second batch while the client consumes the first.
+            CursorPrefetcher::get(opCtx).schedule(
+                opCtx, &pinnedCursor, originalQR.getBatchSize());
         } else {
             endQueryOp(opCtx, collection, *exec, numResults, cursorId);
         }
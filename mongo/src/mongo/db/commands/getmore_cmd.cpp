@@ -41,6 +41,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/cursor_manager.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/cursor_response.h"
@@ -168,6 +169,10 @@ public:
             }
         }
 
+        // A read-ahead of this cursor's next batch may still hold the cursor pinned. It takes the
+        // collection lock, so wait for it before taking any lock ourselves.
+        CursorPrefetcher::get(opCtx).waitForIdle(opCtx, request.cursorid);
+
         // Cursors come in one of two flavors:
         // - Cursors owned by the collection cursor manager, such as those generated via the find
         //   command. For these cursors, we hold the appropriate collection lock for the duration of
@@ -224,6 +229,7 @@ public:
         }
 
         ClientCursor* cursor = ccPin.getValue().getCursor();
+        CursorPrefetcher::recordGetMore(*cursor);
 
         // If the fail point is enabled, busy wait until it is disabled.
         while (MONGO_FAIL_POINT(keepCursorPinnedDuringGetMore)) {
@@ -386,6 +392,9 @@ public:
 
         if (respondWithId) {
             cursorFreer.Dismiss();
+
+            // Start reading the next batch while the client consumes this one.
+            CursorPrefetcher::get(opCtx).schedule(opCtx, &ccPin.getValue(), request.batchSize);
         }
 
         return true;
@@ -432,11 +441,11 @@ public:
         BSONObj obj;
         try {
             while (!FindCommon::enoughForGetMore(request.batchSize.value_or(0), *numResults) &&
-                   PlanExecutor::ADVANCED == (*state = exec->getNext(&obj, NULL))) {
+                   PlanExecutor::ADVANCED == (*state = cursor->getNext(&obj))) {
                 // If adding this object will cause us to exceed the message size limit, then we
                 // stash it for later.
                 if (!FindCommon::haveSpaceForNext(obj, *numResults, nextBatch->bytesUsed())) {
-                    exec->enqueue(obj);
+                    cursor->stashNext(obj);
                     break;
                 }
 
@@ -33,6 +33,7 @@
 #include "mongo/db/commands/killcursors_common.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/cursor_manager.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/query/killcursors_request.h"
 #include "mongo/db/stats/top.h"
@@ -93,6 +94,9 @@ private:
                 }
             }
         } else {
+            // A read-ahead of the cursor holds it pinned, which would make it impossible to kill.
+            CursorPrefetcher::get(opCtx).waitForIdle(opCtx, cursorId);
+
             readLock.emplace(opCtx, nss);
             Collection* collection = readLock->getCollection();
             if (!collection) {
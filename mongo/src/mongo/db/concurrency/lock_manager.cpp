@@ -118,8 +118,13 @@ featdoc:PRIMARY>
 
 #include "mongo/db/concurrency/lock_manager.h"
 
+#include <algorithm>
 #include <third_party/murmurhash3/MurmurHash3.h>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/static_assert.h"
@@ -127,6 +132,7 @@ featdoc:PRIMARY>
 #include "mongo/config.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
@@ -603,14 +609,23 @@ void LockHead::migratePartitionedLockHeads() {
 //CmdLockInfo::run    db.runCommand({lockInfo: 1})ȡϢ
 const unsigned LockManager::_numLockBuckets(128); //źĬϸֵ128   ȫͰпͻ
 
-// Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+namespace {
+
+// Balance scalability of intent locks against potential added cost of conflicting locks, which
+// have to visit every partition an intent lock was granted from. Hosts with many CPUs get one
+// partition per CPU.
+const unsigned kMinNumPartitions = 32;
+
+unsigned numPartitions() {
+    return std::max(kMinNumPartitions, stdx::thread::hardware_concurrency());
+}
+
+}  // namespace
 
 //LockManager::LockManager()  _numLockBucketsĬ128
-LockManager::LockManager() {
+LockManager::LockManager() : _numPartitions(numPartitions()) {
     _lockBuckets = new LockBucket[_numLockBuckets]; //128
-    _partitions = new Partition[_numPartitions]; //32
+    _partitions = new Partition[_numPartitions];
 }
 
 LockManager::~LockManager() {
@@ -634,6 +649,9 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 	//˵Ƿ
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
     request->mode = mode;
+    if (request->partitioned) {
+        request->partitionIndex = _choosePartition(request);
+    }
 
 	/*ȲrequestӦĸۣòλжӦresId ȻӵλĶӦ */
     // For intent modes, try the PartitionedLockHead
@@ -1050,8 +1068,18 @@ LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
 }
 
 //lock id࣬lockӦôǸ_partitions
+unsigned LockManager::_choosePartition(const LockRequest* request) const {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return static_cast<unsigned>(cpu) % _numPartitions;
+    }
+#endif
+    return request->locker->getId() % _numPartitions;
+}
+
 LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-    return &_partitions[request->locker->getId() % _numPartitions]; 
+    return &_partitions[request->partitionIndex];
 }
 
 void LockManager::dump() const {
@@ -1529,6 +1557,7 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
     next = nullptr;
     status = STATUS_NEW;
     partitioned = false;
+    partitionIndex = 0;
     mode = MODE_NONE;
     convertMode = MODE_NONE;
 }
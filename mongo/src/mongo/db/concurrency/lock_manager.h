@@ -240,9 +240,10 @@ private:
         LockHead* findOrInsert(ResourceId resId);
     };
 
-    // Each locker maps to a partition that is used for resources acquired in intent modes
-    // modes and potentially other modes that don't conflict with themselves. This avoids
-    // contention on the regular LockHead in the lock manager.
+    // Each intent mode request maps to a partition, chosen by the CPU the requesting thread runs
+    // on, that is used for resources acquired in intent modes and potentially other modes that
+    // don't conflict with themselves. This avoids contention on the regular LockHead in the lock
+    // manager, and on the partitions themselves while threads stay on their CPUs.
     //ÿresIdӦһPartitionedLockHeadṹLockManager._partitions[]
     //LockManager._partitions[]λͣοLockManager::lock
     struct Partition {
@@ -264,7 +265,14 @@ private:
 
 
     /**
-     * Retrieves the Partition that a particular LockRequest should use for intent locking.
+     * Chooses the partition a new LockRequest should use for intent locking. Prefers the partition
+     * of the CPU the calling thread is running on, so that concurrent requests from different CPUs
+     * don't contend on a partition mutex.
+     */
+    unsigned _choosePartition(const LockRequest* request) const;
+
+    /**
+     * Retrieves the Partition that a particular LockRequest uses for intent locking.
      */
     Partition* _getPartition(LockRequest* request) const;
 
@@ -323,7 +331,8 @@ private:
     LockBucket* _lockBuckets; //
 
     //_partitions = new Partition[_numPartitions]; //32
-    static const unsigned _numPartitions;
+    // At least one partition per CPU, see _choosePartition().
+    const unsigned _numPartitions;
     //ÿresIdӦһPartitionedLockHeadṹLockManager._partitions[]
     
     //ǰȫҲǰȫpartitionsڸԴMODE_X MODE_S
@@ -759,6 +759,14 @@ struct LockRequest { // һ
     //request->partitioned = (mode == MODE_IX || mode == MODE_IS);   ֵŻΪtrue
     bool partitioned;
 
+    // The partition of the lock manager a partitioned request was made on. Requests are unlocked
+    // through the same partition even if their thread has since moved to another CPU.
+    //
+    // Written by LockManager::lock on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    unsigned partitionIndex;
+
     // How many times has LockManager::lock been called for this request. Locks are released when
     // their recursive count drops to zero.
     //
@@ -28,6 +28,8 @@
 
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -316,6 +318,48 @@ TEST(LockManager, Conflict) {
     ASSERT(request2.numNotifies == 1);
 }
 
+TEST(LockManager, ConflictWithIntentLocksFromManyThreads) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    // Intent locks granted on different threads are likely to land in different partitions, and
+    // are released here on yet another thread.
+    const int numThreads = 8;
+    std::vector<std::unique_ptr<MMAPV1LockerImpl>> lockers;
+    std::vector<std::unique_ptr<LockRequestCombo>> requests;
+    for (int i = 0; i < numThreads; i++) {
+        lockers.push_back(stdx::make_unique<MMAPV1LockerImpl>());
+        requests.push_back(stdx::make_unique<LockRequestCombo>(lockers.back().get()));
+    }
+
+    std::vector<LockResult> results(numThreads, LOCK_INVALID);
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back([&, i] {
+            results[i] = lockMgr.lock(resId, requests[i].get(), i % 2 ? MODE_IX : MODE_IS);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < numThreads; i++) {
+        ASSERT(results[i] == LOCK_OK);
+    }
+
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+    for (int i = 0; i < numThreads; i++) {
+        ASSERT(requestX.numNotifies == 0);
+        lockMgr.unlock(requests[i].get());
+    }
+
+    ASSERT(requestX.numNotifies == 1);
+    ASSERT(requestX.lastResult == LOCK_OK);
+    lockMgr.unlock(&requestX);
+}
+
 TEST(LockManager, MultipleConflict) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
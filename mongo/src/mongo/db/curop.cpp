@@ -404,6 +404,7 @@ void CurOp::reportState(BSONObjBuilder* builder, bool truncateOps) {
             BSONObjBuilder sub(builder->subobjStart("progress"));
             sub.appendNumber("done", (long long)_progressMeter.done());
             sub.appendNumber("total", (long long)_progressMeter.total());
+            sub.appendNumber("ratePerSecond", (long long)_progressMeter.ratePerSecond());
             sub.done();
         } else {
             builder->append("msg", _message);
@@ -506,6 +507,15 @@ string OpDebug::report(Client* client,
     OPDEBUG_TOSTRING_HELP_BOOL(hasSortStage);
     OPDEBUG_TOSTRING_HELP_BOOL(fromMultiPlanner);
     OPDEBUG_TOSTRING_HELP_BOOL(replanned);
+    OPDEBUG_TOSTRING_HELP(groupSpilledBytes);
+    OPDEBUG_TOSTRING_HELP(groupSpilledPartitions);
+    OPDEBUG_TOSTRING_HELP(groupSpillPasses);
+    OPDEBUG_TOSTRING_HELP(lookupHashJoins);
+    OPDEBUG_TOSTRING_HELP(lookupForeignDocsMaterialized);
+    OPDEBUG_TOSTRING_HELP(graphLookupQueries);
+    OPDEBUG_TOSTRING_HELP(graphLookupCacheHits);
+    OPDEBUG_TOSTRING_HELP(graphLookupDocsReturned);
+    OPDEBUG_TOSTRING_HELP(graphLookupSpills);
     OPDEBUG_TOSTRING_HELP(nMatched);
     OPDEBUG_TOSTRING_HELP(nModified);
     OPDEBUG_TOSTRING_HELP(ninserted);
@@ -602,6 +612,15 @@ void OpDebug::append(const CurOp& curop,
     OPDEBUG_APPEND_BOOL(hasSortStage);
     OPDEBUG_APPEND_BOOL(fromMultiPlanner);
     OPDEBUG_APPEND_BOOL(replanned);
+    OPDEBUG_APPEND_NUMBER(groupSpilledBytes);
+    OPDEBUG_APPEND_NUMBER(groupSpilledPartitions);
+    OPDEBUG_APPEND_NUMBER(groupSpillPasses);
+    OPDEBUG_APPEND_NUMBER(lookupHashJoins);
+    OPDEBUG_APPEND_NUMBER(lookupForeignDocsMaterialized);
+    OPDEBUG_APPEND_NUMBER(graphLookupQueries);
+    OPDEBUG_APPEND_NUMBER(graphLookupCacheHits);
+    OPDEBUG_APPEND_NUMBER(graphLookupDocsReturned);
+    OPDEBUG_APPEND_NUMBER(graphLookupSpills);
     OPDEBUG_APPEND_NUMBER(nMatched);
     OPDEBUG_APPEND_NUMBER(nModified);
     OPDEBUG_APPEND_NUMBER(ninserted);
@@ -660,6 +679,24 @@ void OpDebug::setPlanSummaryMetrics(const PlanSummaryStats& planSummaryStats) {
     hasSortStage = planSummaryStats.hasSortStage;
     fromMultiPlanner = planSummaryStats.fromMultiPlanner;
     replanned = planSummaryStats.replanned;
+
+    if (planSummaryStats.groupSpilledPartitions > 0) {
+        groupSpilledBytes = planSummaryStats.groupSpilledBytes;
+        groupSpilledPartitions = planSummaryStats.groupSpilledPartitions;
+        groupSpillPasses = planSummaryStats.groupSpillPasses;
+    }
+
+    if (planSummaryStats.lookupForeignDocsMaterialized > 0) {
+        lookupHashJoins = planSummaryStats.lookupHashJoins;
+        lookupForeignDocsMaterialized = planSummaryStats.lookupForeignDocsMaterialized;
+    }
+
+    if (planSummaryStats.graphLookupQueries > 0 || planSummaryStats.graphLookupCacheHits > 0) {
+        graphLookupQueries = planSummaryStats.graphLookupQueries;
+        graphLookupCacheHits = planSummaryStats.graphLookupCacheHits;
+        graphLookupDocsReturned = planSummaryStats.graphLookupDocsReturned;
+        graphLookupSpills = planSummaryStats.graphLookupSpills;
+    }
 }
 
 }  // namespace mongo
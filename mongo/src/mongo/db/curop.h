@@ -105,6 +105,22 @@ public:
     // True if a replan was triggered during the execution of this operation.
     bool replanned{false};
 
+    // Disk usage of the $group stages of an aggregation, if any of them spilled.
+    long long groupSpilledBytes{-1};
+    long long groupSpilledPartitions{-1};
+    long long groupSpillPasses{-1};
+
+    // Hash joins of the $lookup stages of an aggregation, if any of them materialized the foreign
+    // side.
+    long long lookupHashJoins{-1};
+    long long lookupForeignDocsMaterialized{-1};
+
+    // Search statistics of the $graphLookup stages of an aggregation, if it has any.
+    long long graphLookupQueries{-1};
+    long long graphLookupCacheHits{-1};
+    long long graphLookupDocsReturned{-1};
+    long long graphLookupSpills{-1};
+
     //ͳƼrecordCurOpMetrics
     long long nMatched{-1};   // number of records that match the query
     long long nModified{-1};  // number of records written (no no-ops)
@@ -39,6 +39,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/cursor_server_params.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/kill_sessions_common.h"
@@ -215,7 +216,9 @@ bool GlobalCursorIdCache::eraseCursor(OperationContext* opCtx, CursorId id, bool
     }
 
     // If not, then the cursor must be owned by a collection.  Erase the cursor under the
-    // collection lock (to prevent the collection from going away during the erase).
+    // collection lock (to prevent the collection from going away during the erase), once no
+    // read-ahead holds it pinned.
+    CursorPrefetcher::get(opCtx).waitForIdle(opCtx, id);
     AutoGetCollectionForReadCommand ctx(opCtx, nss);
     Collection* collection = ctx.getCollection();
     if (!collection) {
@@ -320,7 +323,14 @@ std::vector<GenericCursor> CursorManager::getAllCursors(OperationContext* opCtx)
 std::pair<Status, int> CursorManager::killCursorsWithMatchingSessions(
     OperationContext* opCtx, const SessionKiller::Matcher& matcher) {
     auto eraser = [&](CursorManager& mgr, CursorId id) {
-        uassertStatusOK(mgr.eraseCursor(opCtx, id, true));
+        auto status = mgr.eraseCursor(opCtx, id, true);
+        // We hold a collection lock, so we cannot wait for a read-ahead which has the cursor
+        // pinned. It kills the cursor instead once it is done.
+        if (status == ErrorCodes::OperationFailed &&
+            CursorPrefetcher::get(opCtx).killWhenIdle(id)) {
+            return;
+        }
+        uassertStatusOK(status);
     };
 
     auto visitor = makeKillSessionsCursorManagerVisitor(opCtx, matcher, std::move(eraser));
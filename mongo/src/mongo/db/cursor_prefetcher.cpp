@@ -0,0 +1,306 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/cursor_prefetcher.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/cursor_manager.h"
+#include "mongo/db/cursor_server_params.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(cursorPrefetchMaxThreads, int, 4);
+
+const auto getCursorPrefetcher = ServiceContext::declareDecoration<CursorPrefetcher>();
+
+Counter64 prefetchScheduled;
+Counter64 prefetchOverBudget;
+Counter64 prefetchDocs;
+Counter64 prefetchHits;
+Counter64 prefetchMisses;
+Counter64 prefetchWaits;
+
+ServerStatusMetricField<Counter64> displayPrefetchScheduled("cursor.prefetch.scheduled",
+                                                            &prefetchScheduled);
+ServerStatusMetricField<Counter64> displayPrefetchOverBudget("cursor.prefetch.overBudget",
+                                                             &prefetchOverBudget);
+ServerStatusMetricField<Counter64> displayPrefetchDocs("cursor.prefetch.docs", &prefetchDocs);
+ServerStatusMetricField<Counter64> displayPrefetchHits("cursor.prefetch.hits", &prefetchHits);
+ServerStatusMetricField<Counter64> displayPrefetchMisses("cursor.prefetch.misses",
+                                                         &prefetchMisses);
+ServerStatusMetricField<Counter64> displayPrefetchWaits("cursor.prefetch.waits", &prefetchWaits);
+
+bool wantsReadAhead(const ClientCursor& cursor) {
+    auto cq = cursor.getExecutor()->getCanonicalQuery();
+    return cq && cq->getQueryRequest().isReadAhead();
+}
+
+}  // namespace
+
+CursorPrefetcher& CursorPrefetcher::get(ServiceContext* service) {
+    return getCursorPrefetcher(service);
+}
+
+CursorPrefetcher& CursorPrefetcher::get(OperationContext* opCtx) {
+    return getCursorPrefetcher(opCtx->getServiceContext());
+}
+
+void CursorPrefetcher::startup() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(!_pool);
+
+    ThreadPool::Options options;
+    options.poolName = "CursorPrefetcher";
+    options.threadNamePrefix = "cursorPrefetch";
+    options.minThreads = 0;
+    options.maxThreads = std::max(1, cursorPrefetchMaxThreads);
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    _pool = stdx::make_unique<ThreadPool>(options);
+    _pool->startup();
+}
+
+void CursorPrefetcher::shutdown() {
+    std::unique_ptr<ThreadPool> pool;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        pool = std::move(_pool);
+    }
+
+    if (!pool) {
+        return;
+    }
+
+    pool->shutdown();
+    pool->join();
+}
+
+void CursorPrefetcher::schedule(OperationContext* opCtx,
+                                ClientCursorPin* pin,
+                                boost::optional<long long> batchSize) {
+    ClientCursor* cursor = pin->getCursor();
+    const NamespaceString nss = cursor->nss();
+    const CursorId cursorId = cursor->cursorid();
+
+    const bool eligible = wantsReadAhead(*cursor) &&
+        !CursorManager::isGloballyManagedCursor(cursorId) && !cursor->isTailable() &&
+        cursor->getLeftoverMaxTimeMicros() == Microseconds::max() &&
+        !opCtx->getClient()->isInDirectClient();
+    if (!eligible) {
+        pin->release();
+        return;
+    }
+
+    if (ClientCursor::totalPrefetchedBytes() >= getCursorPrefetchMaxMemoryBytes()) {
+        prefetchOverBudget.increment();
+        pin->release();
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_pool || !_inProgress.insert(cursorId).second) {
+        pin->release();
+        return;
+    }
+
+    // The cursor is marked in progress before it is unpinned, so that a getMore which waits for it
+    // cannot slip in between and find it pinned by the read-ahead.
+    pin->release();
+
+    auto status = _pool->schedule([this, nss, cursorId, batchSize] {
+        _prefetch(nss, cursorId, batchSize);
+    });
+    if (!status.isOK()) {
+        _inProgress.erase(cursorId);
+        _idle.notify_all();
+        return;
+    }
+
+    prefetchScheduled.increment();
+}
+
+void CursorPrefetcher::waitForIdle(OperationContext* opCtx, CursorId cursorId) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (!_inProgress.count(cursorId)) {
+        return;
+    }
+
+    prefetchWaits.increment();
+    opCtx->waitForConditionOrInterrupt(_idle, lk, [&] { return !_inProgress.count(cursorId); });
+}
+
+bool CursorPrefetcher::killWhenIdle(CursorId cursorId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_inProgress.count(cursorId)) {
+        return false;
+    }
+
+    _killPending.insert(cursorId);
+    return true;
+}
+
+void CursorPrefetcher::recordGetMore(const ClientCursor& cursor) {
+    if (!wantsReadAhead(cursor)) {
+        return;
+    }
+
+    if (cursor.hasPrefetchedResults()) {
+        prefetchHits.increment();
+    } else {
+        prefetchMisses.increment();
+    }
+}
+
+void CursorPrefetcher::_prefetch(const NamespaceString& nss,
+                                 CursorId cursorId,
+                                 boost::optional<long long> batchSize) {
+    auto opCtx = cc().makeOperationContext();
+
+    bool killPending = false;
+    {
+        // Waiters are woken only once the pin and the locks taken by _readAhead() have been
+        // released.
+        ON_BLOCK_EXIT([&] {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            killPending = _killPending.erase(cursorId) > 0;
+            if (!killPending) {
+                _inProgress.erase(cursorId);
+                _idle.notify_all();
+            }
+        });
+
+        _readAhead(opCtx.get(), nss, cursorId, batchSize);
+    }
+
+    if (!killPending) {
+        return;
+    }
+
+    // killSessions found the cursor pinned by this read-ahead and left it to be killed here.
+    // Waiters are only woken afterwards, so that a getMore finds the cursor gone.
+    ON_BLOCK_EXIT([&] {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _inProgress.erase(cursorId);
+        _killPending.erase(cursorId);
+        _idle.notify_all();
+    });
+
+    try {
+        AutoGetCollectionForRead readLock(opCtx.get(), nss);
+        if (Collection* collection = readLock.getCollection()) {
+            collection->getCursorManager()->eraseCursor(opCtx.get(), cursorId, false).ignore();
+        }
+    } catch (const DBException& ex) {
+        LOG(1) << "Could not kill cursor " << cursorId << " on " << nss.ns() << ": "
+               << redact(ex.toStatus());
+    }
+}
+
+void CursorPrefetcher::_readAhead(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  CursorId cursorId,
+                                  boost::optional<long long> batchSize) {
+    try {
+        AutoGetCollectionForRead readLock(opCtx, nss);
+        Collection* collection = readLock.getCollection();
+        if (!collection) {
+            return;
+        }
+
+        // The cursor may have been killed, timed out or pinned by a getMore in the meantime.
+        auto pin = collection->getCursorManager()->pinCursor(opCtx, cursorId);
+        if (!pin.isOK()) {
+            return;
+        }
+        ClientCursor* cursor = pin.getValue().getCursor();
+
+        if (cursor->isReadCommitted()) {
+            uassertStatusOK(opCtx->recoveryUnit()->setReadFromMajorityCommittedSnapshot());
+        }
+
+        PlanExecutor* exec = cursor->getExecutor();
+        exec->reattachToOperationContext(opCtx);
+        if (!exec->restoreState().isOK()) {
+            // The cursor was killed. Releasing the pin disposes of it.
+            return;
+        }
+
+        // Read at most what the next getMore would return if it asks for the same batch size.
+        // Results left over from the last read-ahead count towards the batch.
+        const long long maxBytes = getCursorPrefetchMaxMemoryBytes();
+        long long numResults = cursor->numPrefetched();
+        BSONObj obj;
+        try {
+            while (!FindCommon::enoughForGetMore(batchSize.value_or(0), numResults) &&
+                   cursor->prefetchedBytes() < FindCommon::kMaxBytesToReturnToClientAtOnce &&
+                   ClientCursor::totalPrefetchedBytes() < maxBytes) {
+                const auto state = exec->getNext(&obj, nullptr);
+                if (state == PlanExecutor::ADVANCED) {
+                    cursor->appendPrefetched(obj);
+                    prefetchDocs.increment();
+                    ++numResults;
+                    continue;
+                }
+
+                if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                    cursor->setPrefetchError(state, obj);
+                }
+                break;
+            }
+        } catch (const DBException& ex) {
+            cursor->setPrefetchError(PlanExecutor::FAILURE,
+                                     WorkingSetCommon::buildMemberStatusObject(ex.toStatus()));
+        }
+
+        exec->saveState();
+        exec->detachFromOperationContext();
+    } catch (const DBException& ex) {
+        LOG(1) << "Could not read ahead cursor " << cursorId << " on " << nss.ns() << ": "
+               << redact(ex.toStatus());
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/cursor_id.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_set.h"
+
+namespace mongo {
+
+class ClientCursor;
+class ClientCursorPin;
+class OperationContext;
+class ServiceContext;
+class ThreadPool;
+
+/**
+ * Reads the next batch of a cursor on a background thread while the client is processing the
+ * batch it was just sent, so that the following getMore can return without running the query.
+ *
+ * Read-ahead is requested per cursor with the find command's 'readAhead' option. After a find or
+ * getMore has built a batch, it hands its pin to schedule(). A background thread then pins the
+ * cursor under a collection lock, as a getMore would, and appends up to one batch of results to the cursor with
+ * ClientCursor::appendPrefetched(). The PlanExecutor yields as usual while it runs. The next getMore
+ * takes those results through ClientCursor::getNext() before it runs the PlanExecutor itself.
+ *
+ * While a read-ahead holds a cursor pinned, a getMore or killCursors of that cursor must wait for it
+ * with waitForIdle() before taking any lock, or it would find the cursor in use. killSessions
+ * visits cursors under collection locks and cannot wait, so it leaves such a cursor to be killed
+ * by the read-ahead with killWhenIdle().
+ *
+ * The results held by all cursors are bounded by the "cursorPrefetchMaxMemoryBytes" server
+ * parameter. A read-ahead is not started while the bound is exceeded.
+ */
+class CursorPrefetcher {
+    MONGO_DISALLOW_COPYING(CursorPrefetcher);
+
+public:
+    CursorPrefetcher() = default;
+
+    static CursorPrefetcher& get(ServiceContext* service);
+    static CursorPrefetcher& get(OperationContext* opCtx);
+
+    /**
+     * Starts the threads which read ahead. Until then, schedule() does nothing.
+     */
+    void startup();
+
+    /**
+     * Waits for running read-aheads to finish and stops the threads. Operations must have been
+     * killed first, so that read-aheads stop at their next yield.
+     */
+    void shutdown();
+
+    /**
+     * Releases 'pin', whose cursor the caller has just returned a batch from, and starts reading the
+     * cursor's next batch if it asked for read-ahead and is eligible. Must be called under the
+     * collection lock. 'batchSize' is the batch size of the request being answered.
+     *
+     * Cursors owned by the global cursor manager, tailable cursors, cursors with a maxTimeMS
+     * budget and cursors used through a DBDirectClient are never read ahead.
+     */
+    void schedule(OperationContext* opCtx,
+                  ClientCursorPin* pin,
+                  boost::optional<long long> batchSize);
+
+    /**
+     * Blocks until no read-ahead holds the cursor 'cursorId'. Must be called without any locks
+     * held. Throws if 'opCtx' is interrupted.
+     */
+    void waitForIdle(OperationContext* opCtx, CursorId cursorId);
+
+    /**
+     * Arranges for the cursor 'cursorId' to be killed as soon as the read-ahead which holds it
+     * finishes. Returns false, and does nothing, if no read-ahead holds the cursor.
+     */
+    bool killWhenIdle(CursorId cursorId);
+
+    /**
+     * Records whether a getMore on 'cursor' found results read ahead for it, for the prefetch hit
+     * rate in serverStatus.
+     */
+    static void recordGetMore(const ClientCursor& cursor);
+
+private:
+    void _prefetch(const NamespaceString& nss,
+                   CursorId cursorId,
+                   boost::optional<long long> batchSize);
+
+    void _readAhead(OperationContext* opCtx,
+                    const NamespaceString& nss,
+                    CursorId cursorId,
+                    boost::optional<long long> batchSize);
+
+    std::unique_ptr<ThreadPool> _pool;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _idle;
+
+    // The cursors which are being read ahead, or for which a read-ahead is scheduled.
+    stdx::unordered_set<CursorId> _inProgress;
+
+    // The cursors in '_inProgress' which the read-ahead must kill when it finishes.
+    stdx::unordered_set<CursorId> _killPending;
+};
+
+}  // namespace mongo
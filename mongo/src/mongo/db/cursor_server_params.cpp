@@ -44,6 +44,7 @@ MONGO_EXPORT_SERVER_PARAMETER(clientCursorMonitorFrequencySecs, int, 4);
 MONGO_EXPORT_SERVER_PARAMETER(cursorTimeoutMillis,
                               long long,
                               durationCount<Milliseconds>(kDefaultCursorTimeoutMinutes));
+MONGO_EXPORT_SERVER_PARAMETER(cursorPrefetchMaxMemoryBytes, long long, 100 * 1024 * 1024);
 
 }  // namespace
 
@@ -61,6 +62,10 @@ long long getCursorTimeoutMillis() {
     return cursorTimeoutMillis.load();
 }
 
+long long getCursorPrefetchMaxMemoryBytes() {
+    return cursorPrefetchMaxMemoryBytes.load();
+}
+
 Milliseconds getDefaultCursorTimeoutMillis() {
     return kDefaultCursorTimeoutMinutes;
 }
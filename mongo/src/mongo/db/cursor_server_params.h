@@ -41,6 +41,11 @@ long long getMongosSlowLogLevelMs();
 // parameter "cursorTimeoutMillis".
 long long getCursorTimeoutMillis();
 
+// The number of bytes of results that all cursors together may hold after reading them ahead of the
+// next getMore. Configurable with server parameter "cursorPrefetchMaxMemoryBytes"; 0 disables
+// read-ahead.
+long long getCursorPrefetchMaxMemoryBytes();
+
 Milliseconds getDefaultCursorTimeoutMillis();
 
 }  // namespace mongo
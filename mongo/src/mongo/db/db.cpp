@@ -63,6 +63,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/dbhelpers.h"
@@ -872,6 +873,9 @@ ExitCode _initAndListen(int listenPort) {
     // Start up health log writer thread.
     HealthLog::get(startupOpCtx.get()).startup();
 
+    // Start up the threads which read ahead the next batch of cursors.
+    CursorPrefetcher::get(startupOpCtx.get()).startup();
+
     auto const globalAuthzManager = AuthorizationManager::get(serviceContext);
     uassertStatusOK(globalAuthzManager->initialize(startupOpCtx.get()));
 
@@ -1368,6 +1372,7 @@ void shutdownTask() {
     stopMongoDFTDC();
 
     HealthLog::get(serviceContext).shutdown();
+    CursorPrefetcher::get(serviceContext).shutdown();
 
     // We should always be able to acquire the global lock at shutdown.
     //
@@ -295,6 +295,22 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache) {
     return Status::OK();
 }
 
+const QuerySolution* CachedPlanStage::replannedSolution() {
+    if (!replanned()) {
+        return nullptr;
+    }
+
+    if (_replannedQs) {
+        return _replannedQs.get();
+    }
+
+    if (!_children.empty() && STAGE_MULTI_PLAN == child()->stageType()) {
+        return static_cast<MultiPlanStage*>(child().get())->bestSolution();
+    }
+
+    return nullptr;
+}
+
 bool CachedPlanStage::isEOF() {
     return _results.empty() && child()->isEOF();
 }
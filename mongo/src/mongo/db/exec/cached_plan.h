@@ -87,6 +87,20 @@ public:
      */
     Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
 
+    /**
+     * Returns true if the cached plan performed poorly and the query was planned again, in which
+     * case the cached solution no longer describes the plan being run.
+     */
+    bool replanned() const {
+        return _specificStats.replanned;
+    }
+
+    /**
+     * Returns the solution chosen by replanning, or nullptr if the query was not replanned or no
+     * solution has been chosen.
+     */
+    const QuerySolution* replannedSolution();
+
 private:
     /**
      * Passes stats from the trial period run of the cached plan to the plan cache.
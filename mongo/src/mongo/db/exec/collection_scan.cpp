@@ -30,6 +30,8 @@
 
 #include "mongo/db/exec/collection_scan.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
@@ -38,11 +40,17 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/storage/record_fetcher.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 
 #include "mongo/db/client.h"  // XXX-ERH
 
@@ -74,6 +82,120 @@ keyPattern = { name: 1.0, age: 1.0 }
 // static
 const char* CollectionScan::kStageType = "COLLSCAN";
 
+namespace {
+
+/**
+ * Returns the pool shared by all collection scans that filter documents in parallel. Its threads
+ * only ever evaluate match expressions, so they neither block nor need a Client.
+ */
+ThreadPool* getParallelFilterPool() {
+    static ThreadPool* pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "CollectionScanFilter";
+        options.minThreads = 0;
+        options.maxThreads = std::max(1U, ProcessInfo().getNumCores());
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return pool;
+}
+
+/**
+ * Returns true if 'expr' can be evaluated concurrently by several threads. $where and $expr
+ * evaluate against per-operation state, and $text filtering is never done by a collection scan.
+ */
+bool canFilterInParallel(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::WHERE:
+        case MatchExpression::EXPRESSION:
+        case MatchExpression::TEXT:
+            return false;
+        default:
+            break;
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        if (!canFilterInParallel(expr->getChild(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t getParallelBatchSize() {
+    return std::max(1, internalQueryExecCollectionScanParallelBatchSize.load());
+}
+
+/**
+ * Shared by the threads filtering one batch. Threads claim chunks of the batch until none are
+ * left, so a pool task that starts after the batch is done returns without touching it.
+ */
+struct ParallelFilterState {
+    explicit ParallelFilterState(size_t numChunks) : numChunks(numChunks) {}
+
+    const size_t numChunks;
+    AtomicUInt64 nextChunk;
+
+    stdx::mutex mutex;
+    stdx::condition_variable chunkDone;
+    size_t numChunksDone = 0;
+    Status status = Status::OK();
+};
+
+// A shared scan records how far it has got once every this many records, and whenever it yields.
+const size_t kSharedScanAdvanceInterval = 128;
+
+/**
+ * Tracks the shared collection scans in progress: for each collection, how many shared scans are
+ * reading it, and the record that the last of them to record its progress had got to.
+ */
+class SharedScanRegistry {
+public:
+    /**
+     * Registers a shared scan of 'ns', and returns the record it should start at. Returns a null
+     * RecordId if no scan of 'ns' has recorded its progress yet.
+     */
+    RecordId join(const std::string& ns) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        SharedScan& scan = _scans[ns];
+        ++scan.numScans;
+        return scan.position;
+    }
+
+    void advance(const std::string& ns, const RecordId& position) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _scans.find(ns);
+        invariant(it != _scans.end());
+        it->second.position = position;
+    }
+
+    void leave(const std::string& ns) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _scans.find(ns);
+        invariant(it != _scans.end());
+        if (--it->second.numScans == 0) {
+            _scans.erase(it);
+        }
+    }
+
+private:
+    struct SharedScan {
+        size_t numScans = 0;
+        RecordId position;
+    };
+
+    stdx::mutex _mutex;
+    stdx::unordered_map<std::string, SharedScan> _scans;
+};
+
+SharedScanRegistry& getSharedScanRegistry() {
+    static SharedScanRegistry* registry = new SharedScanRegistry();
+    return *registry;
+}
+
+}  // namespace
+
 /*
 (gdb) bt
 #0  mongo::CollectionScan::CollectionScan (this=0x7f644e182000, opCtx=<optimized out>, params=..., workingSet=<optimized out>, filter=<optimized out>) at src/mongo/db/exec/collection_scan.cpp:71
@@ -104,6 +226,24 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
     _specificStats.maxTs = params.maxTs;
     invariant(!_params.shouldTrackLatestOplogTimestamp || _params.collection->ns().isOplog());
 
+    // Only a plain scan that tests every document against a filter can read ahead and filter in
+    // parallel. Tailable and oplog scans return documents one at a time as they become visible.
+    const int maxParallelism = internalQueryExecMaxCollectionScanParallelism.load();
+    if (maxParallelism > 1 && _filter && !params.tailable && !params.maxTs &&
+        !params.shouldTrackLatestOplogTimestamp && !params.stopApplyingFilterAfterFirstMatch &&
+        0 == params.maxScan && !params.collection->ns().isOplog() &&
+        canFilterInParallel(_filter)) {
+        _maxParallelism = std::min(static_cast<size_t>(maxParallelism),
+                                   static_cast<size_t>(ProcessInfo().getNumCores()));
+    }
+
+    // Only a plain forward scan, whose caller accepts documents in any order, can be shared.
+    _specificStats.sharedScan = params.shareScan &&
+        params.direction == CollectionScanParams::FORWARD && params.start.isNull() &&
+        !params.tailable && !params.maxTs && !params.shouldTrackLatestOplogTimestamp &&
+        !params.stopApplyingFilterAfterFirstMatch && 0 == params.maxScan &&
+        !params.collection->isCapped();
+
     if (params.maxTs) {
         _endConditionBSON = BSON("$gte" << *(params.maxTs));
         _endCondition = stdx::make_unique<GTEMatchExpression>();
@@ -112,6 +252,10 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
     }
 }
 
+CollectionScan::~CollectionScan() {
+    leaveSharedScan();
+}
+
 /*
 #0  mongo::CollectionScan::doWork (this=0x7ffa9a401140, out=0x7ffa913668d0) at src/mongo/db/exec/collection_scan.cpp:82
 #1  0x00007ffa9263064b in mongo::PlanStage::work (this=0x7ffa9a401140, out=out@entry=0x7ffa913668d0) at src/mongo/db/exec/plan_stage.cpp:73
@@ -154,6 +298,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
         return PlanStage::IS_EOF;
     }
 
+    if (_bufferFiltered) {
+        return returnNextBufferedMatch(out);
+    }
+
     boost::optional<Record> record;
     const bool needToMakeCursor = !_cursor;
     try {
@@ -179,6 +327,12 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
 			//ʼCollectionScanα_cursorԱ  CollectiongetCursorõα
             _cursor = _params.collection->getCursor(getOpCtx(), forward);
 
+            if (_specificStats.sharedScan && _sharedScanNs.empty() && _lastSeenId.isNull()) {
+                _sharedScanNs = _params.collection->ns().ns();
+                _sharedScanStart = getSharedScanRegistry().join(_sharedScanNs);
+                _specificStats.joinedSharedScan = !_sharedScanStart.isNull();
+            }
+
             if (!_lastSeenId.isNull()) {
                 invariant(_params.tailable);
                 // Seek to where we were last time. If it no longer exists, mark us as dead
@@ -207,6 +361,17 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
         if (_lastSeenId.isNull() && !_params.start.isNull()) {
 			//ȥһм¼
             record = _cursor->seekExact(_params.start);//WiredTigerRecordStoreCursorBase::seekExact
+        } else if (_lastSeenId.isNull() && !_sharedScanStart.isNull() &&
+                   !_specificStats.sharedScanWrapped) {
+            record = _cursor->seekExact(_sharedScanStart);
+            if (!record) {
+                // The record this scan was to join at has been deleted. Read the collection from
+                // its beginning instead.
+                _sharedScanStart = RecordId();
+                _specificStats.joinedSharedScan = false;
+                _cursor.reset();
+                return PlanStage::NEED_TIME;
+            }
         } else {
             // See if the record we're about to access is in memory. If not, pass a fetch
             // request up.
@@ -229,7 +394,29 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
         return PlanStage::NEED_YIELD;
     }
 
+    if (record && _specificStats.sharedScanWrapped && record->id >= _sharedScanStart) {
+        // This scan is back at the record it joined the shared scan at, so it has read them all.
+        record = boost::none;
+    }
+
+    if (!record && !_sharedScanStart.isNull() && !_specificStats.sharedScanWrapped) {
+        // Wrap around to read the records before the one this scan joined at.
+        _specificStats.sharedScanWrapped = true;
+        _lastSeenId = RecordId();
+        _cursor.reset();
+        return PlanStage::NEED_TIME;
+    }
+
     if (!record) {
+        leaveSharedScan();
+
+        if (!_buffer.empty()) {
+            // Return what is left in the buffer before reporting EOF.
+            _cursorExhausted = true;
+            filterBufferInParallel();
+            return returnNextBufferedMatch(out);
+        }
+
         // We just hit EOF. If we are tailable and have already returned data, leave us in a
         // state to pick up where we left off on the next call to work(). Otherwise EOF is
         // permanent.
@@ -243,6 +430,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
     }
 
     _lastSeenId = record->id;
+    if (!_sharedScanNs.empty() && ++_sharedScanRecordsSinceAdvance >= kSharedScanAdvanceInterval) {
+        advanceSharedScan();
+    }
+
     if (_params.shouldTrackLatestOplogTimestamp) {
         auto status = setLatestOplogEntryTimestamp(*record);
         if (!status.isOK()) {
@@ -251,6 +442,17 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
         }
     }
 
+    if (shouldBufferNextRecord()) {
+        _buffer.push_back({record->id,
+                           getOpCtx()->recoveryUnit()->getSnapshotId(),
+                           record->data.releaseToBson().getOwned()});
+        if (_buffer.size() < getParallelBatchSize()) {
+            return PlanStage::NEED_TIME;
+        }
+        filterBufferInParallel();
+        return returnNextBufferedMatch(out);
+    }
+
 	//WorkingSetҵһõλ¼,WorkingSetMemberlocֶΪ¼idֶ,
 	//objֶμ¼bsonĵ
     WorkingSetID id = _workingSet->allocate();
@@ -278,6 +480,115 @@ Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     return Status::OK();
 }
 
+bool CollectionScan::shouldBufferNextRecord() {
+    if (_maxParallelism <= 1) {
+        return false;
+    }
+
+    if (_specificStats.parallelism == 1) {
+        // Scans that stop early, for instance because of a limit, never pay for reading ahead.
+        if (_specificStats.docsTested < getParallelBatchSize()) {
+            return false;
+        }
+        _specificStats.parallelism = _maxParallelism;
+    }
+    return true;
+}
+
+void CollectionScan::filterBufferInParallel() {
+    // Split the batch into a few chunks per thread so that threads finishing early can help out.
+    const size_t numRecords = _buffer.size();
+    const size_t chunkSize = std::max<size_t>(1, numRecords / (_maxParallelism * 4));
+    const size_t numChunks = (numRecords + chunkSize - 1) / chunkSize;
+
+    auto state = std::make_shared<ParallelFilterState>(numChunks);
+    const MatchExpression* filter = _filter;
+    BufferedRecord* records = _buffer.data();
+    auto filterChunks = [state, filter, records, numRecords, chunkSize] {
+        for (size_t chunk = state->nextChunk.fetchAndAdd(1); chunk < state->numChunks;
+             chunk = state->nextChunk.fetchAndAdd(1)) {
+            Status status = Status::OK();
+            try {
+                const size_t end = std::min(numRecords, (chunk + 1) * chunkSize);
+                for (size_t i = chunk * chunkSize; i < end; ++i) {
+                    records[i].matches = filter->matchesBSON(records[i].obj);
+                }
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(state->mutex);
+            if (!status.isOK() && state->status.isOK()) {
+                state->status = status;
+            }
+            if (++state->numChunksDone == state->numChunks) {
+                state->chunkDone.notify_all();
+            }
+        }
+    };
+
+    // The calling thread takes part too, so the batch completes even if the pool is saturated.
+    for (size_t i = 1; i < _maxParallelism && i < numChunks; ++i) {
+        if (!getParallelFilterPool()->schedule(filterChunks).isOK()) {
+            break;
+        }
+    }
+    filterChunks();
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(state->mutex);
+        state->chunkDone.wait(lk, [&] { return state->numChunksDone == state->numChunks; });
+        uassertStatusOK(state->status);
+    }
+
+    _specificStats.docsTested += numRecords;
+    _bufferFiltered = true;
+    _bufferPos = 0;
+}
+
+PlanStage::StageState CollectionScan::returnNextBufferedMatch(WorkingSetID* out) {
+    while (_bufferPos < _buffer.size() && !_buffer[_bufferPos].matches) {
+        ++_bufferPos;
+    }
+
+    if (_bufferPos == _buffer.size()) {
+        _buffer.clear();
+        _bufferFiltered = false;
+        _bufferPos = 0;
+        if (_cursorExhausted) {
+            _commonStats.isEOF = true;
+            return PlanStage::IS_EOF;
+        }
+        return PlanStage::NEED_TIME;
+    }
+
+    BufferedRecord& record = _buffer[_bufferPos++];
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = record.id;
+    member->obj = {record.snapshotId, std::move(record.obj)};
+    _workingSet->transitionToRecordIdAndObj(id);
+
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
+void CollectionScan::advanceSharedScan() {
+    if (_sharedScanNs.empty() || _lastSeenId.isNull()) {
+        return;
+    }
+    getSharedScanRegistry().advance(_sharedScanNs, _lastSeenId);
+    _sharedScanRecordsSinceAdvance = 0;
+}
+
+void CollectionScan::leaveSharedScan() {
+    if (_sharedScanNs.empty()) {
+        return;
+    }
+    getSharedScanRegistry().leave(_sharedScanNs);
+    _sharedScanNs.clear();
+}
+
 //鿴ȫɨļ¼ǷǵCollectionScanPlanStagefilter.
 //򷵻ظPlanExecutorgetNext,.
 PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
@@ -321,6 +632,12 @@ void CollectionScan::doInvalidate(OperationContext* opCtx,
         _cursor->invalidate(opCtx, id);
     }
 
+    // Drop a buffered document that is deleted before we return it.
+    _buffer.erase(std::remove_if(_buffer.begin() + _bufferPos,
+                                 _buffer.end(),
+                                 [&id](const BufferedRecord& record) { return record.id == id; }),
+                  _buffer.end());
+
     if (_params.tailable && id == _lastSeenId) {
         // This means that deletes have caught up to the reader. We want to error in this case
         // so readers don't miss potentially important data.
@@ -329,6 +646,9 @@ void CollectionScan::doInvalidate(OperationContext* opCtx,
 }
 
 void CollectionScan::doSaveState() {
+    // Yielding is a good time to let shared scans that start in the meantime join this one.
+    advanceSharedScan();
+
     if (_cursor) {
         _cursor->save();
     }
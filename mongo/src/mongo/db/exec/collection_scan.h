@@ -29,11 +29,14 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/snapshot.h"
 
 namespace mongo {
 
@@ -47,6 +50,11 @@ class OperationContext;
  * there are no more records in the collection.
  *
  * Preconditions: Valid RecordId.
+ *
+ * A shared scan (see CollectionScanParams::shareScan) instead starts where the other shared scans
+ * of the collection have got to, continues to the end of the collection, and then wraps around to
+ * its beginning until it gets back to the record it started at. Concurrent scans of a collection
+ * thereby move through it together and read each record while it is still cached.
  */ //buildStagesйʹ
 class CollectionScan final : public PlanStage {
 public:
@@ -55,6 +63,8 @@ public:
                    WorkingSet* workingSet,
                    const MatchExpression* filter);
 
+    ~CollectionScan();
+
     StageState doWork(WorkingSetID* out) final;
     bool isEOF() final;
 
@@ -91,6 +101,36 @@ private:
      * extracted.
      */
     Status setLatestOplogEntryTimestamp(const Record& record);
+
+    /**
+     * Returns true if the next record read from '_cursor' should be buffered for parallel
+     * filtering rather than tested right away. Switches the scan to parallel filtering once it has
+     * tested a full batch of documents serially.
+     */
+    bool shouldBufferNextRecord();
+
+    /**
+     * Evaluates '_filter' against every document in '_buffer' using up to '_maxParallelism'
+     * threads.
+     */
+    void filterBufferInParallel();
+
+    /**
+     * Returns ADVANCED with the next buffered document that passed the filter, if any. Otherwise
+     * empties the buffer and returns NEED_TIME, or IS_EOF if the cursor is exhausted.
+     */
+    StageState returnNextBufferedMatch(WorkingSetID* out);
+
+    /**
+     * Records how far this scan has got, so that shared scans of the collection that start later
+     * join it there.
+     */
+    void advanceSharedScan();
+
+    /**
+     * Stops taking part in the shared scan of the collection, if this scan has joined it.
+     */
+    void leaveSharedScan();
     /*
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
@@ -124,6 +164,38 @@ private:
     // timestamp seen in the collection.  Otherwise, this is a null timestamp.
     Timestamp _latestOplogEntryTimestamp;
 
+    // A document read ahead of the consumer while filtering in parallel.
+    struct BufferedRecord {
+        RecordId id;
+        SnapshotId snapshotId;
+        BSONObj obj;
+        bool matches = false;
+    };
+
+    // The number of threads that may filter documents for this scan. Computed on construction, and
+    // 1 if the filter or the scan parameters do not allow filtering in parallel.
+    size_t _maxParallelism = 1;
+
+    // Documents read from '_cursor' but not yet returned. Once '_bufferFiltered' is true, the
+    // documents before '_bufferPos' have been returned or discarded.
+    std::vector<BufferedRecord> _buffer;
+    bool _bufferFiltered = false;
+    size_t _bufferPos = 0;
+
+    // True if '_cursor' has hit EOF while documents were buffered.
+    bool _cursorExhausted = false;
+
+    // The namespace of the shared scan this scan has joined, or empty if it has not joined one or
+    // has finished. The collection may be gone by the time this stage is destroyed.
+    std::string _sharedScanNs;
+
+    // The record this shared scan started at, or null if it started at the beginning of the
+    // collection. Once the scan has wrapped around, it ends before this record.
+    RecordId _sharedScanStart;
+
+    // The number of records read since this scan last recorded how far it has got.
+    size_t _sharedScanRecordsSinceAdvance = 0;
+
     // Stats   CollectionScanӦstageͳ
     CollectionScanStats _specificStats;
 };
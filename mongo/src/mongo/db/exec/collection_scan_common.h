@@ -69,6 +69,11 @@ struct CollectionScanParams {
     // This is useful for oplog queries where we know we will see records ordered by the ts field.
     bool stopApplyingFilterAfterFirstMatch = false;
 
+    // May the scan start where the other shared scans of the collection have got to, and wrap
+    // around at the end of the collection? Such a scan returns documents out of natural order, and
+    // is only honoured for plain forward scans of a collection that is not capped.
+    bool shareScan = false;
+
     // If non-zero, how many documents will we look at?
     size_t maxScan = 0; //db.collection.find( { $query: { <query> }, $maxScan: <number> } 
 };
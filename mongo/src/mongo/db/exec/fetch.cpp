@@ -30,11 +30,15 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -77,6 +81,12 @@ FetchStage::FetchStage(OperationContext* opCtx,
       _filter(filter),
       _idRetrying(WorkingSet::INVALID_ID) {
     _children.emplace_back(child);
+
+    // Storage engines without document-level locking page in documents one at a time by yielding,
+    // so they only ever fetch a document as soon as the child returns it.
+    if (supportsDocLocking()) {
+        _batchSize = std::max(1, internalQueryExecFetchBatchSize.load());
+    }
 }
 
 FetchStage::~FetchStage() {}
@@ -88,6 +98,10 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_batch.empty()) {
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -127,6 +141,11 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (!_batch.empty() &&
+        (_batchFetched || _batch.size() >= _batchSize || child()->isEOF())) {
+        return fetchBatch(out);
+    }
+
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
@@ -141,6 +160,17 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     if (PlanStage::ADVANCED == status) {
         WorkingSetMember* member = _ws->get(id); //idWorkingSetMemberǶӦ
 
+        if (shouldBatchNextMember()) {
+            if (member->hasObj()) {
+                ++_specificStats.alreadyHasObj;
+            }
+            _batch.push_back(id);
+            if (_batch.size() < _batchSize && !child()->isEOF()) {
+                return NEED_TIME;
+            }
+            return fetchBatch(out);
+        }
+
         // If there's an obj there, there is no fetching to perform.
         if (member->hasObj()) {
             ++_specificStats.alreadyHasObj;
@@ -183,6 +213,10 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
         }
 
         return returnIfMatches(member, id, out);
+    } else if (PlanStage::IS_EOF == status && !_batch.empty()) {
+        // Children such as IndexScan only learn that they are exhausted when asked for another
+        // result, so the last batch is usually still partial at this point.
+        return fetchBatch(out);
     } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
         *out = id;
         // If a stage fails, it may create a status WSM to indicate why it
@@ -232,6 +266,82 @@ void FetchStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, Inval
             WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
         }
     }
+
+    for (size_t i = _batchPos; i < _batch.size(); ++i) {
+        if (WorkingSet::INVALID_ID == _batch[i]) {
+            continue;
+        }
+        WorkingSetMember* member = _ws->get(_batch[i]);
+        if (member->hasRecordId() && (member->recordId == dl)) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+        }
+    }
+}
+
+bool FetchStage::shouldBatchNextMember() const {
+    // Queries that stop early, for instance because of a limit, never pay for reading ahead.
+    return _batchSize > 1 && _specificStats.docsExamined >= _batchSize;
+}
+
+PlanStage::StageState FetchStage::fetchBatch(WorkingSetID* out) {
+    if (!_batchFetched) {
+        std::vector<size_t> toFetch;
+        for (size_t i = 0; i < _batch.size(); ++i) {
+            if (WorkingSet::INVALID_ID != _batch[i] && !_ws->get(_batch[i])->hasObj()) {
+                toFetch.push_back(i);
+            }
+        }
+        std::sort(toFetch.begin(), toFetch.end(), [this](size_t lhs, size_t rhs) {
+            return _ws->get(_batch[lhs])->recordId < _ws->get(_batch[rhs])->recordId;
+        });
+
+        try {
+            if (!_cursor)
+                _cursor = _collection->getCursor(getOpCtx());
+
+            for (size_t i : toFetch) {
+                const WorkingSetID id = _batch[i];
+                if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor)) {
+                    _ws->free(id);
+                    _batch[i] = WorkingSet::INVALID_ID;
+                    continue;
+                }
+
+                // Moving the cursor on may free the document, and the rest of the batch is
+                // returned over later calls to work(), between which we may yield.
+                _ws->get(id)->makeObjOwnedIfNeeded();
+                ++_specificStats.docsFetchedInBatches;
+            }
+        } catch (const WriteConflictException&) {
+            // The documents read so far are owned, so only the rest are read once we retry.
+            *out = WorkingSet::INVALID_ID;
+            return NEED_YIELD;
+        }
+
+        ++_specificStats.fetchBatches;
+        _batchFetched = true;
+        _batchPos = 0;
+    }
+
+    return returnNextBatchedMember(out);
+}
+
+PlanStage::StageState FetchStage::returnNextBatchedMember(WorkingSetID* out) {
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    while (WorkingSet::INVALID_ID == id && _batchPos < _batch.size()) {
+        id = _batch[_batchPos++];
+    }
+
+    if (_batchPos == _batch.size()) {
+        _batch.clear();
+        _batchFetched = false;
+        _batchPos = 0;
+    }
+
+    if (WorkingSet::INVALID_ID == id) {
+        return NEED_TIME;
+    }
+    return returnIfMatches(_ws->get(id), id, out);
 }
 
 //FetchStage::doWork
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
@@ -46,6 +47,11 @@ class SeekableRecordCursor;
  * the record at the provided RecordId.  Returns verbatim any data that already has an object.
  *
  * Preconditions: Valid RecordId.
+ *
+ * Once it has fetched internalQueryExecFetchBatchSize documents one at a time, the stage collects
+ * that many members from its child before reading any of them, and reads them in RecordId order
+ * so that the cursor moves forward through the collection rather than jumping around it. The
+ * members are still returned in the order the child returned them.
  */
 /*
 2021-01-22T10:59:08.080+0800 D QUERY    [conn-1] Winning solution:
@@ -101,6 +107,25 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Returns true if the member the child has just returned should be added to '_batch' rather
+     * than fetched right away.
+     */
+    bool shouldBatchNextMember() const;
+
+    /**
+     * Reads the documents of the members in '_batch' in RecordId order, if that has not been done
+     * yet, and then returns the next member of the batch. Returns NEED_YIELD if reading a document
+     * hits a write conflict, after which the documents not yet read are read on the next call.
+     */
+    StageState fetchBatch(WorkingSetID* out);
+
+    /**
+     * Returns the next member of the fetched batch if it passes our filter, and empties the batch
+     * once all of its members have been returned or discarded.
+     */
+    StageState returnNextBatchedMember(WorkingSetID* out);
+
     // Collection which is used by this stage. Used to resolve record ids retrieved by child
     // stages. The lifetime of the collection must supersede that of the stage.
     const Collection* _collection;
@@ -118,6 +143,17 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // The number of members to collect from the child before reading their documents. Computed on
+    // construction, and 1 if the stage fetches each document as soon as the child returns it.
+    size_t _batchSize = 1;
+
+    // Members returned by the child but not yet returned by this stage, in the order the child
+    // returned them. Members whose documents could not be read are replaced by INVALID_ID. Once
+    // '_batchFetched' is true, the members before '_batchPos' have been returned or discarded.
+    std::vector<WorkingSetID> _batch;
+    bool _batchFetched = false;
+    size_t _batchPos = 0;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -288,7 +288,7 @@ struct CachedPlanStats : public SpecificStats {
 
 //CollectionScanӦstageͳ
 struct CollectionScanStats : public SpecificStats {
-    CollectionScanStats() : docsTested(0), direction(1) {}
+    CollectionScanStats() : docsTested(0), direction(1), parallelism(1) {}
 
     SpecificStats* clone() const final {
         CollectionScanStats* specific = new CollectionScanStats(*this);
@@ -307,6 +307,17 @@ struct CollectionScanStats : public SpecificStats {
     // sees a document that does not pass the filter and has a "ts" Timestamp field greater than
     // 'maxTs'.
     boost::optional<Timestamp> maxTs;
+
+    // The number of threads that evaluated the filter. Greater than 1 once the scan has switched
+    // to reading ahead and filtering batches of documents in parallel.
+    int parallelism;
+
+    // True if the scan takes part in the shared scan of its collection. 'joinedSharedScan' is set
+    // if it started where other scans had got to rather than at the beginning of the collection,
+    // and 'sharedScanWrapped' once it has wrapped around to read the records it skipped.
+    bool sharedScan = false;
+    bool joinedSharedScan = false;
+    bool sharedScanWrapped = false;
 };
 
 struct CountStats : public SpecificStats {
@@ -448,7 +459,12 @@ struct EnsureSortedStats : public SpecificStats {
 };
 
 struct FetchStats : public SpecificStats {
-    FetchStats() : alreadyHasObj(0), forcedFetches(0), docsExamined(0) {}
+    FetchStats()
+        : alreadyHasObj(0),
+          forcedFetches(0),
+          docsExamined(0),
+          fetchBatches(0),
+          docsFetchedInBatches(0) {}
 
     SpecificStats* clone() const final {
         FetchStats* specific = new FetchStats(*this);
@@ -464,6 +480,11 @@ struct FetchStats : public SpecificStats {
     // The total number of full documents touched by the fetch stage.
     //size_t docsExamined; FetchStage::returnIfMatches     keysExaminedIndexScan::doWork
     size_t docsExamined; //FetchStage::returnIfMatches
+
+    // How many batches of documents were read in RecordId order, and how many documents they held
+    // that had to be read from the collection.
+    size_t fetchBatches;
+    size_t docsFetchedInBatches;
 };
 
 struct GroupStats : public SpecificStats {
@@ -51,6 +51,7 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/storage_options.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 
@@ -75,6 +76,23 @@ bool isMultikeyFromPaths(const MultikeyPaths& multikeyPaths) {
                        [](const std::set<std::size_t>& components) { return !components.empty(); });
 }
 
+/**
+ * Adds the path components that 'multikeyPaths' marks as multikey to 'indexMultikeyPaths'.
+ */
+void mergeMultikeyPaths(const MultikeyPaths& multikeyPaths, MultikeyPaths* indexMultikeyPaths) {
+    if (multikeyPaths.empty()) {
+        return;
+    }
+    if (indexMultikeyPaths->empty()) {
+        *indexMultikeyPaths = multikeyPaths;
+        return;
+    }
+    invariant(indexMultikeyPaths->size() == multikeyPaths.size());
+    for (size_t i = 0; i < multikeyPaths.size(); ++i) {
+        (*indexMultikeyPaths)[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
+    }
+}
+
 }  // namespace
 
 MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
@@ -111,6 +129,129 @@ private:
     const IndexVersion _version;
 };
 
+/**
+ * Comparison for the external sorter of an index build that holds its keys as KeyStrings.
+ */
+class EncodedKeySortComparison {
+public:
+    template <typename Data>
+    int operator()(const Data& l, const Data& r) const {
+        int x = l.first.compare(r.first);
+        if (x) {
+            return x;
+        }
+        return l.second.compare(r.second);
+    }
+};
+
+namespace {
+
+/**
+ * Decodes the KeyStrings of a sorted run back into the BSON keys the storage engine's bulk builder
+ * expects.
+ */
+class DecodingIterator final : public SortIteratorInterface<BSONObj, RecordId> {
+public:
+    using EncodedIterator =
+        SortIteratorInterface<IndexAccessMethod::BulkBuilder::EncodedKey, RecordId>;
+
+    DecodingIterator(std::shared_ptr<EncodedIterator> source, Ordering ordering)
+        : _source(std::move(source)), _ordering(ordering) {}
+
+    bool more() override {
+        return _source->more();
+    }
+
+    std::pair<BSONObj, RecordId> next() override {
+        auto data = _source->next();
+        return {data.first.toBson(_ordering, KeyString::Version::V1), data.second};
+    }
+
+private:
+    std::shared_ptr<EncodedIterator> _source;
+    const Ordering _ordering;
+};
+
+/**
+ * Calls done() on each of 'sorters', which sorts whatever each still holds in memory, and stores
+ * the resulting runs in 'runs'. Several sorters are finished in parallel.
+ */
+template <typename SorterType>
+Status finishRuns(const std::vector<SorterType*>& sorters,
+                  std::vector<std::shared_ptr<typename SorterType::Iterator>>* runs) {
+    runs->resize(sorters.size());
+    if (sorters.size() == 1) {
+        (*runs)[0].reset(sorters[0]->done());
+        return Status::OK();
+    }
+
+    std::vector<Status> statuses(sorters.size(), Status::OK());
+    std::vector<stdx::thread> threads;
+    for (size_t i = 0; i < sorters.size(); ++i) {
+        threads.emplace_back([&, i] {
+            try {
+                (*runs)[i].reset(sorters[i]->done());
+            } catch (const DBException& ex) {
+                statuses[i] = ex.toStatus();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& status : statuses) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
+}  // namespace
+
+IndexAccessMethod::BulkBuilder::EncodedKey::EncodedKey(const KeyString& keyString)
+    : _keySize(keyString.getSize()) {
+    const auto& typeBits = keyString.getTypeBits();
+    // An empty TypeBits buffer decodes as all zeros, which is the common case.
+    _typeBitsSize = typeBits.isAllZeros() ? 0 : typeBits.getSize();
+    _ownedBuffer = SharedBuffer::allocate(_keySize + _typeBitsSize);
+    memcpy(_ownedBuffer.get(), keyString.getBuffer(), _keySize);
+    memcpy(_ownedBuffer.get() + _keySize, typeBits.getBuffer(), _typeBitsSize);
+    _data = _ownedBuffer.get();
+}
+
+int IndexAccessMethod::BulkBuilder::EncodedKey::compare(const EncodedKey& other) const {
+    int x = memcmp(_data, other._data, std::min(_keySize, other._keySize));
+    if (x) {
+        return x;
+    }
+    return _keySize < other._keySize ? -1 : _keySize > other._keySize ? 1 : 0;
+}
+
+BSONObj IndexAccessMethod::BulkBuilder::EncodedKey::toBson(Ordering ordering,
+                                                           KeyString::Version version) const {
+    BufReader reader(_data + _keySize, _typeBitsSize);
+    return KeyString::toBson(
+        _data, _keySize, ordering, KeyString::TypeBits::fromBuffer(version, &reader));
+}
+
+void IndexAccessMethod::BulkBuilder::EncodedKey::serializeForSorter(BufBuilder& buf) const {
+    buf.appendNum(_keySize);
+    buf.appendNum(_typeBitsSize);
+    buf.appendBuf(_data, _keySize + _typeBitsSize);
+}
+
+IndexAccessMethod::BulkBuilder::EncodedKey
+IndexAccessMethod::BulkBuilder::EncodedKey::deserializeForSorter(
+    BufReader& buf, const SorterDeserializeSettings&) {
+    // The key refers to the sorter's read buffer, like the BSONObj keys of the BSON sorter do.
+    EncodedKey key;
+    key._keySize = buf.read<LittleEndian<int32_t>>();
+    key._typeBitsSize = buf.read<LittleEndian<int32_t>>();
+    key._data = static_cast<const char*>(buf.skip(key._keySize + key._typeBitsSize));
+    return key;
+}
+
 /*
 õط
 2d_access_method.cpp (src\mongo\db\index):    : IndexAccessMethod(btreeState, btree) {
@@ -479,13 +620,24 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
                                             const IndexDescriptor* descriptor,
                                             size_t maxMemoryUsageBytes)
     //sorterʼĬΪsorter::NoLimitSorterҲǲKV
-    : _sorter(Sorter::make(
-          SortOptions()
-              .TempDir(storageGlobalParams.dbpath + "/_tmp")
-              .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
-          BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
-      _real(index) {}
+    : _ordering(Ordering::make(descriptor->keyPattern())),
+      _keyString(KeyString::Version::V1),
+      _real(index) {
+    const auto options = SortOptions()
+                             .TempDir(storageGlobalParams.dbpath + "/_tmp")
+                             .ExtSortAllowed()
+                             .MaxMemoryUsageBytes(maxMemoryUsageBytes);
+
+    // The KeyStrings of v:2 indexes sort exactly as woCompare() orders their BSON keys, which
+    // older index versions don't guarantee for every key.
+    if (descriptor->version() >= IndexVersion::kV2) {
+        _encodedKeySorter.reset(EncodedKeySorter::make(options, EncodedKeySortComparison()));
+    } else {
+        _sorter.reset(Sorter::make(
+            options,
+            BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version())));
+    }
+}
 
 //BulkBuilder::insertʽ  IndexAccessMethod::insertʽ
 //MultiIndexBlockImpl::insertе
@@ -507,21 +659,17 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* opCtx,
 
     _everGeneratedMultipleKeys = _everGeneratedMultipleKeys || (keys.size() > 1);
 
-    if (!multikeyPaths.empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = multikeyPaths;
-        } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
-            for (size_t i = 0; i < multikeyPaths.size(); ++i) {
-                _indexMultikeyPaths[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
-            }
-        }
-    }
+    mergeMultikeyPaths(multikeyPaths, &_indexMultikeyPaths);
 
     for (BSONObjSet::iterator it = keys.begin(); it != keys.end(); ++it) {
 		//KVŷbufferļ  Ĭsorter::NoLimitSorter::add,
 		// IndexAccessMethod::commitBulkʹ
-        _sorter->add(*it, loc);
+        if (_encodedKeySorter) {
+            _keyString.resetToKey(*it, _ordering);
+            _encodedKeySorter->add(EncodedKey(_keyString), loc);
+        } else {
+            _sorter->add(*it, loc);
+        }
         _keysInserted++;
     }
 
@@ -559,17 +707,78 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      bool mayInterrupt,
                                      bool dupsAllowed,
                                      set<RecordId>* dupsToDrop) {
+    std::vector<std::unique_ptr<BulkBuilder>> bulks;
+    bulks.push_back(std::move(bulk));
+    return commitBulk(opCtx, std::move(bulks), mayInterrupt, dupsAllowed, dupsToDrop);
+}
+
+Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
+                                     std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                                     bool mayInterrupt,
+                                     bool dupsAllowed,
+                                     set<RecordId>* dupsToDrop) {
+    invariant(!bulks.empty());
     Timer timer;
 
+    int64_t keysInserted = 0;
+    bool everGeneratedMultipleKeys = false;
+    MultikeyPaths indexMultikeyPaths;
+    for (const auto& bulk : bulks) {
+        keysInserted += bulk->_keysInserted;
+        everGeneratedMultipleKeys = everGeneratedMultipleKeys || bulk->_everGeneratedMultipleKeys;
+        mergeMultikeyPaths(bulk->_indexMultikeyPaths, &indexMultikeyPaths);
+    }
+
+    // Finishing a run sorts whatever it still holds in memory, so the runs of a build that
+    // generated its keys on several threads are finished in parallel.
 	//IndexAccessMethod::BulkBuilder::insertдbulkȡʹ
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    std::shared_ptr<BulkBuilder::Sorter::Iterator> i;
+    if (bulks[0]->_encodedKeySorter) {
+        std::vector<BulkBuilder::EncodedKeySorter*> sorters;
+        for (const auto& bulk : bulks) {
+            sorters.push_back(bulk->_encodedKeySorter.get());
+        }
+        std::vector<std::shared_ptr<BulkBuilder::EncodedKeySorter::Iterator>> runs;
+        Status status = finishRuns(sorters, &runs);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        std::shared_ptr<BulkBuilder::EncodedKeySorter::Iterator> merged;
+        if (runs.size() == 1) {
+            merged = runs[0];
+        } else {
+            merged.reset(BulkBuilder::EncodedKeySorter::Iterator::merge(
+                runs, SortOptions(), EncodedKeySortComparison()));
+        }
+        i = std::make_shared<DecodingIterator>(std::move(merged), bulks[0]->_ordering);
+    } else {
+        std::vector<BulkBuilder::Sorter*> sorters;
+        for (const auto& bulk : bulks) {
+            sorters.push_back(bulk->_sorter.get());
+        }
+        std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> runs;
+        Status status = finishRuns(sorters, &runs);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        if (runs.size() == 1) {
+            i = runs[0];
+        } else {
+            i.reset(BulkBuilder::Sorter::Iterator::merge(
+                runs,
+                SortOptions(),
+                BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+        }
+    }
 
     stdx::unique_lock<Client> lk(*opCtx->getClient());
 	//2021-03-14T14:24:29.000+0800 I - [conn167]   Index: (2/3) BTree Bottom Up Progress: 17232100/54386432 31%
     ProgressMeterHolder pm(
         CurOp::get(opCtx)->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                              "Index: (2/3) BTree Bottom Up Progress",
-                                             bulk->_keysInserted,
+                                             keysInserted,
                                              //10ӡһ
                                              10));
     lk.unlock();
@@ -580,8 +789,8 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
     writeConflictRetry(opCtx, "setting index multikey flag", "", [&] {
         WriteUnitOfWork wunit(opCtx);
 
-        if (bulk->_everGeneratedMultipleKeys || isMultikeyFromPaths(bulk->_indexMultikeyPaths)) {
-            _btreeState->setMultikey(opCtx, bulk->_indexMultikeyPaths);
+        if (everGeneratedMultipleKeys || isMultikeyFromPaths(indexMultikeyPaths)) {
+            _btreeState->setMultikey(opCtx, indexMultikeyPaths);
         }
 
         builder.reset(_newInterface->getBulkBuilder(opCtx, dupsAllowed));
@@ -712,3 +921,6 @@ void IndexAccessMethod::getKeys(const BSONObj& obj, //
 
 #include "mongo/db/sorter/sorter.cpp"
 MONGO_CREATE_SORTER(mongo::BSONObj, mongo::RecordId, mongo::BtreeExternalSortComparison);
+MONGO_CREATE_SORTER(mongo::IndexAccessMethod::BulkBuilder::EncodedKey,
+                    mongo::RecordId,
+                    mongo::EncodedKeySortComparison);
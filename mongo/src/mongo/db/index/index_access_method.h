@@ -30,6 +30,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
@@ -38,7 +39,9 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
@@ -239,10 +242,43 @@ public:
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * An index key encoded as a KeyString, followed by the TypeBits needed to decode it again.
+         * The external sorter holds keys in this form for indexes whose order the KeyString
+         * encoding reproduces exactly, so that sorting compares keys with memcmp() rather than
+         * walking two BSON keys field by field.
+         */
+        class EncodedKey {
+        public:
+            struct SorterDeserializeSettings {};  // unused
+
+            EncodedKey() = default;
+            explicit EncodedKey(const KeyString& keyString);
+
+            int compare(const EncodedKey& other) const;
+
+            BSONObj toBson(Ordering ordering, KeyString::Version version) const;
+
+            void serializeForSorter(BufBuilder& buf) const;
+            static EncodedKey deserializeForSorter(BufReader& buf,
+                                                   const SorterDeserializeSettings&);
+            int memUsageForSorter() const {
+                return sizeof(EncodedKey) + _keySize + _typeBitsSize;
+            }
+
+        private:
+            // Unset when '_data' points into the read buffer of a sorter file.
+            SharedBuffer _ownedBuffer;
+            const char* _data = nullptr;
+            int32_t _keySize = 0;
+            int32_t _typeBitsSize = 0;
+        };
+
     private:
         friend class IndexAccessMethod;
 
         using Sorter = mongo::Sorter<BSONObj, RecordId>;
+        using EncodedKeySorter = mongo::Sorter<EncodedKey, RecordId>;
 
         BulkBuilder(const IndexAccessMethod* index,
                     const IndexDescriptor* descriptor,
@@ -250,6 +286,13 @@ public:
 
         //أĬΪNoLimitSorterʹõڴ
         std::unique_ptr<Sorter> _sorter;
+
+        // Replaces '_sorter' for indexes of version 2 and later, whose keys are ordered exactly as
+        // their KeyString encodings are.
+        std::unique_ptr<EncodedKeySorter> _encodedKeySorter;
+        const Ordering _ordering;
+        KeyString _keyString;
+
         const IndexAccessMethod* _real;
         
         int64_t _keysInserted = 0;
@@ -290,6 +333,17 @@ public:
                       bool dupsAllowed,
                       std::set<RecordId>* dups);
 
+    /**
+     * Like commitBulk() above, but for an index whose keys were fed to several BulkBuilders, each
+     * by a different thread. Every builder's sorted run is finished on its own thread, and the
+     * runs are then merged into the index.
+     */
+    Status commitBulk(OperationContext* opCtx,
+                      std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                      bool mayInterrupt,
+                      bool dupsAllowed,
+                      std::set<RecordId>* dups);
+
     /**
      * Specifies whether getKeys should relax the index constraints or not.
      */
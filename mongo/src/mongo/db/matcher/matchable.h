@@ -34,6 +34,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/matcher/path.h"
+#include "mongo/db/matcher/path_internal.h"
 
 namespace mongo {
 
@@ -85,10 +86,17 @@ public:
     }
 
     virtual ElementIterator* allocateIterator(const ElementPath* path) const {
+        // A filter that looks up many paths, such as a conjunction over several fields, indexes
+        // the fields of the document once instead of scanning it for every path.
+        if (!_fieldIndex.isBuilt() && ++_numIteratorsAllocated > kFieldIndexThreshold) {
+            _fieldIndex.build(_obj);
+        }
+        const BSONFieldIndex* fieldIndex = _fieldIndex.isBuilt() ? &_fieldIndex : nullptr;
+
         if (_iteratorUsed)
-            return new BSONElementIterator(path, _obj);
+            return new BSONElementIterator(path, _obj, fieldIndex);
         _iteratorUsed = true;
-        _iterator.reset(path, _obj);
+        _iterator.reset(path, _obj, fieldIndex);
         return &_iterator;
     }
 
@@ -101,9 +109,15 @@ public:
     }
 
 private:
+    // The number of paths looked up in the document before its fields are indexed.
+    static const int kFieldIndexThreshold = 4;
+
     BSONObj _obj;
     mutable BSONElementIterator _iterator;
     mutable bool _iteratorUsed;
+
+    mutable int _numIteratorsAllocated = 0;
+    mutable BSONFieldIndex _fieldIndex;
 };
 
 /**
@@ -38,6 +38,8 @@
 
 namespace mongo {
 
+class BSONFieldIndex;
+
 //PathMatchExpression̳и
 class ElementPath {
 public:
@@ -156,14 +158,19 @@ public:
 
     /**
      * Constructs an iterator over 'objectToIterate', where the desired element(s) is/are at the end
-     * of 'path'.
+     * of 'path'. If non-null, 'objectFields' must index the fields of 'objectToIterate', and is
+     * used to find the first part of 'path'.
      */
-    BSONElementIterator(const ElementPath* path, const BSONObj& objectToIterate);
+    BSONElementIterator(const ElementPath* path,
+                        const BSONObj& objectToIterate,
+                        const BSONFieldIndex* objectFields = nullptr);
 
     virtual ~BSONElementIterator();
 
     void reset(const ElementPath* path, size_t suffixIndex, BSONElement elementToIterate);
-    void reset(const ElementPath* path, const BSONObj& objectToIterate);
+    void reset(const ElementPath* path,
+               const BSONObj& objectToIterate,
+               const BSONFieldIndex* objectFields = nullptr);
 
     bool more();
     Context next();
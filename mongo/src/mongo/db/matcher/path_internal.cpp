@@ -40,10 +40,65 @@ bool isAllDigits(StringData str) {
     return true;
 }
 
+void BSONFieldIndex::build(const BSONObj& obj) {
+    clear();
+    for (auto&& elem : obj) {
+        _elements.push_back(elem);
+    }
+
+    // Keep the table at most half full.
+    size_t numSlots = 8;
+    while (numSlots < 2 * _elements.size()) {
+        numSlots *= 2;
+    }
+    _slots.assign(numSlots, -1);
+
+    const size_t mask = numSlots - 1;
+    for (size_t i = 0; i < _elements.size(); ++i) {
+        const StringData name = _elements[i].fieldNameStringData();
+        for (size_t slot = hash(name) & mask;; slot = (slot + 1) & mask) {
+            if (_slots[slot] == -1) {
+                _slots[slot] = static_cast<int>(i);
+                break;
+            }
+            if (_elements[_slots[slot]].fieldNameStringData() == name) {
+                break;  // Only the first of several fields with the same name can be found.
+            }
+        }
+    }
+}
+
+void BSONFieldIndex::clear() {
+    _elements.clear();
+    _slots.clear();
+}
+
+BSONElement BSONFieldIndex::getField(StringData name) const {
+    invariant(isBuilt());
+    const size_t mask = _slots.size() - 1;
+    for (size_t slot = hash(name) & mask; _slots[slot] != -1; slot = (slot + 1) & mask) {
+        const BSONElement& elem = _elements[_slots[slot]];
+        if (elem.fieldNameStringData() == name) {
+            return elem;
+        }
+    }
+    return BSONElement();
+}
+
+size_t BSONFieldIndex::hash(StringData name) {
+    // FNV-1a. Field names are short, so this is cheaper than a general purpose hash.
+    uint32_t hash = 2166136261U;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619U;
+    }
+    return hash;
+}
+
 BSONElement getFieldDottedOrArray(const BSONObj& doc,
                                   const FieldRef& path,
                                   size_t* idxPath,
-                                  size_t startIndex) {
+                                  size_t startIndex,
+                                  const BSONFieldIndex* docFields) {
     if (path.numParts() == startIndex)
         return doc.getField("");
 
@@ -53,7 +108,8 @@ BSONElement getFieldDottedOrArray(const BSONObj& doc,
     bool stop = false;
     size_t partNum = startIndex;
     while (partNum < path.numParts() && !stop) {
-        res = curr.getField(path.getPart(partNum));
+        res = (docFields && partNum == startIndex) ? docFields->getField(path.getPart(partNum))
+                                                   : curr.getField(path.getPart(partNum));
 
         switch (res.type()) {
             case EOO:
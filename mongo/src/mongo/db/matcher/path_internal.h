@@ -31,6 +31,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/field_ref.h"
@@ -40,14 +41,53 @@ namespace mongo {
 
 bool isAllDigits(StringData str);
 
+/**
+ * A hash index over the top-level fields of an object. Building it costs a single pass over the
+ * object, after which looking up a field no longer scans the object from its start. This pays off
+ * once several fields of the same object are looked up.
+ */
+class BSONFieldIndex {
+public:
+    BSONFieldIndex() = default;
+
+    /**
+     * Indexes the fields of 'obj', replacing anything indexed before. 'obj' must outlive any
+     * lookups.
+     */
+    void build(const BSONObj& obj);
+
+    void clear();
+
+    bool isBuilt() const {
+        return !_slots.empty();
+    }
+
+    /**
+     * Returns the same element as BSONObj::getField() on the indexed object: the first field named
+     * 'name', or EOO if there is none.
+     */
+    BSONElement getField(StringData name) const;
+
+private:
+    static size_t hash(StringData name);
+
+    std::vector<BSONElement> _elements;
+
+    // Open addressing table of indexes into '_elements', or -1 for an empty slot. Its size is a
+    // power of two.
+    std::vector<int> _slots;
+};
+
 /**
  * Finds the element at 'path' in 'doc', starting at 'startIndex' in 'path'. If none is found, an
  * EOO element is returned. If an array is encountered along 'path', the traversal stops early, and
- * the array is returned. 'idxPath' is set to the furthest index reached in 'path'.
+ * the array is returned. 'idxPath' is set to the furthest index reached in 'path'. If 'docFields'
+ * is non-null, it must index the fields of 'doc' and is used to find the first part of 'path'.
  */
 BSONElement getFieldDottedOrArray(const BSONObj& doc,
                                   const FieldRef& path,
                                   size_t* idxPath,
-                                  size_t startIndex = 0);
+                                  size_t startIndex = 0,
+                                  const BSONFieldIndex* docFields = nullptr);
 
 }  // namespace mongo
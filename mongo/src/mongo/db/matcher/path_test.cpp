@@ -34,6 +34,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/path.h"
+#include "mongo/db/matcher/path_internal.h"
 
 namespace mongo {
 
@@ -464,4 +465,48 @@ TEST(SingleElementElementIterator, Simple1) {
 
     ASSERT(!i.more());
 }
+
+TEST(BSONFieldIndex, FindsSameFieldsAsGetField) {
+    BSONObjBuilder bob;
+    for (int i = 0; i < 50; ++i) {
+        bob.append(str::stream() << "f" << i, i);
+    }
+    bob.append("f7", "duplicate");
+    bob.append("", "empty");
+    BSONObj obj = bob.obj();
+
+    BSONFieldIndex index;
+    ASSERT_FALSE(index.isBuilt());
+    index.build(obj);
+    ASSERT_TRUE(index.isBuilt());
+
+    for (int i = 0; i < 50; ++i) {
+        std::string name = str::stream() << "f" << i;
+        BSONElement elem = index.getField(name);
+        ASSERT_EQUALS(obj.getField(name).rawdata(), elem.rawdata());
+        ASSERT_EQUALS(i, elem.numberInt());
+    }
+    ASSERT_EQUALS("empty", index.getField("").str());
+    ASSERT(index.getField("f50").eoo());
+    ASSERT(index.getField("f").eoo());
+
+    index.build(BSONObj());
+    ASSERT(index.getField("f0").eoo());
+}
+
+TEST(BSONFieldIndex, IteratorFindsNestedPathThroughIndex) {
+    ElementPath p;
+    ASSERT(p.init("a.b").isOK());
+
+    BSONObj doc = BSON("x" << 4 << "a" << BSON("b" << 5));
+    BSONFieldIndex index;
+    index.build(doc);
+
+    BSONElementIterator cursor(&p, doc, &index);
+    ASSERT(cursor.more());
+    ElementIterator::Context e = cursor.next();
+    ASSERT_EQUALS((string) "b", e.element().fieldName());
+    ASSERT_EQUALS(5, e.element().numberInt());
+    ASSERT(!cursor.more());
+}
 }
@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/operation_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(internalOperationArenaMaxBytes, int, 256 * 1024);
+
+namespace {
+
+const auto getOperationArena = OperationContext::declareDecoration<OperationArena>();
+const auto getClientRecentArenaBytes = Client::declareDecoration<size_t>();
+
+Counter64 arenaBytesAllocated;
+Counter64 arenaBytesReserved;
+Counter64 arenaBlocksAllocated;
+Counter64 arenaHeapFallbacks;
+
+ServerStatusMetricField<Counter64> displayArenaBytesAllocated("operationArena.bytesAllocated",
+                                                              &arenaBytesAllocated);
+ServerStatusMetricField<Counter64> displayArenaBytesReserved("operationArena.bytesReserved",
+                                                             &arenaBytesReserved);
+ServerStatusMetricField<Counter64> displayArenaBlocksAllocated("operationArena.blocksAllocated",
+                                                               &arenaBlocksAllocated);
+ServerStatusMetricField<Counter64> displayArenaHeapFallbacks("operationArena.heapFallbacks",
+                                                             &arenaHeapFallbacks);
+
+size_t maxArenaBytes() {
+    return static_cast<size_t>(std::max(0, internalOperationArenaMaxBytes.load()));
+}
+
+}  // namespace
+
+OperationArena* OperationArena::get(OperationContext* opCtx) {
+    auto& arena = getOperationArena(opCtx);
+    if (!arena._clientRecentBytesUsed && opCtx->getClient()) {
+        arena._clientRecentBytesUsed = &getClientRecentArenaBytes(opCtx->getClient());
+    }
+    return &arena;
+}
+
+OperationArena::~OperationArena() {
+    if (_clientRecentBytesUsed) {
+        // The Client outlives its operations. Let a single large operation fade from what the
+        // next operations reserve up front.
+        *_clientRecentBytesUsed = std::max(_highWaterMark, *_clientRecentBytesUsed / 2);
+    }
+    arenaBytesReserved.decrement(_bytesReserved);
+}
+
+void* OperationArena::allocate(size_t bytes, size_t alignment) {
+    invariant(alignment && (alignment & (alignment - 1)) == 0 &&
+              alignment <= alignof(std::max_align_t));
+
+    const size_t maxBytes = maxArenaBytes();
+    if (bytes > maxBytes - std::min(_bytesUsed, maxBytes)) {
+        arenaHeapFallbacks.increment();
+        return mongoMalloc(std::max<size_t>(bytes, 1));
+    }
+
+    size_t padding = 0;
+    if (_next) {
+        padding = (alignment - reinterpret_cast<uintptr_t>(_next) % alignment) % alignment;
+    }
+    if (!_next || static_cast<size_t>(_end - _next) < padding + bytes) {
+        _addBlock(bytes, maxBytes);
+        padding = 0;
+    }
+
+    _lastAllocation = _next + padding;
+    _next = _lastAllocation + bytes;
+    _bytesUsed += padding + bytes;
+    _highWaterMark = std::max(_highWaterMark, _bytesUsed);
+    arenaBytesAllocated.increment(bytes);
+    return _lastAllocation;
+}
+
+void OperationArena::deallocate(void* ptr, size_t bytes) {
+    if (!ptr) {
+        return;
+    }
+
+    char* p = static_cast<char*>(ptr);
+    if (p == _lastAllocation) {
+        // Reclaim the most recent allocation right away, which lets containers that are built and
+        // destroyed over and over reuse the same memory.
+        _bytesUsed -= _next - _lastAllocation;
+        _next = _lastAllocation;
+        _lastAllocation = nullptr;
+        return;
+    }
+
+    if (!_ownsPointer(p)) {
+        std::free(ptr);
+    }
+}
+
+void OperationArena::_addBlock(size_t minBytes, size_t maxBytes) {
+    size_t size = kMinBlockSize;
+    if (!_blocks.empty()) {
+        size = _blocks.back().size * 2;
+    } else if (_clientRecentBytesUsed) {
+        // Make the first block hold as much as recent operations on this Client have needed, so
+        // that a similar operation does not have to allocate any more blocks.
+        size = std::max(size, *_clientRecentBytesUsed);
+    }
+    size = std::max(minBytes, std::min(size, maxBytes));
+
+    _blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+    _next = _blocks.back().data.get();
+    _end = _next + size;
+    _bytesReserved += size;
+
+    arenaBytesReserved.increment(size);
+    arenaBlocksAllocated.increment();
+}
+
+bool OperationArena::_ownsPointer(const char* ptr) const {
+    return std::any_of(_blocks.begin(), _blocks.end(), [ptr](const Block& block) {
+        return std::less_equal<const char*>()(block.data.get(), ptr) &&
+            std::less<const char*>()(ptr, block.data.get() + block.size);
+    });
+}
+
+}  // namespace mongo
@@ -0,0 +1,188 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class OperationContext;
+
+// The most arena memory one operation may use before further allocations fall back to the heap.
+extern AtomicInt32 internalOperationArenaMaxBytes;
+
+/**
+ * A bump allocator for memory that lives no longer than the operation which allocated it.
+ *
+ * Each OperationContext owns one arena, which releases all of its memory in bulk when the
+ * OperationContext is destroyed, so that containers used by an operation may allocate from the
+ * arena and skip the global heap both when they grow and when they are destroyed. Nothing is kept
+ * between operations, so idle connections hold no arena memory.
+ *
+ * The Client remembers how much arena memory its recent operations used, and the first block of
+ * the next operation's arena is made that large, so that a connection which repeatedly runs
+ * similar operations allocates a single block per operation. The remembered amount halves after
+ * each operation that uses the arena but needs less, so one unusually large operation does not
+ * size all later ones.
+ *
+ * Once an operation has used 'internalOperationArenaMaxBytes' of arena memory, further requests
+ * are served by the heap and freed individually, so long-running operations cannot grow the arena
+ * without bound.
+ *
+ * Only objects that are destroyed before their OperationContext may be allocated from the arena.
+ * In particular, anything owned by a ClientCursor, such as a PlanExecutor, its WorkingSet or its
+ * CanonicalQuery, outlives the operation that created it and must not use the arena. The arena is
+ * not thread-safe; it may only be used by the thread running the operation.
+ */
+class OperationArena {
+    MONGO_DISALLOW_COPYING(OperationArena);
+
+public:
+    // The size of the first block the arena allocates.
+    static const size_t kMinBlockSize = 4 * 1024;
+
+    OperationArena() = default;
+    ~OperationArena();
+
+    /**
+     * Returns the arena of 'opCtx'.
+     */
+    static OperationArena* get(OperationContext* opCtx);
+
+    /**
+     * Returns 'bytes' of memory aligned to 'alignment', which must be a power of two no larger
+     * than alignof(std::max_align_t).
+     */
+    void* allocate(size_t bytes, size_t alignment);
+
+    /**
+     * Returns memory obtained from allocate(). Memory served by the heap is freed immediately.
+     * Arena memory is reclaimed right away only if it is the most recent arena allocation, and
+     * otherwise when the arena is next reset.
+     */
+    void deallocate(void* ptr, size_t bytes);
+
+    /**
+     * The number of bytes of arena memory handed out, including memory that has since been
+     * deallocated but not yet reclaimed.
+     */
+    size_t bytesUsed() const {
+        return _bytesUsed;
+    }
+
+    /**
+     * The number of bytes the arena currently holds in blocks.
+     */
+    size_t bytesReserved() const {
+        return _bytesReserved;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    void _addBlock(size_t minBytes, size_t maxBytes);
+    bool _ownsPointer(const char* ptr) const;
+
+    std::vector<Block> _blocks;
+
+    // The free space of the most recently added block.
+    char* _next = nullptr;
+    char* _end = nullptr;
+
+    // The start of the most recent arena allocation, which deallocate() can reclaim immediately.
+    char* _lastAllocation = nullptr;
+
+    size_t _bytesUsed = 0;
+    size_t _bytesReserved = 0;
+
+    // The largest value _bytesUsed has reached.
+    size_t _highWaterMark = 0;
+
+    // The arena memory recently used by operations on the Client running this operation, which
+    // sizes the first block and is updated when the arena is destroyed. Null if the operation has
+    // no Client.
+    size_t* _clientRecentBytesUsed = nullptr;
+};
+
+/**
+ * A standard allocator that draws from an OperationArena. A null arena makes it allocate from the
+ * heap, so that code may use the same container type whether or not an arena is available.
+ */
+template <typename T>
+class OperationArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit OperationArenaAllocator(OperationArena* arena) : _arena(arena) {}
+
+    template <typename U>
+    OperationArenaAllocator(const OperationArenaAllocator<U>& other) : _arena(other.arena()) {}
+
+    T* allocate(size_t n) {
+        if (!_arena) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        if (!_arena) {
+            std::allocator<T>().deallocate(ptr, n);
+            return;
+        }
+        _arena->deallocate(ptr, n * sizeof(T));
+    }
+
+    OperationArena* arena() const {
+        return _arena;
+    }
+
+private:
+    OperationArena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const OperationArenaAllocator<T>& lhs, const OperationArenaAllocator<U>& rhs) {
+    return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const OperationArenaAllocator<T>& lhs, const OperationArenaAllocator<U>& rhs) {
+    return !(lhs == rhs);
+}
+
+}  // namespace mongo
@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_arena.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context_noop.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+TEST(OperationArenaTest, AllocationsAreAlignedAndDoNotOverlap) {
+    OperationArena arena;
+    char* first = static_cast<char*>(arena.allocate(3, 1));
+    char* second = static_cast<char*>(arena.allocate(sizeof(double), alignof(double)));
+
+    ASSERT_EQUALS(0U, reinterpret_cast<uintptr_t>(second) % alignof(double));
+    ASSERT_GTE(second, first + 3);
+    ASSERT_LTE(arena.bytesUsed(), arena.bytesReserved());
+}
+
+TEST(OperationArenaTest, ReclaimsMostRecentAllocationImmediately) {
+    OperationArena arena;
+    void* first = arena.allocate(100, 8);
+    void* second = arena.allocate(100, 8);
+    const size_t bytesUsed = arena.bytesUsed();
+
+    arena.deallocate(second, 100);
+    ASSERT_LT(arena.bytesUsed(), bytesUsed);
+    ASSERT_EQUALS(second, arena.allocate(100, 8));
+
+    // Older allocations are only reclaimed when the arena is reset.
+    arena.deallocate(first, 100);
+    ASSERT_EQUALS(bytesUsed, arena.bytesUsed());
+}
+
+TEST(OperationArenaTest, FallsBackToHeapPastMaxBytes) {
+    const int oldMaxBytes = internalOperationArenaMaxBytes.load();
+    internalOperationArenaMaxBytes.store(8 * 1024);
+    ON_BLOCK_EXIT([oldMaxBytes] { internalOperationArenaMaxBytes.store(oldMaxBytes); });
+
+    OperationArena arena;
+    arena.allocate(6 * 1024, 8);
+    const size_t bytesUsed = arena.bytesUsed();
+    const size_t bytesReserved = arena.bytesReserved();
+
+    void* fromHeap = arena.allocate(4 * 1024, 8);
+    ASSERT(fromHeap);
+    ASSERT_EQUALS(bytesUsed, arena.bytesUsed());
+    ASSERT_EQUALS(bytesReserved, arena.bytesReserved());
+    arena.deallocate(fromHeap, 4 * 1024);
+}
+
+TEST(OperationArenaTest, SizesFirstBlockFromRecentOperationsOnTheClient) {
+    auto serviceCtx = stdx::make_unique<ServiceContextNoop>();
+    auto client = serviceCtx->makeClient("OperationArenaTest");
+
+    {
+        auto opCtx = client->makeOperationContext();
+        OperationArena* arena = OperationArena::get(opCtx.get());
+        ASSERT(arena);
+        for (int i = 0; i < 8; ++i) {
+            arena->allocate(OperationArena::kMinBlockSize, 8);
+        }
+        ASSERT_EQUALS(arena, OperationArena::get(opCtx.get()));
+        ASSERT_EQUALS(8 * OperationArena::kMinBlockSize, arena->bytesUsed());
+    }
+
+    {
+        // Nothing is held between operations, but the first block holds the whole of an identical
+        // operation.
+        auto opCtx = client->makeOperationContext();
+        OperationArena* arena = OperationArena::get(opCtx.get());
+        ASSERT_EQUALS(0U, arena->bytesUsed());
+        ASSERT_EQUALS(0U, arena->bytesReserved());
+        for (int i = 0; i < 8; ++i) {
+            arena->allocate(OperationArena::kMinBlockSize, 8);
+        }
+        ASSERT_EQUALS(8 * OperationArena::kMinBlockSize, arena->bytesReserved());
+    }
+
+    {
+        // A smaller operation only halves what the next one reserves up front.
+        auto opCtx = client->makeOperationContext();
+        OperationArena* arena = OperationArena::get(opCtx.get());
+        arena->allocate(8, 8);
+        ASSERT_EQUALS(8 * OperationArena::kMinBlockSize, arena->bytesReserved());
+    }
+
+    auto opCtx = client->makeOperationContext();
+    OperationArena* arena = OperationArena::get(opCtx.get());
+    arena->allocate(8, 8);
+    ASSERT_EQUALS(4 * OperationArena::kMinBlockSize, arena->bytesReserved());
+}
+
+TEST(OperationArenaTest, AllocatorBacksStandardContainers) {
+    OperationArena arena;
+    std::vector<int, OperationArenaAllocator<int>> fromArena{OperationArenaAllocator<int>(&arena)};
+    std::vector<int, OperationArenaAllocator<int>> fromHeap{OperationArenaAllocator<int>(nullptr)};
+    for (int i = 0; i < 1000; ++i) {
+        fromArena.push_back(i);
+        fromHeap.push_back(i);
+    }
+
+    ASSERT(fromArena == fromHeap);
+    ASSERT_GTE(arena.bytesUsed(), 1000 * sizeof(int));
+}
+
+}  // namespace
+}  // namespace mongo
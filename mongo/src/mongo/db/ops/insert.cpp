@@ -50,6 +50,14 @@ namespace {
  * Validates the nesting depth of 'obj', returning a non-OK status if it exceeds the limit.
  */ //Ƕĵȼ  ĬǶ180
 Status validateDepth(const BSONObj& obj) {
+    // Every level of nesting takes at least 7 bytes: the type byte, an empty field name, and an
+    // empty object. Documents too small to reach the limit need not be walked.
+    const uint64_t kMinBytesPerLevel = 7;
+    if (static_cast<uint64_t>(obj.objsize()) <
+        BSONObj().objsize() + kMinBytesPerLevel * BSONDepth::getMaxDepthForUserStorage()) {
+        return Status::OK();
+    }
+
     std::vector<BSONObjIterator> frames;
     frames.reserve(16);
     frames.emplace_back(obj);
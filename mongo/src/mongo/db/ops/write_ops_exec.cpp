@@ -583,12 +583,13 @@ WriteResult performInserts(OperationContext* opCtx, const write_ops::Insert& who
                 }
             }
 
+            // Documents that needed no fixing are inserted as views into the request message.
             BSONObj toInsert = fixedDoc.getValue().isEmpty() ? doc : std::move(fixedDoc.getValue());
 			// db.collname.insert({"name":"yangyazhou1", "age":22})
 			//yang test performInserts... doc:{ _id: ObjectId('5badf00412ee982ae019e0c1'), name: "yangyazhou1", age: 22.0 }
 			//log() << "yang test performInserts... doc:" << redact(toInsert);
 			//ĵ뵽batch
-            batch.emplace_back(stmtId, toInsert);
+            batch.emplace_back(stmtId, std::move(toInsert));
             bytesInBatch += batch.back().doc.objsize();
 			//continueΪ˰ĵɵһbatchУһһԲ
 
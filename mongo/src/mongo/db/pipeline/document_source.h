@@ -527,6 +527,15 @@ public:
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
+    /**
+     * Returns true if documents which have equal values for the fields of one of the sorts from
+     * getOutputSorts() are always adjacent in the output of the stage. This does not hold in
+     * general, since an array sorts by one of its elements and a missing field sorts as null.
+     */
+    virtual bool outputSortsKeepGroupsTogether() const {
+        return false;
+    }
+
     struct GetModPathsReturn {
         enum class Type {
             // No information is available about which paths are modified.
@@ -264,7 +264,8 @@ DocumentSourceCursor::DocumentSourceCursor(
     : DocumentSource(pCtx),
       _docsAddedToBatches(0),
       _exec(std::move(exec)),
-      _outputSorts(_exec->getOutputSorts()) {
+      _outputSorts(_exec->getOutputSorts()),
+      _outputCovered(_exec->isCovered()) {
 
     _planSummary = Explain::getPlanSummary(_exec.get());
     recordPlanSummaryStats();
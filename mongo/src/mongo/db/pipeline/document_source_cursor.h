@@ -49,6 +49,11 @@ public:
     BSONObjSet getOutputSorts() final {
         return _outputSorts;
     }
+    // A covered plan reads no multikey index and outputs null for missing fields, so equal keys
+    // are adjacent in any order the plan provides.
+    bool outputSortsKeepGroupsTogether() const final {
+        return _outputCovered;
+    }
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
 
     StageConstraints constraints(Pipeline::SplitState pipeState) const final {
@@ -193,6 +198,7 @@ private:
     std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _exec;
 
     BSONObjSet _outputSorts;
+    bool _outputCovered;
     std::string _planSummary;
     PlanSummaryStats _planSummaryStats;
 };
@@ -39,6 +39,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/stdx/memory.h"
 
@@ -48,6 +49,24 @@ using boost::intrusive_ptr;
 
 namespace dps = ::mongo::dotted_path_support;
 
+namespace {
+
+class SorterComparator {
+public:
+    typedef std::pair<Value, Value> Data;
+
+    SorterComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
+
+    int operator()(const Data& lhs, const Data& rhs) const {
+        return _valueComparator.compare(lhs.first, rhs.first);
+    }
+
+private:
+    ValueComparator _valueComparator;
+};
+
+}  // namespace
+
 std::unique_ptr<LiteParsedDocumentSourceForeignCollections> DocumentSourceGraphLookUp::liteParse(
     const AggregationRequest& request, const BSONElement& spec) {
     uassert(ErrorCodes::FailedToParse,
@@ -104,11 +123,9 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNext() {
     performSearch();
 
     std::vector<Value> results;
-    while (!_visited.empty()) {
+    while (auto result = popVisited()) {
         // Remove elements one at a time to avoid consuming more memory.
-        auto it = _visited.begin();
-        results.push_back(Value(it->second));
-        _visited.erase(it);
+        results.push_back(Value(std::move(*result)));
     }
 
     MutableDocument output(*_input);
@@ -127,7 +144,8 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
     // If the unwind is not preserving empty arrays, we might have to process multiple inputs before
     // we get one that will produce an output.
     while (true) {
-        if (_visited.empty()) {
+        auto result = popVisited();
+        if (!result) {
             // No results are left for the current input, so we should move on to the next one and
             // perform a new search.
 
@@ -140,10 +158,12 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
             performSearch();
             _visitedUsageBytes = 0;
             _outputIndex = 0;
+
+            result = popVisited();
         }
         MutableDocument unwound(*_input);
 
-        if (_visited.empty()) {
+        if (!result) {
             if ((*_unwind)->preserveNullAndEmptyArrays()) {
                 // Since "preserveNullAndEmptyArrays" was specified, output a document even though
                 // we had no result.
@@ -157,69 +177,107 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
                 continue;
             }
         } else {
-            auto it = _visited.begin();
-            unwound.setNestedField(_as, Value(it->second));
+            unwound.setNestedField(_as, Value(std::move(*result)));
             if (indexPath) {
                 unwound.setNestedField(*indexPath, Value(_outputIndex));
                 ++_outputIndex;
             }
-            _visited.erase(it);
         }
 
         return unwound.freeze();
     }
 }
 
+boost::optional<Document> DocumentSourceGraphLookUp::popVisited() {
+    if (!_visited.empty()) {
+        auto it = _visited.begin();
+        auto result = std::move(it->second);
+        _visited.erase(it);
+        return result;
+    }
+
+    while (!_visitedSpills.empty()) {
+        auto& spill = _visitedSpills.back();
+        if (spill->more()) {
+            return spill->next().second.getDocument();
+        }
+        _visitedSpills.pop_back();
+    }
+
+    return boost::none;
+}
+
 void DocumentSourceGraphLookUp::doDispose() {
     _cache.clear();
     _frontier.clear();
     _visited.clear();
+    _visitedSpills.clear();
+    _spilledVisitedIds.clear();
+    _spilledVisitedIdsUsageBytes = 0;
+    _frontierSpills.clear();
 }
 
 void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
+    const size_t maxBatchSize =
+        std::max(1, internalDocumentSourceGraphLookupMaxFrontierBatchSize.load());
+
     long long depth = 0;
     bool shouldPerformAnotherQuery;
     do {
         shouldPerformAnotherQuery = false;
 
-        // Check whether each key in the frontier exists in the cache or needs to be queried.
-        auto cached = pExpCtx->getDocumentComparator().makeUnorderedDocumentSet();
-        auto matchStage = makeMatchStageFromFrontier(&cached);
-
-        ValueUnorderedSet queried = pExpCtx->getValueComparator().makeUnorderedValueSet();
-        _frontier.swap(queried);
+        // Take ownership of the values discovered by the previous level, so that '_frontier' and
+        // '_frontierSpills' can be populated for the next iteration of search. If the previous
+        // level spilled, the in-memory remainder is spilled too and the sorted runs are merged,
+        // which brings duplicate values next to each other.
+        ValueUnorderedSet levelFrontier = pExpCtx->getValueComparator().makeUnorderedValueSet();
+        std::unique_ptr<SpillIterator> spilledFrontier;
+        if (!_frontierSpills.empty()) {
+            if (!_frontier.empty()) {
+                spillFrontier();
+            }
+            spilledFrontier.reset(SpillIterator::merge(
+                _frontierSpills, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+            _frontierSpills.clear();
+        } else {
+            _frontier.swap(levelFrontier);
+        }
         _frontierUsageBytes = 0;
 
-        // Process cached values, populating '_frontier' for the next iteration of search.
-        while (!cached.empty()) {
-            auto doc = *cached.begin();
-            cached.erase(cached.begin());
-            shouldPerformAnotherQuery =
-                addToVisitedAndFrontier(std::move(doc), depth) || shouldPerformAnotherQuery;
-            checkMemoryUsage();
-        }
+        // Query the frontier in batches of at most 'maxBatchSize' values, so that neither the
+        // size of an individual $in query nor the memory needed to hold the values being queried
+        // grows with the size of the frontier.
+        auto levelIt = levelFrontier.begin();
+        boost::optional<Value> lastSpilledValue;
+        ValueUnorderedSet batch = pExpCtx->getValueComparator().makeUnorderedValueSet();
+        while (true) {
+            while (batch.size() < maxBatchSize) {
+                if (spilledFrontier) {
+                    if (!spilledFrontier->more()) {
+                        break;
+                    }
+                    auto value = spilledFrontier->next().first;
+                    if (lastSpilledValue &&
+                        pExpCtx->getValueComparator().evaluate(*lastSpilledValue == value)) {
+                        continue;
+                    }
+                    lastSpilledValue = value;
+                    batch.insert(std::move(value));
+                } else {
+                    if (levelIt == levelFrontier.end()) {
+                        break;
+                    }
+                    batch.insert(*levelIt++);
+                }
+            }
 
-        if (matchStage) {
-            // Query for all keys that were in the frontier and not in the cache, populating
-            // '_frontier' for the next iteration of search.
-
-            // We've already allocated space for the trailing $match stage in '_fromPipeline'.
-            _fromPipeline.back() = *matchStage;
-            auto pipeline =
-                uassertStatusOK(_mongoProcessInterface->makePipeline(_fromPipeline, _fromExpCtx));
-            while (auto next = pipeline->getNext()) {
-                uassert(40271,
-                        str::stream()
-                            << "Documents in the '"
-                            << _from.ns()
-                            << "' namespace must contain an _id for de-duplication in $graphLookup",
-                        !(*next)["_id"].missing());
-
-                shouldPerformAnotherQuery =
-                    addToVisitedAndFrontier(*next, depth) || shouldPerformAnotherQuery;
-                addToCache(std::move(*next), queried);
+            if (batch.empty()) {
+                break;
             }
-            checkMemoryUsage();
+
+            shouldPerformAnotherQuery =
+                searchFrontierBatch(&batch, depth) || shouldPerformAnotherQuery;
+            batch.clear();
         }
 
         ++depth;
@@ -227,13 +285,64 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
              (!_maxDepth || depth <= *_maxDepth));
 
     _frontier.clear();
+    _frontierSpills.clear();
     _frontierUsageBytes = 0;
+
+    // The spilled '_id' values are only needed for de-duplication while searching.
+    _spilledVisitedIds.clear();
+    _spilledVisitedIdsUsageBytes = 0;
+}
+
+bool DocumentSourceGraphLookUp::searchFrontierBatch(ValueUnorderedSet* frontierBatch,
+                                                    long long depth) {
+    bool shouldPerformAnotherQuery = false;
+
+    // Check whether each key in the batch exists in the cache or needs to be queried.
+    auto cached = pExpCtx->getDocumentComparator().makeUnorderedDocumentSet();
+    auto matchStage = makeMatchStageFromFrontier(frontierBatch, &cached);
+
+    // Process cached values, populating '_frontier' for the next iteration of search.
+    while (!cached.empty()) {
+        auto doc = *cached.begin();
+        cached.erase(cached.begin());
+        shouldPerformAnotherQuery =
+            addToVisitedAndFrontier(std::move(doc), depth) || shouldPerformAnotherQuery;
+        checkMemoryUsage();
+    }
+
+    if (matchStage) {
+        // Query for all keys that were in the batch and not in the cache, populating '_frontier'
+        // for the next iteration of search.
+        ++_searchStats.numQueries;
+
+        // We've already allocated space for the trailing $match stage in '_fromPipeline'.
+        _fromPipeline.back() = *matchStage;
+        auto pipeline =
+            uassertStatusOK(_mongoProcessInterface->makePipeline(_fromPipeline, _fromExpCtx));
+        while (auto next = pipeline->getNext()) {
+            uassert(40271,
+                    str::stream()
+                        << "Documents in the '"
+                        << _from.ns()
+                        << "' namespace must contain an _id for de-duplication in $graphLookup",
+                    !(*next)["_id"].missing());
+
+            ++_searchStats.numDocsReturned;
+            shouldPerformAnotherQuery =
+                addToVisitedAndFrontier(*next, depth) || shouldPerformAnotherQuery;
+            addToCache(std::move(*next), *frontierBatch);
+            checkMemoryUsage();
+        }
+    }
+
+    return shouldPerformAnotherQuery;
 }
 
 bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long long depth) {
     auto id = result.getField("_id");
 
-    if (_visited.find(id) != _visited.end()) {
+    if (_visited.find(id) != _visited.end() ||
+        _spilledVisitedIds.find(id) != _spilledVisitedIds.end()) {
         // We've already seen this object, don't repeat any work.
         return false;
     }
@@ -281,18 +390,13 @@ void DocumentSourceGraphLookUp::addToCache(const Document& result,
 }
 
 boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
-    DocumentUnorderedSet* cached) {
-    // Add any cached values to 'cached' and remove them from '_frontier'.
-    for (auto it = _frontier.begin(); it != _frontier.end();) {
+    ValueUnorderedSet* frontierBatch, DocumentUnorderedSet* cached) {
+    // Add any cached values to 'cached' and remove them from 'frontierBatch'.
+    for (auto it = frontierBatch->begin(); it != frontierBatch->end();) {
         if (auto entry = _cache[*it]) {
             cached->insert(entry->begin(), entry->end());
-            size_t valueSize = it->getApproximateSize();
-            it = _frontier.erase(it);
-
-            // If the cached value increased in size while in the cache, we don't want to underflow
-            // '_frontierUsageBytes'.
-            invariant(valueSize <= _frontierUsageBytes);
-            _frontierUsageBytes -= valueSize;
+            it = frontierBatch->erase(it);
+            ++_searchStats.numCacheHits;
         } else {
             ++it;
         }
@@ -317,7 +421,7 @@ boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
                     BSONObjBuilder subObj(connectToObj.subobjStart(_connectToField.fullPath()));
                     {
                         BSONArrayBuilder in(subObj.subarrayStart("$in"));
-                        for (auto&& value : _frontier) {
+                        for (auto&& value : *frontierBatch) {
                             in << value;
                         }
                     }
@@ -326,7 +430,7 @@ boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
         }
     }
 
-    return _frontier.empty() ? boost::none : boost::optional<BSONObj>(match.obj());
+    return frontierBatch->empty() ? boost::none : boost::optional<BSONObj>(match.obj());
 }
 
 void DocumentSourceGraphLookUp::performSearch() {
@@ -388,11 +492,50 @@ BSONObjSet DocumentSourceGraphLookUp::getOutputSorts() {
 }
 
 void DocumentSourceGraphLookUp::checkMemoryUsage() {
-    // TODO SERVER-23980: Implement spilling to disk if allowDiskUse is specified.
+    if (_allowDiskUse && memoryUsageBytes() >= _maxMemoryUsageBytes) {
+        // Discovered documents are typically much larger than frontier values, so spill them
+        // first.
+        if (!_visited.empty()) {
+            spillVisited();
+        }
+        if (memoryUsageBytes() >= _maxMemoryUsageBytes && !_frontier.empty()) {
+            spillFrontier();
+        }
+    }
+
     uassert(40099,
-            "$graphLookup reached maximum memory consumption",
-            (_visitedUsageBytes + _frontierUsageBytes) < _maxMemoryUsageBytes);
-    _cache.evictDownTo(_maxMemoryUsageBytes - _frontierUsageBytes - _visitedUsageBytes);
+            str::stream() << "$graphLookup reached maximum memory consumption"
+                          << (_allowDiskUse ? "" : ". Pass allowDiskUse:true to opt in."),
+            memoryUsageBytes() < _maxMemoryUsageBytes);
+    _cache.evictDownTo(_maxMemoryUsageBytes - memoryUsageBytes());
+}
+
+void DocumentSourceGraphLookUp::spillVisited() {
+    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
+    for (auto&& visited : _visited) {
+        writer.addAlreadySorted(visited.first, Value(visited.second));
+        _visitedUsageBytes -= visited.first.getApproximateSize();
+        _visitedUsageBytes -= visited.second.getApproximateSize();
+        _spilledVisitedIdsUsageBytes += visited.first.getApproximateSize();
+        _spilledVisitedIds.insert(visited.first);
+    }
+    _visited.clear();
+    _visitedSpills.push_back(std::shared_ptr<SpillIterator>(writer.done()));
+    ++_searchStats.numSpills;
+}
+
+void DocumentSourceGraphLookUp::spillFrontier() {
+    std::vector<Value> values(_frontier.begin(), _frontier.end());
+    std::sort(values.begin(), values.end(), pExpCtx->getValueComparator().getLessThan());
+
+    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
+    for (auto&& value : values) {
+        writer.addAlreadySorted(value, Value());
+    }
+    _frontier.clear();
+    _frontierUsageBytes = 0;
+    _frontierSpills.push_back(std::shared_ptr<SpillIterator>(writer.done()));
+    ++_searchStats.numSpills;
 }
 
 void DocumentSourceGraphLookUp::serializeToArray(
@@ -464,8 +607,10 @@ DocumentSourceGraphLookUp::DocumentSourceGraphLookUp(
       _additionalFilter(additionalFilter),
       _depthField(depthField),
       _maxDepth(maxDepth),
+      _allowDiskUse(expCtx->allowDiskUse && !expCtx->inMongos),
       _frontier(pExpCtx->getValueComparator().makeUnorderedValueSet()),
       _visited(ValueComparator::kInstance.makeUnorderedValueMap<Document>()),
+      _spilledVisitedIds(ValueComparator::kInstance.makeUnorderedValueSet()),
       _cache(pExpCtx->getValueComparator()),
       _unwind(unwindSrc) {
     const auto& resolvedNamespace = pExpCtx->getResolvedNamespace(_from);
@@ -607,3 +752,6 @@ intrusive_ptr<DocumentSource> DocumentSourceGraphLookUp::createFromBson(
     return std::move(newSource);
 }
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
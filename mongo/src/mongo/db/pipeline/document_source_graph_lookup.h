@@ -33,6 +33,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
 
@@ -57,7 +58,7 @@ public:
         StageConstraints constraints(StreamType::kStreaming,
                                      PositionRequirement::kNone,
                                      HostTypeRequirement::kPrimaryShard,
-                                     DiskUseRequirement::kNoDiskUse,
+                                     DiskUseRequirement::kWritesTmpData,
                                      FacetRequirement::kAllowed);
 
         constraints.canSwapWithMatch = true;
@@ -92,6 +93,32 @@ public:
     static boost::intrusive_ptr<DocumentSource> createFromBson(
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
+    void setMaxMemoryUsageBytes_forTest(size_t maxMemoryUsageBytes) {
+        _maxMemoryUsageBytes = maxMemoryUsageBytes;
+    }
+
+    /**
+     * Statistics about the breadth-first searches of all input documents, reported in the slow
+     * query log and the profiler.
+     */
+    struct SearchStats {
+        // The number of queries against the 'from' collection.
+        long long numQueries = 0;
+
+        // The number of frontier values answered from the cache rather than by a query.
+        long long numCacheHits = 0;
+
+        // The number of documents returned by the queries.
+        long long numDocsReturned = 0;
+
+        // The number of times the visited documents or the frontier were written to disk.
+        long long numSpills = 0;
+    };
+
+    const SearchStats& getSearchStats() const {
+        return _searchStats;
+    }
+
 protected:
     void doDispose() final;
 
@@ -119,16 +146,43 @@ private:
         MONGO_UNREACHABLE;
     }
 
+    using SpillIterator = Sorter<Value, Value>::Iterator;
+
     /**
      * Prepares the query to execute on the 'from' collection wrapped in a $match by using the
-     * contents of '_frontier'.
+     * contents of 'frontierBatch'.
      *
-     * Fills 'cached' with any values that were retrieved from the cache.
+     * Fills 'cached' with any values that were retrieved from the cache, removing those values from
+     * 'frontierBatch'.
      *
      * Returns boost::none if no query is necessary, i.e., all values were retrieved from the cache.
      * Otherwise, returns a query object.
      */
-    boost::optional<BSONObj> makeMatchStageFromFrontier(DocumentUnorderedSet* cached);
+    boost::optional<BSONObj> makeMatchStageFromFrontier(ValueUnorderedSet* frontierBatch,
+                                                        DocumentUnorderedSet* cached);
+
+    /**
+     * Looks up every value of 'frontierBatch' at depth 'depth', either in '_cache' or with a single
+     * $in query against the 'from' collection. Returns whether '_visited' was updated.
+     */
+    bool searchFrontierBatch(ValueUnorderedSet* frontierBatch, long long depth);
+
+    /**
+     * Returns the next document found by the last search, removing it from the in-memory or spilled
+     * visited set. Returns boost::none once all of them have been returned.
+     */
+    boost::optional<Document> popVisited();
+
+    /**
+     * Writes the documents held in '_visited' to a temporary file, keeping only their _ids in
+     * memory for de-duplication. Those _ids still count towards '_maxMemoryUsageBytes'.
+     */
+    void spillVisited();
+
+    /**
+     * Writes the values held in '_frontier' to a sorted temporary file.
+     */
+    void spillFrontier();
 
     /**
      * If we have internalized a $unwind, getNext() dispatches to this function.
@@ -155,11 +209,19 @@ private:
     void addToCache(const Document& result, const ValueUnorderedSet& queried);
 
     /**
-     * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, and then
-     * evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'.
+     * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, spilling
+     * them to disk first if allowed, and then evict from '_cache' until this source is using less
+     * than '_maxMemoryUsageBytes'.
      */
     void checkMemoryUsage();
 
+    /**
+     * Returns the memory used by '_visited', '_spilledVisitedIds' and '_frontier'.
+     */
+    size_t memoryUsageBytes() const {
+        return _visitedUsageBytes + _spilledVisitedIdsUsageBytes + _frontierUsageBytes;
+    }
+
     /**
      * Process 'result', adding it to '_visited' with the given 'depth', and updating '_frontier'
      * with the object's 'connectTo' values.
@@ -187,8 +249,13 @@ private:
 
     size_t _maxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    // Whether '_visited' and '_frontier' may be spilled to disk once '_maxMemoryUsageBytes' is
+    // reached.
+    const bool _allowDiskUse;
+
     // Track memory usage to ensure we don't exceed '_maxMemoryUsageBytes'.
     size_t _visitedUsageBytes = 0;
+    size_t _spilledVisitedIdsUsageBytes = 0;
     size_t _frontierUsageBytes = 0;
 
     // Only used during the breadth-first search, tracks the set of values on the current frontier.
@@ -199,6 +266,17 @@ private:
     // using the simple collation.
     ValueUnorderedMap<Document> _visited;
 
+    // Documents discovered for the current input which have been spilled out of '_visited', and
+    // their '_id' values, which must be kept in memory to continue de-duplicating the search.
+    std::vector<std::shared_ptr<SpillIterator>> _visitedSpills;
+    ValueUnorderedSet _spilledVisitedIds;
+
+    // Sorted runs of frontier values for the next level of the search which have been spilled out
+    // of '_frontier'.
+    std::vector<std::shared_ptr<SpillIterator>> _frontierSpills;
+
+    SearchStats _searchStats;
+
     // Caches query results to avoid repeating any work. This structure is maintained across calls
     // to getNext().
     LookupSetCache _cache;
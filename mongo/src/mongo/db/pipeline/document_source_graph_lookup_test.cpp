@@ -37,9 +37,12 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
 #include "mongo/db/pipeline/stub_mongo_process_interface.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -624,5 +627,230 @@ TEST_F(DocumentSourceGraphLookUpTest, ShouldNotExpandArraysWithinArraysAtEndOfCo
     ASSERT(graphLookupStage->getNext().isEOF());
 }
 
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldErrorWhenMemoryLimitIsExceededWithoutAllowDiskUse) {
+    auto expCtx = getExpCtx();
+    expCtx->allowDiskUse = false;
+
+    std::deque<DocumentSource::GetNextResult> inputs{Document{{"_id", 0}, {"startVal", 0}}};
+    auto inputMock = DocumentSourceMock::create(std::move(inputs));
+
+    // Make a chain 0 -> 1 -> ... -> 19.
+    std::deque<DocumentSource::GetNextResult> fromContents;
+    for (int i = 0; i < 20; ++i) {
+        fromContents.push_back(Document{{"_id", i}, {"to", i + 1}});
+    }
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "to",
+                                          "_id",
+                                          ExpressionFieldPath::create(expCtx, "startVal"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+    graphLookupStage->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterfaceImplementation>(std::move(fromContents)));
+    graphLookupStage->setMaxMemoryUsageBytes_forTest(1000);
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldSpillVisitedDocumentsWithAllowDiskUse) {
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    std::deque<DocumentSource::GetNextResult> inputs{Document{{"_id", 0}, {"startVal", 0}}};
+    auto inputMock = DocumentSourceMock::create(std::move(inputs));
+
+    // Make a chain 0 -> 1 -> ... -> 19.
+    std::deque<DocumentSource::GetNextResult> fromContents;
+    std::vector<Document> chain;
+    for (int i = 0; i < 20; ++i) {
+        chain.push_back(Document{{"_id", i}, {"to", i + 1}});
+        fromContents.push_back(Document(chain.back()));
+    }
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "to",
+                                          "_id",
+                                          ExpressionFieldPath::create(expCtx, "startVal"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+    graphLookupStage->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterfaceImplementation>(std::move(fromContents)));
+    graphLookupStage->setMaxMemoryUsageBytes_forTest(1000);
+
+    auto next = graphLookupStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+
+    auto resultsValue = next.getDocument().getField("results");
+    ASSERT(resultsValue.isArray());
+    auto resultsArray = resultsValue.getArray();
+    ASSERT_EQ(chain.size(), resultsArray.size());
+    for (auto&& doc : chain) {
+        ASSERT(arrayContains(expCtx, resultsArray, Value(doc)));
+    }
+    ASSERT(graphLookupStage->getNext().isEOF());
+
+    // Each level of the chain, and the level which finds nothing, queries once.
+    const auto& searchStats = graphLookupStage->getSearchStats();
+    ASSERT_GT(searchStats.numSpills, 0LL);
+    ASSERT_EQ(static_cast<long long>(chain.size() + 1), searchStats.numQueries);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldCountSpilledIdsTowardsMemoryLimit) {
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    std::deque<DocumentSource::GetNextResult> inputs{Document{{"_id", 0}, {"startVal", 0}}};
+    auto inputMock = DocumentSourceMock::create(std::move(inputs));
+
+    // Make a chain 0 -> 1 -> ... -> 19 whose _ids alone exceed the memory limit, so spilling the
+    // documents cannot bring the search back under it.
+    const std::string padding(200, 'x');
+    std::deque<DocumentSource::GetNextResult> fromContents;
+    for (int i = 0; i < 20; ++i) {
+        fromContents.push_back(Document{{"_id", Document{{"id", i}, {"padding", padding}}},
+                                        {"key", i},
+                                        {"to", i + 1}});
+    }
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "to",
+                                          "key",
+                                          ExpressionFieldPath::create(expCtx, "startVal"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+    graphLookupStage->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterfaceImplementation>(std::move(fromContents)));
+    graphLookupStage->setMaxMemoryUsageBytes_forTest(2000);
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+    ASSERT_GT(graphLookupStage->getSearchStats().numSpills, 0LL);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldSpillFrontierWithAllowDiskUse) {
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    std::deque<DocumentSource::GetNextResult> inputs{Document{{"_id", 0}, {"startVal", 0}}};
+    auto inputMock = DocumentSourceMock::create(std::move(inputs));
+
+    // Make a star with 300 edges out of the root, only three of which lead to another document.
+    std::vector<Value> edges;
+    for (int i = 1; i <= 300; ++i) {
+        edges.push_back(Value(i));
+    }
+    Document root{{"_id", 0}, {"to", edges}};
+    std::vector<Document> leaves{Document{{"_id", 1}}, Document{{"_id", 2}}, Document{{"_id", 3}}};
+    std::deque<DocumentSource::GetNextResult> fromContents{
+        Document(root), Document(leaves[0]), Document(leaves[1]), Document(leaves[2])};
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "to",
+                                          "_id",
+                                          ExpressionFieldPath::create(expCtx, "startVal"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+    graphLookupStage->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterfaceImplementation>(std::move(fromContents)));
+    graphLookupStage->setMaxMemoryUsageBytes_forTest(3000);
+
+    auto next = graphLookupStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+
+    auto resultsArray = next.getDocument().getField("results").getArray();
+    ASSERT_EQ(4U, resultsArray.size());
+    ASSERT(arrayContains(expCtx, resultsArray, Value(root)));
+    for (auto&& leaf : leaves) {
+        ASSERT(arrayContains(expCtx, resultsArray, Value(leaf)));
+    }
+    ASSERT(graphLookupStage->getNext().isEOF());
+    ASSERT_GT(graphLookupStage->getSearchStats().numSpills, 0LL);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldQueryFrontierInBatches) {
+    auto expCtx = getExpCtx();
+
+    const int oldBatchSize = internalDocumentSourceGraphLookupMaxFrontierBatchSize.load();
+    ON_BLOCK_EXIT([oldBatchSize] {
+        internalDocumentSourceGraphLookupMaxFrontierBatchSize.store(oldBatchSize);
+    });
+    internalDocumentSourceGraphLookupMaxFrontierBatchSize.store(2);
+
+    std::deque<DocumentSource::GetNextResult> inputs{
+        Document{{"_id", 0},
+                 {"startVal", std::vector<Value>{Value(1), Value(2), Value(3), Value(4), Value(5)}}}};
+    auto inputMock = DocumentSourceMock::create(std::move(inputs));
+
+    std::deque<DocumentSource::GetNextResult> fromContents;
+    for (int i = 1; i <= 5; ++i) {
+        fromContents.push_back(Document{{"_id", i}});
+    }
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "to",
+                                          "_id",
+                                          ExpressionFieldPath::create(expCtx, "startVal"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+    graphLookupStage->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterfaceImplementation>(std::move(fromContents)));
+
+    auto next = graphLookupStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_EQ(5U, next.getDocument().getField("results").getArrayLength());
+    ASSERT(graphLookupStage->getNext().isEOF());
+
+    const auto& searchStats = graphLookupStage->getSearchStats();
+    ASSERT_EQ(3LL, searchStats.numQueries);
+    ASSERT_EQ(5LL, searchStats.numDocsReturned);
+}
+
 }  // namespace
 }  // namespace mongo
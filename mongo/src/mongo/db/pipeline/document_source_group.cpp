@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <numeric>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -38,6 +40,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -66,113 +69,87 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         invariant(initializationResult.isEOF());
     }
 
-    for (auto&& accum : _currentAccumulators) {
-        accum->reset();  // Prep accumulators for a new group.
-    }
-
-    if (_spilled) {
-        return getNextSpilled();
-    } else if (_streaming) {
+    if (_streaming) {
         return getNextStreaming();
     } else {
         return getNextStandard();
     }
 }
 
-DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
-    // We aren't streaming, and we have spilled to disk.
-    if (!_sorterIterator)
-        return GetNextResult::makeEOF();
-
-    _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
-    while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
-        // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
-        // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
-
-        if (!_sorterIterator->more()) {
-            dispose();
-            break;
+DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
+    // Not streaming. Return the groups in memory, then those of each partition spilled to disk.
+    while (groupsIterator == _groups->end()) {
+        if (!loadNextSpilledPartition()) {
+            return GetNextResult::makeEOF();
         }
-
-        _firstPartOfNextGroup = _sorterIterator->next();
     }
 
-    return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
-}
-
-DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
-    // Not spilled, and not streaming.
-    if (_groups->empty())
-        return GetNextResult::makeEOF();
-
     Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
 
-    if (++groupsIterator == _groups->end())
+    if (++groupsIterator == _groups->end() && _spilledPartitions.empty())
         dispose();
 
     return std::move(out);
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
-    // Streaming optimization is active.
-    if (!_firstDocOfNextGroup) {
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
+    // Streaming optimization is active. The documents of each group arrive one after another, so
+    // a group is complete as soon as a document of another group, or EOF, follows it.
+    while (true) {
+        if (!_firstDocOfNextGroup) {
+            auto nextInput = pSource->getNext();
+            if (nextInput.isPaused()) {
+                // The current group, if any, is picked up again when we are next called.
+                return nextInput;
+            }
+            if (nextInput.isEOF()) {
+                if (!_groupInProgress) {
+                    return nextInput;
+                }
+                return releaseCurrentGroup();
+            }
+            _firstDocOfNextGroup = nextInput.releaseDocument();
+        }
+
+        Value id = computeId(*_firstDocOfNextGroup);
+        if (_groupInProgress) {
+            if (!pExpCtx->getValueComparator().evaluate(_currentId == id)) {
+                // Leave '_firstDocOfNextGroup' set for the next time getNext() is called.
+                return releaseCurrentGroup();
+            }
+        } else {
+            _currentId = std::move(id);
+            _groupInProgress = true;
         }
-        _firstDocOfNextGroup = nextInput.releaseDocument();
-    }
 
-    Value id;
-    do {
-        // Add to the current accumulator(s).
         for (size_t i = 0; i < _currentAccumulators.size(); i++) {
             _currentAccumulators[i]->process(
                 _accumulatedFields[i].expression->evaluate(*_firstDocOfNextGroup), _doingMerge);
         }
+        _firstDocOfNextGroup = boost::none;
+    }
+}
 
-        // Retrieve the next document.
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
-        }
-
-        _firstDocOfNextGroup = nextInput.releaseDocument();
-
-
-        // Compute the id. If it does not match _currentId, we will exit the loop, leaving
-        // _firstDocOfNextGroup set for the next time getNext() is called.
-        id = computeId(*_firstDocOfNextGroup);
-    } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
-
+Document DocumentSourceGroup::releaseCurrentGroup() {
     Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
-    _currentId = std::move(id);
-
-    return std::move(out);
+    for (auto&& accum : _currentAccumulators) {
+        accum->reset();  // Prep accumulators for a new group.
+    }
+    _groupInProgress = false;
+    return out;
 }
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-    _sorterIterator.reset();
+    _partitionWriters.clear();
+    _spilledPartitions.clear();
 
     // Make us look done.
     groupsIterator = _groups->end();
 
     _firstDocOfNextGroup = boost::none;
+    _groupInProgress = false;
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
@@ -265,7 +242,6 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _streaming(false),
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
-      _spilled(false),
       _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
@@ -359,32 +335,6 @@ namespace {
 
 using GroupsMap = DocumentSourceGroup::GroupsMap;
 
-class SorterComparator {
-public:
-    typedef pair<Value, Value> Data;
-
-    SorterComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
-
-    int operator()(const Data& lhs, const Data& rhs) const {
-        return _valueComparator.compare(lhs.first, rhs.first);
-    }
-
-private:
-    ValueComparator _valueComparator;
-};
-
-class SpillSTLComparator {
-public:
-    SpillSTLComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
-
-    bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-        return _valueComparator.evaluate(lhs->first < rhs->first);
-    }
-
-private:
-    ValueComparator _valueComparator;
-};
-
 bool containsOnlyFieldPathsAndConstants(ExpressionObject* expressionObj) {
     for (auto&& it : expressionObj->getChildExpressions()) {
         const intrusive_ptr<Expression>& childExp = it.second;
@@ -421,31 +371,11 @@ void getFieldPathMap(ExpressionObject* expressionObj,
 
         if (expObj) {
             getFieldPathMap(expObj, newPrefix, fields);
-        } else if (expPath) {
+        } else if (expPath && expPath->getFieldPath().getPathLength() > 1) {
             (*fields)[expPath->getFieldPath().tail().fullPath()] = newPrefix;
         }
     }
 }
-
-void getFieldPathListForSpilled(ExpressionObject* expressionObj,
-                                std::string prefix,
-                                std::vector<std::string>* fields) {
-    // Given an expression, attempt to compute a vector of strings, each representing the path
-    // through the object to a leaf. For example, for the expression represented by
-    // {x: 2, y: {z: "$a.b"}}, the output would be ["x", "y.z"].
-    for (auto&& it : expressionObj->getChildExpressions()) {
-        intrusive_ptr<Expression> childExp = it.second;
-        ExpressionObject* expObj = dynamic_cast<ExpressionObject*>(childExp.get());
-
-        std::string newPrefix = prefix.empty() ? it.first : prefix + "." + it.first;
-
-        if (expObj) {
-            getFieldPathListForSpilled(expObj, newPrefix, fields);
-        } else {
-            fields->push_back(newPrefix);
-        }
-    }
-}
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
@@ -457,39 +387,42 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         _streaming = true;
         _inputSort = *inputSort;
 
-        // Set up accumulators.
+        // Set up accumulators. The documents are read as the groups are returned.
         _currentAccumulators.reserve(numAccumulators);
         for (auto&& accumulatedField : _accumulatedFields) {
             _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
         }
 
-        // We only need to load the first document.
-        auto firstInput = pSource->getNext();
-        if (!firstInput.isAdvanced()) {
-            // Leave '_firstDocOfNextGroup' uninitialized and return.
-            return firstInput;
-        }
-        _firstDocOfNextGroup = firstInput.releaseDocument();
-
-        // Compute the _id value.
-        _currentId = computeId(*_firstDocOfNextGroup);
         _initialized = true;
         return DocumentSource::GetNextResult::makeEOF();
     }
 
 
+    const bool batched = internalDocumentSourceGroupEnableBatchedExecution.load() &&
+        prepareBatchedExecution();
+    const size_t batchSize = std::max(internalDocumentSourceGroupBatchSize.load(), 1);
+    // The memory limit is only checked between batches, so a batch is also cut short once its
+    // documents take up as much memory as a spill frees, which bounds how far it can overshoot.
+    const size_t maxBatchBytes = std::max<size_t>(_maxMemoryUsageBytes / kNumSpillPartitions, 1);
+    vector<Document> batch;
+    size_t batchBytes = 0;
+
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
+        if (batched) {
+            batch.push_back(input.releaseDocument());
+            batchBytes += batch.back().getApproximateSize();
+            if (batch.size() >= batchSize || batchBytes >= maxBatchBytes) {
+                processBatch(batch);
+                batch.clear();
+                batchBytes = 0;
+            }
+            continue;
         }
 
+        spillIfOverMemoryLimit();
+
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
         auto rootDocument = input.releaseDocument();
@@ -529,16 +462,22 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
 
         if (kDebugBuild && !storageGlobalParams.readOnly) {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
+            if (!inserted &&                            // is a dup
+                !pExpCtx->inMongos &&                   // can't spill to disk in mongos
+                !_allowDiskUse &&                       // don't change behavior when testing
+                _spillStats.spilledPartitions < 20) {  // external sort; keep the suites fast
 
-                _sortedFiles.push_back(spill());
+                // Spill only the largest partition.
+                spill(_memoryUsageBytes - 1);
             }
         }
     }
 
+    // A partial batch must be consumed before pausing, as 'batch' does not outlive this call.
+    if (!batch.empty()) {
+        processBatch(batch);
+    }
+
     switch (input.getStatus()) {
         case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
             MONGO_UNREACHABLE;  // We consumed all advances above.
@@ -547,31 +486,10 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             return input;  // Propagate pause.
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
-            // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
-                _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
-
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
-
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (auto&& accumulatedField : _accumulatedFields) {
-                    _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
-                }
-
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
-            }
+            // Do any final steps necessary to prepare to output results. The groups of
+            // partitions that never spilled are returned first, straight from memory.
+            finishSpilling();
+            groupsIterator = _groups->begin();
 
             // This must happen last so that, unless control gets here, we will re-enter
             // initialization after getting a GetNextResult::ResultState::kPauseExecution.
@@ -582,53 +500,296 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
-        ptrs.push_back(&*it);
-    }
+size_t DocumentSourceGroup::partitionOf(const Value& id) const {
+    // Mix the depth into the hash so that each depth partitions independently.
+    uint64_t hash = pExpCtx->getValueComparator().hash(id) + _spillDepth * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash % kNumSpillPartitions;
+}
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+size_t DocumentSourceGroup::groupMemoryUsage(const Value& id, const Accumulators& accums) const {
+    size_t memoryUsageBytes = id.getApproximateSize();
+    for (auto&& accum : accums) {
+        memoryUsageBytes += accum->memUsageForSorter();
+    }
+    return memoryUsageBytes;
+}
 
-    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
+void DocumentSourceGroup::writeGroup(SortedFileWriter<Value, Value>* writer,
+                                     const Value& id,
+                                     const Accumulators& accums) {
+    Value partials;
+    switch (accums.size()) {
+        case 0:  // no values, essentially a distinct
             break;
 
         case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
-            }
+            partials = accums[0]->getValue(/*toBeMerged=*/true);
             break;
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
-                }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> values;
+            values.reserve(accums.size());
+            for (auto&& accum : accums) {
+                values.push_back(accum->getValue(/*toBeMerged=*/true));
             }
+            partials = Value(std::move(values));
             break;
+        }
     }
 
-    _groups->clear();
+    _spillStats.spilledBytes += id.getApproximateSize() + partials.getApproximateSize();
+    writer->addAlreadySorted(id, partials);
+}
+
+void DocumentSourceGroup::mergePartialGroup(const Value& id, const Value& partials) {
+    const size_t numAccumulators = _accumulatedFields.size();
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+    const size_t oldSize = _groups->size();
+    Accumulators& group = (*_groups)[id];
+    if (_groups->size() != oldSize) {
+        _memoryUsageBytes += id.getApproximateSize();
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+            _memoryUsageBytes += group.back()->memUsageForSorter();
+        }
+    }
+
+    for (size_t i = 0; i < numAccumulators; i++) {  // mirrors switch in writeGroup()
+        _memoryUsageBytes -= group[i]->memUsageForSorter();
+        group[i]->process(numAccumulators == 1 ? partials : partials.getArray()[i], true);
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
 }
 
-boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
-    if (true) {
-        // Until streaming $group correctly handles nullish values, the streaming behavior is
-        // disabled. See SERVER-23318.
-        return boost::none;
+void DocumentSourceGroup::spill(size_t targetMemoryUsageBytes) {
+    if (_partitionWriters.empty()) {
+        _partitionWriters.resize(kNumSpillPartitions);
+    }
+
+    // Find the partition of each group, in iteration order, and the memory used by each partition.
+    vector<size_t> groupPartitions;
+    groupPartitions.reserve(_groups->size());
+    vector<size_t> partitionBytes(kNumSpillPartitions, 0);
+    for (auto&& group : *_groups) {
+        const size_t partition = partitionOf(group.first);
+        groupPartitions.push_back(partition);
+        partitionBytes[partition] += groupMemoryUsage(group.first, group.second);
+    }
+
+    // Choose the largest partitions until the rest fit within the target.
+    vector<bool> spillPartition(kNumSpillPartitions, false);
+    size_t remainingBytes =
+        std::accumulate(partitionBytes.begin(), partitionBytes.end(), size_t(0));
+    while (remainingBytes > targetMemoryUsageBytes) {
+        auto largest = std::max_element(partitionBytes.begin(), partitionBytes.end());
+        if (*largest == 0) {
+            break;
+        }
+        spillPartition[largest - partitionBytes.begin()] = true;
+        remainingBytes -= *largest;
+        *largest = 0;
+        ++_spillStats.spilledPartitions;
+    }
+
+    // Erasing from an unordered map preserves the order of the remaining elements, so
+    // 'groupPartitions' stays aligned with the iteration.
+    size_t groupIndex = 0;
+    for (auto it = _groups->begin(); it != _groups->end(); ++groupIndex) {
+        const size_t partition = groupPartitions[groupIndex];
+        if (!spillPartition[partition]) {
+            ++it;
+            continue;
+        }
+
+        auto& writer = _partitionWriters[partition];
+        if (!writer) {
+            writer = stdx::make_unique<SortedFileWriter<Value, Value>>(
+                SortOptions().TempDir(pExpCtx->tempDir));
+        }
+        writeGroup(writer.get(), it->first, it->second);
+        it = _groups->erase(it);
+    }
+
+    _memoryUsageBytes = remainingBytes;
+}
+
+void DocumentSourceGroup::finishSpilling() {
+    if (_partitionWriters.empty()) {
+        return;
+    }
+
+    // Write out what remains in memory of the spilled partitions, so that each of them can be
+    // aggregated on its own when it is read back.
+    for (auto it = _groups->begin(); it != _groups->end();) {
+        auto& writer = _partitionWriters[partitionOf(it->first)];
+        if (!writer) {
+            ++it;
+            continue;
+        }
+        _memoryUsageBytes -= groupMemoryUsage(it->first, it->second);
+        writeGroup(writer.get(), it->first, it->second);
+        it = _groups->erase(it);
+    }
+
+    for (auto&& writer : _partitionWriters) {
+        if (writer) {
+            _spilledPartitions.push_back(
+                {_spillDepth + 1, shared_ptr<Sorter<Value, Value>::Iterator>(writer->done())});
+        }
+    }
+    _partitionWriters.clear();
+}
+
+bool DocumentSourceGroup::loadNextSpilledPartition() {
+    if (_spilledPartitions.empty()) {
+        return false;
+    }
+
+    SpilledPartition partition = std::move(_spilledPartitions.back());
+    _spilledPartitions.pop_back();
+    ++_spillStats.passes;
+
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    _memoryUsageBytes = 0;
+    _spillDepth = partition.depth;
+
+    // A partition can only have been spilled without 'allowDiskUse' in debug builds, where the
+    // memory limit was never exceeded to begin with.
+    const bool canSpillAgain = _allowDiskUse && _spillDepth < kMaxSpillDepth;
+    while (partition.data->more()) {
+        if (canSpillAgain) {
+            spillIfOverMemoryLimit();
+        } else if (_allowDiskUse) {
+            uassert(50781,
+                    str::stream() << "Exceeded memory limit for $group, even after splitting a "
+                                     "partition spilled to disk "
+                                  << kMaxSpillDepth
+                                  << " times.",
+                    _memoryUsageBytes <= _maxMemoryUsageBytes);
+        }
+        auto data = partition.data->next();
+        mergePartialGroup(data.first, data.second);
+    }
+
+    finishSpilling();
+    groupsIterator = _groups->begin();
+    return true;
+}
+
+void DocumentSourceGroup::spillIfOverMemoryLimit() {
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _allowDiskUse);
+        // Free about one partition's worth of memory beyond the limit.
+        spill(_maxMemoryUsageBytes - _maxMemoryUsageBytes / kNumSpillPartitions);
+    }
+}
+
+bool DocumentSourceGroup::prepareBatchedExecution() {
+    if (_doingMerge || _idExpressions.size() != 1) {
+        return false;
+    }
+
+    _batchColumns.clear();
+    _batchAccumulatorColumns.clear();
+
+    // Returns the column that 'expression' reads, -1 if it is a constant, or boost::none if the
+    // expression cannot be evaluated as a column.
+    auto columnFor = [this](const intrusive_ptr<Expression>& expression) -> boost::optional<int> {
+        if (dynamic_cast<ExpressionConstant*>(expression.get())) {
+            return -1;
+        }
+        auto fieldPathExpr = dynamic_cast<ExpressionFieldPath*>(expression.get());
+        if (!fieldPathExpr) {
+            return boost::none;
+        }
+        const auto& fullPath = fieldPathExpr->getFieldPath().fullPath();
+        for (size_t i = 0; i < _batchColumns.size(); ++i) {
+            if (_batchColumns[i]->getFieldPath().fullPath() == fullPath) {
+                return static_cast<int>(i);
+            }
+        }
+        _batchColumns.push_back(fieldPathExpr);
+        return static_cast<int>(_batchColumns.size() - 1);
+    };
+
+    auto idColumn = columnFor(_idExpressions[0]);
+    if (!idColumn) {
+        return false;
+    }
+    _batchIdColumn = *idColumn;
+
+    for (auto&& accumulatedField : _accumulatedFields) {
+        auto column = columnFor(accumulatedField.expression);
+        if (!column) {
+            return false;
+        }
+        _batchAccumulatorColumns.push_back(*column);
     }
+    return true;
+}
+
+void DocumentSourceGroup::processBatch(const vector<Document>& batch) {
+    spillIfOverMemoryLimit();
+
+    const size_t numAccumulators = _accumulatedFields.size();
+    const size_t numDocs = batch.size();
 
+    vector<vector<Value>> columns(_batchColumns.size());
+    for (size_t i = 0; i < _batchColumns.size(); ++i) {
+        columns[i].reserve(numDocs);
+        for (auto&& doc : batch) {
+            columns[i].push_back(_batchColumns[i]->evaluate(doc));
+        }
+    }
+
+    // Find or create the group of each document, exactly as computeId() would key it.
+    const Value constantId = _batchIdColumn < 0 ? _idExpressions[0]->evaluate(Document()) : Value();
+    vector<Accumulators*> docGroups;
+    docGroups.reserve(numDocs);
+    for (size_t i = 0; i < numDocs; ++i) {
+        Value id = _batchIdColumn < 0 ? constantId : columns[_batchIdColumn][i];
+        if (id.missing()) {
+            id = Value(BSONNULL);
+        }
+
+        const size_t oldSize = _groups->size();
+        Accumulators& group = (*_groups)[id];
+        if (_groups->size() != oldSize) {
+            _memoryUsageBytes += id.getApproximateSize();
+            group.reserve(numAccumulators);
+            for (auto&& accumulatedField : _accumulatedFields) {
+                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+                _memoryUsageBytes += group.back()->memUsageForSorter();
+            }
+        }
+        docGroups.push_back(&group);
+    }
+
+    // Each accumulator sees the documents of its group in input order, as in the row-at-a-time
+    // path, so results are the same even for order-sensitive accumulators such as $first.
+    for (size_t j = 0; j < numAccumulators; ++j) {
+        const int column = _batchAccumulatorColumns[j];
+        const Value constantArg =
+            column < 0 ? _accumulatedFields[j].expression->evaluate(Document()) : Value();
+        for (size_t i = 0; i < numDocs; ++i) {
+            Accumulator* accumulator = (*docGroups[i])[j].get();
+            _memoryUsageBytes -= accumulator->memUsageForSorter();
+            accumulator->process(column < 0 ? constantArg : columns[column][i], _doingMerge);
+            _memoryUsageBytes += accumulator->memUsageForSorter();
+        }
+    }
+}
+
+boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
     if (!pSource) {
         // Sometimes when performing an explain, or using $group as the merge point, 'pSource' will
         // not be set.
@@ -673,6 +834,13 @@ boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
         return BSONObj();
     }
 
+    if (!pSource->outputSortsKeepGroupsTogether() || pExpCtx->getCollator()) {
+        // Arrays and missing values could split a group across the input, as an array sorts by
+        // one of its elements and a missing value sorts as null. Strings which are equal under
+        // our collation need not be adjacent in an input sorted without it.
+        return boost::none;
+    }
+
     for (auto&& obj : sorts) {
         // Note that a sort order of, e.g., {a: 1, b: 1, c: 1} allows us to do a non-blocking group
         // for every permutation of group by (a, b, c), since we are guaranteed that documents with
@@ -691,31 +859,27 @@ boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
 BSONObjSet DocumentSourceGroup::getOutputSorts() {
     if (!_initialized) {
         initialize();  // Note this might not finish initializing, but that's OK. We just want to
-                       // do some initialization to try to determine if we are streaming or spilled.
+                       // do some initialization to try to determine if we are streaming.
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // Spilled groups are partitioned by hash, so only a streaming $group has a known output order.
+    if (!_streaming) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
     BSONObjBuilder sortOrder;
 
     if (_idFieldNames.empty()) {
-        if (_spilled) {
-            sortOrder.append("_id", 1);
-        } else {
-            // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
-            // get the sort order out of it.
-            if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
-                FieldPath _idSort = obj->getFieldPath();
-
-                sortOrder.append(
-                    "_id",
-                    _inputSort.getIntField(_idSort.getFieldName(_idSort.getPathLength() - 1)));
-            }
+        // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
+        // get the sort order out of it.
+        auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get());
+        if (obj && obj->getFieldPath().getPathLength() > 1) {
+            FieldPath _idSort = obj->getFieldPath();
+
+            sortOrder.append("_id", _inputSort.getIntField(_idSort.tail().fullPath()));
         }
-    } else if (_streaming) {
+    } else {
         // At this point, we know that _streaming is true, so _id must have only contained
         // ExpressionObjects, ExpressionConstants or ExpressionFieldPaths. We now process each
         // '_idExpression'.
@@ -730,9 +894,11 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                 // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
                 getFieldPathMap(obj, "_id." + _idFieldNames[i], &fieldMap);
             } else if (auto fieldPath = dynamic_cast<ExpressionFieldPath*>(exp.get())) {
+                if (fieldPath->getFieldPath().getPathLength() == 1) {
+                    continue;  // A variable such as $$REMOVE, which is constant.
+                }
                 FieldPath _idSort = fieldPath->getFieldPath();
-                fieldMap[_idSort.getFieldName(_idSort.getPathLength() - 1)] =
-                    "_id." + _idFieldNames[i];
+                fieldMap[_idSort.tail().fullPath()] = "_id." + _idFieldNames[i];
             }
         }
 
@@ -749,21 +915,6 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
 
             sortOrder.append(itr->second, _inputSort.getIntField(sortString));
         }
-    } else {
-        // We are blocking and have spilled to disk.
-        std::vector<std::string> outputSort;
-        for (size_t i = 0; i < _idFieldNames.size(); i++) {
-            intrusive_ptr<Expression> exp = _idExpressions[i];
-            if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
-                // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
-                getFieldPathListForSpilled(obj, "_id." + _idFieldNames[i], &outputSort);
-            } else {
-                outputSort.push_back("_id." + _idFieldNames[i]);
-            }
-        }
-        for (auto&& field : outputSort) {
-            sortOrder.append(field, 1);
-        }
     }
 
     return allPrefixes(sortOrder.obj());
@@ -45,6 +45,29 @@ public:
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    // The number of hash partitions that groups are divided into when spilling to disk.
+    static const size_t kNumSpillPartitions = 16;
+
+    // A spilled partition that still does not fit in memory when it is read back is split into
+    // further partitions, up to this depth. Beyond it, the $group fails with an exceeded memory
+    // limit error.
+    static const size_t kMaxSpillDepth = 4;
+
+    /**
+     * Statistics about spilling to disk, reported in the slow query log and the profiler. Explain
+     * does not run the pipeline, so it does not report them.
+     */
+    struct SpillStats {
+        // The approximate number of bytes of partial groups written to disk.
+        long long spilledBytes = 0;
+
+        // The number of times a partition of the groups was written to disk.
+        long long spilledPartitions = 0;
+
+        // The number of times a spilled partition was read back and aggregated.
+        long long passes = 0;
+    };
+
     // Virtuals from DocumentSource.
     boost::intrusive_ptr<DocumentSource> optimize() final;
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
@@ -98,6 +121,10 @@ public:
         return _streaming;
     }
 
+    const SpillStats& getSpillStats() const {
+        return _spillStats;
+    }
+
     // Virtuals for SplittableDocumentSource.
     boost::intrusive_ptr<DocumentSource> getShardSource() final;
     std::list<boost::intrusive_ptr<DocumentSource>> getMergeSources() final;
@@ -110,14 +137,18 @@ private:
                                  size_t maxMemoryUsageBytes = kDefaultMaxMemoryUsageBytes);
 
     /**
-     * getNext() dispatches to one of these three depending on what type of $group it is. All three
-     * of these methods expect '_currentAccumulators' to have been reset before being called, and
-     * also expect initialize() to have been called already.
+     * getNext() dispatches to one of these two depending on what type of $group it is. Both of
+     * these methods expect initialize() to have been called already.
      */
     GetNextResult getNextStreaming();
-    GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Returns the document for the group a streaming $group has just finished, and resets
+     * '_currentAccumulators' for the next group.
+     */
+    Document releaseCurrentGroup();
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -126,9 +157,9 @@ private:
 
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
-     * initialize() requests the first document from the previous source, and uses it to prepare the
-     * accumulators. In an unsorted $group, initialize() exhausts the previous source before
-     * returning. The '_initialized' boolean indicates that initialize() has finished.
+     * initialize() only prepares the accumulators. In an unsorted $group, initialize() exhausts the
+     * previous source before returning. The '_initialized' boolean indicates that initialize() has
+     * finished.
      *
      * This method may not be able to finish initialization in a single call if 'pSource' returns a
      * DocumentSource::GetNextResult::kPauseExecution, so it returns the last GetNextResult
@@ -137,11 +168,73 @@ private:
     GetNextResult initialize();
 
     /**
-     * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
-     * does not exhaust the previous stage before returning, and thus does not maintain as large a
-     * store of documents at any one time, only an unsorted group can spill to disk.
+     * Returns the spill partition of the group key 'id' at the current '_spillDepth'. Each depth
+     * hashes differently, so that a partition which is read back and still does not fit in memory
+     * is split across new partitions.
+     */
+    size_t partitionOf(const Value& id) const;
+
+    /**
+     * Writes the groups of the largest partitions to disk, until the memory used by the remaining
+     * groups is at most 'targetMemoryUsageBytes'. Groups of other partitions stay in memory. A
+     * partition that has been written to disk keeps aggregating in memory, and is written again if
+     * it is chosen by a later spill. Note: Since a sorted $group does not exhaust the previous
+     * stage before returning, and thus does not maintain as large a store of documents at any one
+     * time, only an unsorted group can spill to disk.
+     */
+    void spill(size_t targetMemoryUsageBytes);
+
+    /**
+     * Called once all input at the current '_spillDepth' has been aggregated. Writes out the
+     * groups of partitions that are on disk and queues those partitions to be read back, leaving
+     * only the groups of partitions that never spilled in memory.
+     */
+    void finishSpilling();
+
+    /**
+     * Reads the next queued partition back from disk into '_groups', merging its partial
+     * aggregates, and spilling again at the next depth if it does not fit in memory. Returns false
+     * if there are no queued partitions.
+     */
+    bool loadNextSpilledPartition();
+
+    /**
+     * Writes the partial aggregates of the group 'id' to 'writer'.
+     */
+    void writeGroup(SortedFileWriter<Value, Value>* writer,
+                    const Value& id,
+                    const Accumulators& accums);
+
+    /**
+     * Merges partial aggregates read back from disk into the group 'id'.
+     */
+    void mergePartialGroup(const Value& id, const Value& partials);
+
+    /**
+     * Returns the approximate memory used by the group 'id' with accumulators 'accums'.
+     */
+    size_t groupMemoryUsage(const Value& id, const Accumulators& accums) const;
+
+    /**
+     * Spills the groups map to disk if it has grown beyond '_maxMemoryUsageBytes'. Throws if
+     * spilling is not allowed.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    void spillIfOverMemoryLimit();
+
+    /**
+     * Returns true if the input of this $group can be consumed in batches, which requires the
+     * group key and the argument of each accumulator to be either a field path or a constant. If
+     * so, populates the '_batch*' members that describe the columns of each batch.
+     */
+    bool prepareBatchedExecution();
+
+    /**
+     * Adds the documents in 'batch' to '_groups' column by column: each distinct field path is
+     * evaluated once per document, and then each accumulator consumes its column in a single pass.
+     * The memory limit is checked once per batch rather than once per document, so batches are
+     * bounded by bytes as well as by count.
+     */
+    void processBatch(const std::vector<Document>& batch);
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
@@ -164,6 +257,13 @@ private:
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
 
+    // Only used when consuming input in batches. '_batchColumns' holds each distinct field path
+    // referenced by the group key or by an accumulator. '_batchIdColumn' and
+    // '_batchAccumulatorColumns' index into it, where -1 stands for a constant expression.
+    std::vector<boost::intrusive_ptr<ExpressionFieldPath>> _batchColumns;
+    int _batchIdColumn = -1;
+    std::vector<int> _batchAccumulatorColumns;
+
     BSONObj _inputSort;
     bool _streaming;
     bool _initialized;
@@ -176,19 +276,30 @@ private:
     // definition of equality.
     boost::optional<GroupsMap> _groups;
 
-    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
-    bool _spilled;
+    struct SpilledPartition {
+        // The spill depth that the groups in this partition are to be aggregated at.
+        size_t depth;
+        std::shared_ptr<Sorter<Value, Value>::Iterator> data;
+    };
+
+    // One writer per spill partition at the current '_spillDepth', which is null for partitions
+    // that have not been written to disk. Empty until the first spill at that depth.
+    std::vector<std::unique_ptr<SortedFileWriter<Value, Value>>> _partitionWriters;
+
+    // Spilled partitions waiting to be read back. The last one is processed first, so that the
+    // partitions split from it are finished before its siblings are opened.
+    std::vector<SpilledPartition> _spilledPartitions;
+
+    size_t _spillDepth = 0;
+    SpillStats _spillStats;
 
-    // Only used when '_spilled' is false.
     GroupsMap::iterator groupsIterator;
 
-    // Only used when '_spilled' is true.
-    std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     const bool _allowDiskUse;
-
-    std::pair<Value, Value> _firstPartOfNextGroup;
-    // Only used when '_sorted' is true.
+    // Only used when '_streaming' is true. The next input document, which has not been added to
+    // '_currentAccumulators' yet, and whether '_currentId' names a group that has been started.
     boost::optional<Document> _firstDocOfNextGroup;
+    bool _groupInProgress = false;
 };
 
 }  // namespace mongo
@@ -47,12 +47,14 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -189,6 +191,177 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldAggregateEachSpilledPartitionSeparately) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 5000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement sumStatement{"total",
+                                       ExpressionFieldPath::parse(expCtx, "$x", vps),
+                                       AccumulationStatement::getFactory("$sum")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$_id", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {sumStatement}, maxMemoryUsageBytes);
+
+    // Each key appears once in each of three passes over the key space, so every key has partial
+    // sums both in memory and on disk.
+    const int numKeys = 500;
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int pass = 0; pass < 3; ++pass) {
+        for (int key = 0; key < numKeys; ++key) {
+            inputs.push_back(Document{{"_id", key}, {"x", pass + 1}});
+        }
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    map<int, int> totals;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_TRUE(totals.emplace(doc["_id"].coerceToInt(), doc["total"].coerceToInt()).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    ASSERT_EQ(totals.size(), static_cast<size_t>(numKeys));
+    for (auto&& total : totals) {
+        ASSERT_EQ(total.second, 6);
+    }
+
+    ASSERT_GT(group->getSpillStats().spilledPartitions, 0);
+    ASSERT_GT(group->getSpillStats().spilledBytes, 0);
+    ASSERT_GT(group->getSpillStats().passes, 0);
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldErrorIfSpilledPartitionNeverFitsInMemory) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$_id", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+    // Every document has the same key, so re-partitioning never splits the group up, and each
+    // pass over the spilled partition spills it again.
+    string largeStr(maxMemoryUsageBytes * 3 / 5, 'x');
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 10; ++i) {
+        inputs.push_back(Document{{"_id", 0}, {"largeStr", largeStr}});
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    ASSERT_THROWS_CODE(group->getNext(), AssertionException, 50781);
+}
+
+TEST_F(DocumentSourceGroupTest, BatchedExecutionShouldMatchRowAtATimeResults) {
+    const bool oldEnableBatchedExecution =
+        internalDocumentSourceGroupEnableBatchedExecution.load();
+    const int oldBatchSize = internalDocumentSourceGroupBatchSize.load();
+    ON_BLOCK_EXIT([oldEnableBatchedExecution, oldBatchSize] {
+        internalDocumentSourceGroupEnableBatchedExecution.store(oldEnableBatchedExecution);
+        internalDocumentSourceGroupBatchSize.store(oldBatchSize);
+    });
+    internalDocumentSourceGroupEnableBatchedExecution.store(true);
+    internalDocumentSourceGroupBatchSize.store(2);
+
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow the debug-build spilling of the row-at-a-time path.
+
+    auto group = DocumentSourceGroup::createFromBson(
+        fromjson("{$group: {_id: '$k', total: {$sum: '$x'}, mean: {$avg: '$x'}, "
+                 "first: {$first: '$x'}, largest: {$max: '$y'}, count: {$sum: 1}}}")
+            .firstElement(),
+        expCtx);
+    auto mock =
+        DocumentSourceMock::create({Document{{"k", 1}, {"x", 1}, {"y", 5}},
+                                    Document{{"k", 2}, {"x", 2}, {"y", 1}},
+                                    Document{{"k", 1}, {"x", 3}, {"y", 2}},
+                                    DocumentSource::GetNextResult::makePauseExecution(),
+                                    Document{{"x", 4}},
+                                    Document{{"k", 1}, {"x", 5}, {"y", 9}}});
+    group->setSource(mock.get());
+
+    // The partial batch is consumed before pausing.
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    map<int, Document> results;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        results[doc["_id"].nullish() ? 0 : doc["_id"].coerceToInt()] = doc;
+    }
+    ASSERT_EQ(results.size(), 3UL);
+    ASSERT_DOCUMENT_EQ(results[1],
+                       (Document{{"_id", 1},
+                                 {"total", 9},
+                                 {"mean", 3.0},
+                                 {"first", 1},
+                                 {"largest", 9},
+                                 {"count", 3}}));
+    ASSERT_DOCUMENT_EQ(results[2],
+                       (Document{{"_id", 2},
+                                 {"total", 2},
+                                 {"mean", 2.0},
+                                 {"first", 2},
+                                 {"largest", 1},
+                                 {"count", 1}}));
+    ASSERT_DOCUMENT_EQ(results[0],
+                       (Document{{"_id", BSONNULL},
+                                 {"total", 4},
+                                 {"mean", 4.0},
+                                 {"first", 4},
+                                 {"largest", BSONNULL},
+                                 {"count", 1}}));
+}
+
+TEST_F(DocumentSourceGroupTest, BatchedExecutionShouldEnforceMemoryLimitWithinLargeBatches) {
+    const bool oldEnableBatchedExecution =
+        internalDocumentSourceGroupEnableBatchedExecution.load();
+    const int oldBatchSize = internalDocumentSourceGroupBatchSize.load();
+    ON_BLOCK_EXIT([oldEnableBatchedExecution, oldBatchSize] {
+        internalDocumentSourceGroupEnableBatchedExecution.store(oldEnableBatchedExecution);
+        internalDocumentSourceGroupBatchSize.store(oldBatchSize);
+    });
+    internalDocumentSourceGroupEnableBatchedExecution.store(true);
+    internalDocumentSourceGroupBatchSize.store(1000);
+
+    auto expCtx = getExpCtx();
+    const size_t maxMemoryUsageBytes = 1000;
+    expCtx->inMongos = true;  // Disallow external sort.
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$_id", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+    // All of the input fits in one batch by count, but not within the memory limit.
+    string largeStr(maxMemoryUsageBytes / 2, 'x');
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 10; ++i) {
+        inputs.push_back(Document{{"_id", i}, {"largeStr", largeStr}});
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -1005,6 +1178,63 @@ public:
     }
 };
 
+class StreamingAcrossPauses : public Base {
+public:
+    void run() {
+        auto source =
+            DocumentSourceMock::create({Document{{"a", 0}, {"x", 1}},
+                                        DocumentSource::GetNextResult::makePauseExecution(),
+                                        Document{{"a", 0}, {"x", 2}},
+                                        Document{{"a", 1}, {"x", 3}},
+                                        DocumentSource::GetNextResult::makePauseExecution(),
+                                        Document{{"a", 1}, {"x", 4}}});
+        source->sorts = {BSON("a" << 1)};
+
+        createGroup(fromjson("{_id: '$a', total: {$sum: '$x'}}"));
+        group()->setSource(source.get());
+
+        // A pause does not end the group in progress, and no document is added to it twice.
+        ASSERT_TRUE(group()->getNext().isPaused());
+        ASSERT_TRUE(group()->isStreaming());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.releaseDocument(), (Document{{"_id", 0}, {"total", 3}}));
+
+        ASSERT_TRUE(group()->getNext().isPaused());
+
+        // The last group is returned once the input is exhausted.
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.releaseDocument(), (Document{{"_id", 1}, {"total", 7}}));
+
+        assertEOF(group());
+    }
+};
+
+class NoOptimizationIfSortsSplitGroups : public Base {
+public:
+    void run() {
+        auto source = DocumentSourceMock::create({"{a: 1}", "{a: [1, 2]}", "{a: 1}"});
+        source->sorts = {BSON("a" << 1)};
+        source->sortsKeepGroupsTogether = false;
+
+        // We pretend to be in the router so that we don't spill to disk, because this produces
+        // inconsistent output on debug vs. non-debug builds.
+        const bool inMongos = true;
+        const bool inShard = false;
+
+        createGroup(fromjson("{_id: '$a', count: {$sum: 1}}"), inShard, inMongos);
+        group()->setSource(source.get());
+
+        group()->getNext();
+        ASSERT_FALSE(group()->isStreaming());
+
+        BSONObjSet outputSort = group()->getOutputSorts();
+        ASSERT_EQUALS(outputSort.size(), 0U);
+    }
+};
+
 class NoOptimizationIfMissingDoubleSort : public Base {
 public:
     void run() {
@@ -1157,8 +1387,6 @@ public:
         add<Dependencies>();
         add<StringConstantIdAndAccumulatorExpressions>();
         add<ArrayConstantAccumulatorExpression>();
-#if 0
-        // Disabled tests until SERVER-23318 is implemented.
         add<StreamingOptimization>();
         add<StreamingWithMultipleIdFields>();
         add<NoOptimizationIfMissingDoubleSort>();
@@ -1170,7 +1398,8 @@ public:
         add<StreamingWithRootSubfield>();
         add<StreamingWithConstantAndFieldPath>();
         add<StreamingWithFieldRepeated>();
-#endif
+        add<StreamingAcrossPauses>();
+        add<NoOptimizationIfSortsSplitGroups>();
     }
 };
 
@@ -66,6 +66,10 @@ public:
                        : SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
+    bool outputSortsKeepGroupsTogether() const final {
+        return pSource && pSource->outputSortsKeepGroupsTogether();
+    }
+
     /**
      * Attempts to combine with a subsequent $limit stage, setting 'limit' appropriately.
      */
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -74,7 +75,8 @@ DocumentSourceLookUp::DocumentSourceLookUp(NamespaceString fromNs,
       _fromNs(std::move(fromNs)),
       _as(std::move(as)),
       _variables(pExpCtx->variables),
-      _variablesParseState(pExpCtx->variablesParseState.copyWith(_variables.useIdGenerator())) {
+      _variablesParseState(pExpCtx->variablesParseState.copyWith(_variables.useIdGenerator())),
+      _hashTable(pExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>()) {
     const auto& resolvedNamespace = pExpCtx->getResolvedNamespace(_fromNs);
     _resolvedNs = resolvedNamespace.ns;
     _resolvedPipeline = resolvedNamespace.pipeline;
@@ -115,6 +117,10 @@ DocumentSourceLookUp::DocumentSourceLookUp(NamespaceString fromNs,
 
     _userPipeline = std::move(pipeline);
 
+    // Pipeline syntax $lookup may be correlated through 'let' variables, so the foreign side cannot
+    // be hashed independently of the local document.
+    _joinStrategy = JoinStrategy::kNestedLoop;
+
     _cache.emplace(internalDocumentSourceLookupCacheSizeBytes.load());
 
     for (auto&& varElem : letVariables) {
@@ -201,8 +207,155 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Returns true if an equality match on 'value' against the foreign field can be answered by
+ * looking 'value' up among the values found at that field. Null and undefined also match missing
+ * fields, arrays also match whole array values, and regular expressions are always joined with a
+ * sub-pipeline to keep their matching semantics in one place.
+ */
+bool isHashJoinableValue(const Value& value) {
+    switch (value.getType()) {
+        case BSONType::EOO:
+        case BSONType::jstNULL:
+        case BSONType::Undefined:
+        case BSONType::Array:
+        case BSONType::RegEx:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Returns true if the dotted path 'path' has a component which could be interpreted as an array
+ * index by the matcher. Such paths are not supported by the hash join strategy.
+ */
+bool hasPositionalPathComponent(const FieldPath& path) {
+    for (size_t i = 0; i < path.getPathLength(); ++i) {
+        const auto component = path.getFieldName(i);
+        if (std::all_of(component.begin(), component.end(), [](char c) { return isdigit(c); })) {
+            return true;
+        }
+    }
+    return false;
+}
+
 }  // namespace
 
+bool DocumentSourceLookUp::shouldUseHashJoin() {
+    if (_joinStrategy != JoinStrategy::kUndecided) {
+        return _joinStrategy == JoinStrategy::kHashJoin;
+    }
+
+    const auto maxMemoryBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    if (maxMemoryBytes <= 0 || hasPositionalPathComponent(*_foreignField)) {
+        _joinStrategy = JoinStrategy::kNestedLoop;
+        return false;
+    }
+
+    // Joining a handful of local documents is cheaper with indexed sub-pipeline lookups than with
+    // a scan of the whole foreign side, so only hash once the local input has proven to be large.
+    if (_numInputsNestedLoop < internalDocumentSourceLookupHashJoinInputThreshold.load()) {
+        ++_numInputsNestedLoop;
+        return false;
+    }
+
+    _joinStrategy = buildHashTable(static_cast<size_t>(maxMemoryBytes)) ? JoinStrategy::kHashJoin
+                                                                         : JoinStrategy::kNestedLoop;
+    return _joinStrategy == JoinStrategy::kHashJoin;
+}
+
+bool DocumentSourceLookUp::buildHashTable(size_t maxMemoryBytes) {
+    invariant(!wasConstructedWithPipelineSyntax());
+    invariant(_hashTable.empty());
+
+    // Replace the per-document placeholder $match with one which only applies the predicates we
+    // have absorbed on the 'as' field, so that the pipeline returns every joinable foreign document.
+    const auto placeholderMatch = _resolvedPipeline.back();
+    _resolvedPipeline.back() = BSON("$match" << _additionalFilter.value_or(BSONObj()));
+    ON_BLOCK_EXIT([&] { _resolvedPipeline.back() = placeholderMatch; });
+
+    auto pipeline = buildPipeline(Document());
+    while (auto result = pipeline->getNext()) {
+        pExpCtx->checkForInterrupt();
+
+        const size_t docIndex = _hashJoinForeignDocs.size();
+        _hashTableMemoryBytes += result->getApproximateSize();
+        document_path_support::visitAllValuesAtPath(
+            *result, *_foreignField, [&](const Value& nextValue) {
+                auto& bucket = _hashTable[nextValue];
+                // A foreign document may contain the same value more than once, but it must only
+                // be joined once.
+                if (bucket.empty() || bucket.back() != docIndex) {
+                    _hashTableMemoryBytes += nextValue.getApproximateSize() + sizeof(size_t);
+                    bucket.push_back(docIndex);
+                }
+            });
+        _hashJoinForeignDocs.push_back(std::move(*result));
+        ++_numForeignDocsMaterialized;
+
+        if (_hashTableMemoryBytes > maxMemoryBytes) {
+            clearHashTable();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+boost::optional<std::vector<Value>> DocumentSourceLookUp::probeHashTable(
+    const Document& input) const {
+    std::vector<size_t> matchingDocs;
+    bool hashable = true;
+    size_t numLocalValues = 0;
+    document_path_support::visitAllValuesAtPath(input, *_localField, [&](const Value& nextValue) {
+        ++numLocalValues;
+        if (!hashable || !isHashJoinableValue(nextValue)) {
+            hashable = false;
+            return;
+        }
+        auto it = _hashTable.find(nextValue);
+        if (it != _hashTable.end()) {
+            matchingDocs.insert(matchingDocs.end(), it->second.begin(), it->second.end());
+        }
+    });
+
+    // A missing local value is joined as null, which must also match missing foreign fields.
+    if (!hashable || numLocalValues == 0) {
+        return boost::none;
+    }
+
+    // An array of local values joins with the union of the matches for each value. Returning the
+    // matches in foreign pipeline order keeps the output independent of the local array order.
+    if (numLocalValues > 1) {
+        std::sort(matchingDocs.begin(), matchingDocs.end());
+        matchingDocs.erase(std::unique(matchingDocs.begin(), matchingDocs.end()),
+                           matchingDocs.end());
+    }
+
+    std::vector<Value> results;
+    results.reserve(matchingDocs.size());
+    int objsize = 0;
+    for (auto docIndex : matchingDocs) {
+        objsize += _hashJoinForeignDocs[docIndex].getApproximateSize();
+        uassert(4568,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching '"
+                              << _localField->fullPath()
+                              << "' of the input document exceeds maximum document size",
+                objsize <= BSONObjMaxInternalSize);
+        results.emplace_back(_hashJoinForeignDocs[docIndex]);
+    }
+    return results;
+}
+
+void DocumentSourceLookUp::clearHashTable() {
+    _hashTable.clear();
+    _hashJoinForeignDocs.clear();
+    _hashJoinForeignDocs.shrink_to_fit();
+    _hashTableMemoryBytes = 0;
+}
+
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     pExpCtx->checkForInterrupt();
 
@@ -221,6 +374,14 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
+    if (!wasConstructedWithPipelineSyntax() && shouldUseHashJoin()) {
+        if (auto results = probeHashTable(inputDoc)) {
+            MutableDocument output(std::move(inputDoc));
+            output.setNestedField(_as, Value(std::move(*results)));
+            return output.freeze();
+        }
+    }
+
     if (!wasConstructedWithPipelineSyntax()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
@@ -436,6 +597,8 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashJoinResults = boost::none;
+    clearHashTable();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -528,35 +691,46 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
+    while (!_nextValue) {
         auto nextInput = pSource->getNext();
         if (!nextInput.isAdvanced()) {
             return nextInput;
         }
 
         _input = nextInput.releaseDocument();
+        _hashJoinResults = boost::none;
 
-        if (!wasConstructedWithPipelineSyntax()) {
-            BSONObj filter = _additionalFilter.value_or(BSONObj());
-            auto matchStage =
-                makeMatchStageFromInput(*_input, *_localField, _foreignField->fullPath(), filter);
-            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-            _resolvedPipeline.back() = matchStage;
+        if (!wasConstructedWithPipelineSyntax() && shouldUseHashJoin()) {
+            _hashJoinResults = probeHashTable(*_input);
         }
 
         if (_pipeline) {
             _pipeline->dispose(pExpCtx->opCtx);
+            _pipeline.reset();
         }
 
-        _pipeline = buildPipeline(*_input);
+        if (_hashJoinResults) {
+            _hashJoinResultIndex = 0;
+        } else {
+            if (!wasConstructedWithPipelineSyntax()) {
+                BSONObj filter = _additionalFilter.value_or(BSONObj());
+                auto matchStage = makeMatchStageFromInput(
+                    *_input, *_localField, _foreignField->fullPath(), filter);
+                // We've already allocated space for the trailing $match stage in
+                // '_resolvedPipeline'.
+                _resolvedPipeline.back() = matchStage;
+            }
+
+            _pipeline = buildPipeline(*_input);
 
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+            // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+            // potentially be used by multiple OperationContexts, and the $lookup stage is part of
+            // an outer Pipeline that will propagate dispose() calls before being destroyed.
+            _pipeline.get_deleter().dismissDisposal();
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = getNextUnwindForeignResult();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -574,7 +748,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = getNextUnwindForeignResult();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -588,6 +762,16 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     return output.freeze();
 }
 
+boost::optional<Document> DocumentSourceLookUp::getNextUnwindForeignResult() {
+    if (_hashJoinResults) {
+        if (_hashJoinResultIndex == _hashJoinResults->size()) {
+            return boost::none;
+        }
+        return (*_hashJoinResults)[_hashJoinResultIndex++].getDocument();
+    }
+    return _pipeline->getNext();
+}
+
 void DocumentSourceLookUp::copyVariablesToExpCtx(const Variables& vars,
                                                  const VariablesParseState& vps,
                                                  ExpressionContext* expCtx) {
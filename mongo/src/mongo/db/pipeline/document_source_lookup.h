@@ -187,6 +187,27 @@ public:
         return buildPipeline(inputDoc);
     }
 
+    /**
+     * The strategy used to join local documents with the foreign collection. A localField/
+     * foreignField $lookup starts out as 'kUndecided' and joins with one sub-pipeline per local
+     * document until it either builds an in-memory hash table over the foreign side ('kHashJoin')
+     * or decides that it cannot ('kNestedLoop'). Pipeline syntax $lookup is always 'kNestedLoop'.
+     */
+    enum class JoinStrategy { kUndecided, kHashJoin, kNestedLoop };
+
+    JoinStrategy getJoinStrategy() const {
+        return _joinStrategy;
+    }
+
+    /**
+     * Returns the number of foreign documents read into memory to build the hash table, including
+     * those read by an attempt which gave up on hashing. Reported in the slow query log and the
+     * profiler, since explain does not run the join.
+     */
+    long long getNumForeignDocsMaterialized() const {
+        return _numForeignDocsMaterialized;
+    }
+
 protected:
     void doDispose() final;
 
@@ -286,6 +307,40 @@ private:
         _cache.emplace(maxCacheSizeBytes);
     }
 
+    /**
+     * Returns true if the next local document should be joined by probing the foreign hash table,
+     * building the table first if the input threshold has just been reached. Switches
+     * '_joinStrategy' to 'kNestedLoop' if the foreign side cannot be hashed within the memory
+     * budget given by 'internalDocumentSourceLookupHashJoinMaxMemoryBytes'.
+     */
+    bool shouldUseHashJoin();
+
+    /**
+     * Runs the foreign pipeline once, filtered only by '_additionalFilter', and indexes each
+     * returned document by every value found at '_foreignField'. Returns false, leaving the hash
+     * table empty, if the materialized documents would exceed 'maxMemoryBytes'.
+     */
+    bool buildHashTable(size_t maxMemoryBytes);
+
+    /**
+     * Returns the foreign documents joining with 'input', in the order they were produced by the
+     * foreign pipeline. Returns boost::none if 'input' has a local value whose equality semantics
+     * cannot be answered from the hash table (e.g. null, missing or array values), in which case the
+     * caller must fall back to a per-document sub-pipeline.
+     */
+    boost::optional<std::vector<Value>> probeHashTable(const Document& input) const;
+
+    /**
+     * Releases the memory held by the foreign hash table.
+     */
+    void clearHashTable();
+
+    /**
+     * Returns the next foreign document for the local document currently being unwound, drawing
+     * either from '_hashJoinResults' or from '_pipeline'.
+     */
+    boost::optional<Document> getNextUnwindForeignResult();
+
     NamespaceString _fromNs;
     NamespaceString _resolvedNs;
     FieldPath _as;
@@ -332,6 +387,20 @@ private:
     std::unique_ptr<Pipeline, Pipeline::Deleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // State for the hash join strategy. '_hashTable' maps each value found at '_foreignField' to
+    // the positions in '_hashJoinForeignDocs' of the foreign documents containing that value.
+    JoinStrategy _joinStrategy = JoinStrategy::kUndecided;
+    long long _numInputsNestedLoop = 0;
+    std::vector<Document> _hashJoinForeignDocs;
+    ValueUnorderedMap<std::vector<size_t>> _hashTable;
+    size_t _hashTableMemoryBytes = 0;
+    long long _numForeignDocsMaterialized = 0;
+
+    // When unwinding with the hash join strategy, holds the matches for '_input' in place of
+    // '_pipeline'.
+    boost::optional<std::vector<Value>> _hashJoinResults;
+    size_t _hashJoinResultIndex = 0;
 };
 
 }  // namespace mongo
@@ -47,6 +47,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -1127,5 +1128,196 @@ TEST_F(DocumentSourceLookUpTest, ShouldNotCacheIfCorrelatedStageIsAbsorbedIntoPl
     ASSERT_VALUE_EQ(Value(subPipeline->writeExplainOps(kExplain)), Value(BSONArray(expectedPipe)));
 }
 
+
+TEST_F(DocumentSourceLookUpTest, ShouldSwitchToHashJoinOnceInputThresholdIsReached) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    const int oldThreshold = internalDocumentSourceLookupHashJoinInputThreshold.load();
+    ON_BLOCK_EXIT(
+        [oldThreshold] { internalDocumentSourceLookupHashJoinInputThreshold.store(oldThreshold); });
+    internalDocumentSourceLookupHashJoinInputThreshold.store(1);
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "_id"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource =
+        DocumentSourceMock::create({Document{{"foreignId", 0}},
+                                    Document{{"foreignId", 1}},
+                                    Document{{"foreignId", vector<Value>{Value(1), Value(0)}}},
+                                    Document{{"foreignId", 2}},
+                                    Document{{"foreignId", BSONNULL}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}},
+                                                             Document{{"_id", 1}}};
+    lookup->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterface>(std::move(mockForeignContents)));
+
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kUndecided);
+
+    // The first input is joined with a sub-pipeline.
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 0}, {"foreignDocs", vector<Value>{Value(Document{{"_id", 0}})}}}));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kUndecided);
+
+    // The second input triggers the build of the hash table.
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 1}, {"foreignDocs", vector<Value>{Value(Document{{"_id", 1}})}}}));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+
+    // Array values join with each matching foreign document once, in foreign order.
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"foreignId", vector<Value>{Value(1), Value(0)}},
+                                 {"foreignDocs",
+                                  vector<Value>{Value(Document{{"_id", 0}}),
+                                                Value(Document{{"_id", 1}})}}}));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"foreignId", 2}, {"foreignDocs", vector<Value>{}}}));
+
+    // Null values cannot be answered from the hash table and fall back to a sub-pipeline.
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"foreignId", BSONNULL}, {"foreignDocs", vector<Value>{}}}));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_EQ(2LL, lookup->getNumForeignDocsMaterialized());
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldUseHashJoinWhileUnwinding) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    const int oldThreshold = internalDocumentSourceLookupHashJoinInputThreshold.load();
+    ON_BLOCK_EXIT(
+        [oldThreshold] { internalDocumentSourceLookupHashJoinInputThreshold.store(oldThreshold); });
+    internalDocumentSourceLookupHashJoinInputThreshold.store(0);
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "key"_sd},
+                                         {"as", "foreignDoc"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    const bool preserveNullAndEmptyArrays = true;
+    const boost::optional<std::string> includeArrayIndex = std::string("arrIndex");
+    lookup->setUnwindStage(DocumentSourceUnwind::create(
+        expCtx, "foreignDoc", preserveNullAndEmptyArrays, includeArrayIndex));
+
+    auto mockLocalSource =
+        DocumentSourceMock::create({Document{{"foreignId", 0}}, Document{{"foreignId", 1}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"key", 0}},
+        Document{{"_id", 1}, {"key", vector<Value>{Value(0), Value(0)}}}};
+    lookup->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterface>(std::move(mockForeignContents)));
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"foreignId", 0},
+                                 {"foreignDoc", Document{{"_id", 0}, {"key", 0}}},
+                                 {"arrIndex", 0LL}}));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 0},
+                  {"foreignDoc", Document{{"_id", 1}, {"key", vector<Value>{Value(0), Value(0)}}}},
+                  {"arrIndex", 1LL}}));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"foreignId", 1}, {"arrIndex", BSONNULL}}));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldFallBackToNestedLoopJoinIfForeignSideExceedsMemoryLimit) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    const int oldThreshold = internalDocumentSourceLookupHashJoinInputThreshold.load();
+    const int oldMaxMemoryBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    ON_BLOCK_EXIT([oldThreshold, oldMaxMemoryBytes] {
+        internalDocumentSourceLookupHashJoinInputThreshold.store(oldThreshold);
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(oldMaxMemoryBytes);
+    });
+    internalDocumentSourceLookupHashJoinInputThreshold.store(0);
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(1);
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "_id"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::create({Document{{"foreignId", 1}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}},
+                                                             Document{{"_id", 1}}};
+    lookup->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterface>(std::move(mockForeignContents)));
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 1}, {"foreignDocs", vector<Value>{Value(Document{{"_id", 1}})}}}));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kNestedLoop);
+    // The first foreign document already exceeds the memory limit.
+    ASSERT_EQ(1LL, lookup->getNumForeignDocsMaterialized());
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, PipelineSyntaxShouldAlwaysUseNestedLoopJoin) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "coll");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto docSource = DocumentSourceLookUp::createFromBson(
+        fromjson("{$lookup: {pipeline: [{$match: {x: 1}}], from: 'coll', as: 'as'}}")
+            .firstElement(),
+        expCtx);
+    auto lookupStage = static_cast<DocumentSourceLookUp*>(docSource.get());
+    ASSERT(lookupStage->getJoinStrategy() ==
+           DocumentSourceLookUp::JoinStrategy::kNestedLoop);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -48,6 +48,10 @@ public:
                        : SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
+    bool outputSortsKeepGroupsTogether() const final {
+        return pSource && pSource->outputSortsKeepGroupsTogether();
+    }
+
     const char* getSourceName() const override;
 
     StageConstraints constraints(Pipeline::SplitState pipeState) const override {
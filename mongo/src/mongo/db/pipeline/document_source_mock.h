@@ -64,6 +64,10 @@ public:
         return sorts;
     }
 
+    bool outputSortsKeepGroupsTogether() const override {
+        return sortsKeepGroupsTogether;
+    }
+
     static boost::intrusive_ptr<DocumentSourceMock> create();
 
     static boost::intrusive_ptr<DocumentSourceMock> create(Document doc);
@@ -97,6 +101,7 @@ public:
     bool isExpCtxInjected = false;
 
     BSONObjSet sorts;
+    bool sortsKeepGroupsTogether = true;
 
 protected:
     void doDispose() override;
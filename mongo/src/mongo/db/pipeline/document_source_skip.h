@@ -77,6 +77,10 @@ public:
                        : SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
+    bool outputSortsKeepGroupsTogether() const final {
+        return pSource && pSource->outputSortsKeepGroupsTogether();
+    }
+
     GetDepsReturn getDependencies(DepsTracker* deps) const final {
         return SEE_NEXT;  // This doesn't affect needed fields
     }
@@ -55,6 +55,9 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_graph_lookup.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_lookup.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
 #include "mongo/db/pipeline/document_source_sample.h"
@@ -933,7 +936,22 @@ void PipelineD::getPlanSummaryStats(const Pipeline* pPipeline, PlanSummaryStats*
     for (auto&& source : pPipeline->_sources) {
         if (dynamic_cast<DocumentSourceSort*>(source.get())) {
             hasSortStage = true;
-            break;
+        } else if (auto group = dynamic_cast<DocumentSourceGroup*>(source.get())) {
+            const auto& spillStats = group->getSpillStats();
+            statsOut->groupSpilledBytes += spillStats.spilledBytes;
+            statsOut->groupSpilledPartitions += spillStats.spilledPartitions;
+            statsOut->groupSpillPasses += spillStats.passes;
+        } else if (auto lookup = dynamic_cast<DocumentSourceLookUp*>(source.get())) {
+            if (lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin) {
+                ++statsOut->lookupHashJoins;
+            }
+            statsOut->lookupForeignDocsMaterialized += lookup->getNumForeignDocsMaterialized();
+        } else if (auto graphLookup = dynamic_cast<DocumentSourceGraphLookUp*>(source.get())) {
+            const auto& searchStats = graphLookup->getSearchStats();
+            statsOut->graphLookupQueries += searchStats.numQueries;
+            statsOut->graphLookupCacheHits += searchStats.numCacheHits;
+            statsOut->graphLookupDocsReturned += searchStats.numDocsReturned;
+            statsOut->graphLookupSpills += searchStats.numSpills;
         }
     }
 
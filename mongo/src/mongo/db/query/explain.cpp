@@ -202,6 +202,11 @@ void addStageSummaryStr(const PlanStage* stage, StringBuilder& sb) {
         const TextStats* spec = static_cast<const TextStats*>(specific);
         const KeyPattern keyPattern{spec->indexPrefix};
         sb << " " << keyPattern;
+    } else if (STAGE_COLLSCAN == stage->stageType()) {
+        const CollectionScanStats* spec = static_cast<const CollectionScanStats*>(specific);
+        if (spec->sharedScan) {
+            sb << " (shared)";
+        }
     }
 }
 
@@ -384,8 +389,18 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (spec->maxTs) {
             bob->append("maxTs", *(spec->maxTs));
         }
+        if (spec->sharedScan) {
+            bob->append("sharedScan", true);
+        }
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->docsTested);
+            if (spec->parallelism > 1) {
+                bob->append("parallelism", spec->parallelism);
+            }
+            if (spec->sharedScan) {
+                bob->append("joinedSharedScan", spec->joinedSharedScan);
+                bob->append("sharedScanWrapped", spec->sharedScanWrapped);
+            }
         }
     } else if (STAGE_COUNT == stats.stageType) {
         CountStats* spec = static_cast<CountStats*>(stats.specific.get());
@@ -466,6 +481,10 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->docsExamined);
             bob->appendNumber("alreadyHasObj", spec->alreadyHasObj);
+            if (spec->fetchBatches > 0) {
+                bob->appendNumber("fetchBatches", spec->fetchBatches);
+                bob->appendNumber("docsFetchedInBatches", spec->docsFetchedInBatches);
+            }
         }
     } else if (STAGE_GEO_NEAR_2D == stats.stageType || STAGE_GEO_NEAR_2DSPHERE == stats.stageType) {
         NearStats* spec = static_cast<NearStats*>(stats.specific.get());
@@ -40,6 +40,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -182,10 +183,10 @@ void generateBatch(int ntoreturn,
 
     BSONObj obj;
     while (!FindCommon::enoughForGetMore(ntoreturn, *numResults) &&
-           PlanExecutor::ADVANCED == (*state = exec->getNext(&obj, NULL))) {
+           PlanExecutor::ADVANCED == (*state = cursor->getNext(&obj))) {
         // If we can't fit this result inside the current batch, then we stash it for later.
         if (!FindCommon::haveSpaceForNext(obj, *numResults, bb->len())) {
-            exec->enqueue(obj);
+            cursor->stashNext(obj);
             break;
         }
 
@@ -240,6 +241,10 @@ Message getMore(OperationContext* opCtx,
 
     const NamespaceString nss(ns);
 
+    // A read-ahead of this cursor's next batch may still hold the cursor pinned. It takes the
+    // collection lock, so wait for it before taking any lock ourselves.
+    CursorPrefetcher::get(opCtx).waitForIdle(opCtx, cursorid);
+
     // Cursors come in one of two flavors:
     // - Cursors owned by the collection cursor manager, such as those generated via the find
     //   command. For these cursors, we hold the appropriate collection lock for the duration of the
@@ -81,6 +81,7 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/stdx/memory.h"
@@ -786,6 +787,12 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>>
 		//ƬģʽϸñǻͷڱƬݲӦڱƬɾ
         plannerOptions |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
+
+    // Shared scans depend on records being returned in RecordId order, which MMAPv1 does not do.
+    if (internalQueryExecEnableSharedCollectionScans.load() &&
+        !opCtx->getServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
+        plannerOptions |= QueryPlannerParams::SHARE_COLLECTION_SCANS;
+    }
     return getExecutor( //pickBestPlanѡȡŵplan  CanonicalQueryõıʽ,getExecutorõյPlanExecutor
         opCtx, collection, std::move(canonicalQuery), PlanExecutor::YIELD_AUTO, plannerOptions);
 }
@@ -33,12 +33,17 @@
 #include "mongo/db/query/plan_cache.h"
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include <math.h>
 #include <memory>
+#include <set>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/dbclientinterface.h"  // For QueryOption_foobar
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/collation/collator_interface.h"
@@ -305,6 +310,77 @@ void encodeGeoNearMatchExpression(const GeoNearMatchExpression* tree, StringBuil
     }
 }
 
+// The stage-specific statistics of a stats tree are not sized individually. Each stage that has
+// them is charged this many bytes instead.
+const size_t kSpecificStatsSizeEstimateBytes = 128;
+
+Counter64 planCacheHits;
+Counter64 planCacheMisses;
+Counter64 planCacheEvictions;
+Counter64 planCacheTotalSizeBytes;
+
+ServerStatusMetricField<Counter64> displayPlanCacheHits("query.planCache.hits", &planCacheHits);
+ServerStatusMetricField<Counter64> displayPlanCacheMisses("query.planCache.misses",
+                                                          &planCacheMisses);
+ServerStatusMetricField<Counter64> displayPlanCacheEvictions("query.planCache.evictions",
+                                                             &planCacheEvictions);
+ServerStatusMetricField<Counter64> displayPlanCacheSizeBytes("query.planCache.sizeBytes",
+                                                             &planCacheTotalSizeBytes);
+
+// Advanced every time an entry is added to or looked up in any plan cache, so that entries of
+// different collections can be ordered by how recently they were used.
+AtomicUInt64 planCacheAccessClock;
+
+/**
+ * All live plan caches, so that the process-wide size budget can evict across collections.
+ *
+ * Lock ordering: the registry mutex must be acquired before the _cacheMutex of any PlanCache.
+ */
+struct PlanCacheRegistry {
+    stdx::mutex mutex;
+    std::set<PlanCache*> caches;
+};
+
+PlanCacheRegistry& getPlanCacheRegistry() {
+    static PlanCacheRegistry* registry = new PlanCacheRegistry();
+    return *registry;
+}
+
+size_t estimateIndexTreeSize(const PlanCacheIndexTree* tree) {
+    if (!tree) {
+        return 0;
+    }
+
+    size_t size = sizeof(PlanCacheIndexTree);
+    if (tree->entry) {
+        size += sizeof(IndexEntry) + tree->entry->keyPattern.objsize() +
+            tree->entry->infoObj.objsize() + tree->entry->name.capacity();
+    }
+    for (auto&& orPushdown : tree->orPushdowns) {
+        size += sizeof(orPushdown) + orPushdown.indexName.capacity() +
+            orPushdown.route.size() * sizeof(size_t);
+    }
+    for (auto child : tree->children) {
+        size += sizeof(child) + estimateIndexTreeSize(child);
+    }
+    return size;
+}
+
+size_t estimateStatsSize(const PlanStageStats* stats) {
+    if (!stats) {
+        return 0;
+    }
+
+    size_t size = sizeof(PlanStageStats) + stats->common.filter.objsize();
+    if (stats->specific) {
+        size += kSpecificStatsSizeEstimateBytes;
+    }
+    for (auto&& child : stats->children) {
+        size += sizeof(child) + estimateStatsSize(child.get());
+    }
+    return size;
+}
+
 }  // namespace
 
 //
@@ -445,6 +521,29 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
     return entry;
 }
 
+size_t PlanCacheEntry::estimateObjectSizeInBytes() const {
+    size_t size = sizeof(PlanCacheEntry) + query.objsize() + sort.objsize() +
+        projection.objsize() + collation.objsize();
+
+    for (auto scd : plannerData) {
+        size += sizeof(scd) + sizeof(SolutionCacheData) + estimateIndexTreeSize(scd->tree.get());
+    }
+
+    if (decision) {
+        size += sizeof(PlanRankingDecision) + decision->scores.capacity() * sizeof(double) +
+            decision->candidateOrder.capacity() * sizeof(size_t);
+        for (auto&& stats : decision->stats) {
+            size += sizeof(stats) + estimateStatsSize(stats.get());
+        }
+    }
+
+    for (auto fb : feedback) {
+        size += sizeof(fb) + sizeof(PlanCacheEntryFeedback) + estimateStatsSize(fb->stats.get());
+    }
+
+    return size;
+}
+
 std::string PlanCacheEntry::toString() const {
     return str::stream() << "(query: " << query.toString() << ";sort: " << sort.toString()
                          << ";projection: " << projection.toString()
@@ -560,11 +659,20 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+PlanCache::PlanCache() : PlanCache(std::string()) {}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {
+    auto& registry = getPlanCacheRegistry();
+    stdx::lock_guard<stdx::mutex> registryLock(registry.mutex);
+    registry.caches.insert(this);
+}
 
-PlanCache::~PlanCache() {}
+PlanCache::~PlanCache() {
+    auto& registry = getPlanCacheRegistry();
+    stdx::lock_guard<stdx::mutex> registryLock(registry.mutex);
+    registry.caches.erase(this);
+    planCacheTotalSizeBytes.decrement(_sizeBytes);
+}
 
 /**
  * Traverses expression tree pre-order.
@@ -745,14 +853,29 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    const PlanCacheKey key = computeKey(query);
+    {
+        stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+
+        // The entry being replaced, if any, is deleted by the LRU store.
+        PlanCacheEntry* oldEntry;
+        if (_cache.get(key, &oldEntry).isOK()) {
+            releaseEntrySize_inlock(oldEntry);
+        }
+
+        entry->lastAccessTick = planCacheAccessClock.fetchAndAdd(1);
+        chargeEntrySize_inlock(key, entry);
+        std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(key, entry);
 
-    if (NULL != evictedEntry.get()) {
-        LOG(1) << _ns << ": plan cache maximum size exceeded - "
-               << "removed least recently used entry " << redact(evictedEntry->toString());
+        if (NULL != evictedEntry.get()) {
+            releaseEntrySize_inlock(evictedEntry.get());
+            planCacheEvictions.increment();
+            LOG(1) << _ns << ": plan cache maximum size exceeded - "
+                   << "removed least recently used entry " << redact(evictedEntry->toString());
+        }
     }
 
+    enforceTotalSizeBudget();
     return Status::OK();
 }
 
@@ -769,9 +892,12 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
 	//_cacheӸkeyȡPlanCacheEntry
     Status cacheStatus = _cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
+        planCacheMisses.increment();
         return cacheStatus;
     }
     invariant(entry);
+    planCacheHits.increment();
+    entry->lastAccessTick = planCacheAccessClock.fetchAndAdd(1);
 
     *crOut = new CachedSolution(key, *entry);
 
@@ -879,32 +1005,121 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
-    if (!cacheStatus.isOK()) {
-        return cacheStatus;
-    }
-    invariant(entry);
+    {
+        stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+        PlanCacheEntry* entry;
+        Status cacheStatus = _cache.get(ck, &entry);
+        if (!cacheStatus.isOK()) {
+            return cacheStatus;
+        }
+        invariant(entry);
+        entry->lastAccessTick = planCacheAccessClock.fetchAndAdd(1);
 
-    // We store up to a constant number of feedback entries.
-    if (entry->feedback.size() < static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
+        // We store up to a constant number of feedback entries.
+        if (entry->feedback.size() >=
+            static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
+            return Status::OK();
+        }
         entry->feedback.push_back(autoFeedback.release());
+        chargeEntrySize_inlock(ck, entry);
     }
 
+    enforceTotalSizeBudget();
     return Status::OK();
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
+    PlanCacheKey key = computeKey(canonicalQuery);
+
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    PlanCacheEntry* entry;
+    Status cacheStatus = _cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+    releaseEntrySize_inlock(entry);
+    return _cache.remove(key);
 }
 
 void PlanCache::clear() {
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    planCacheTotalSizeBytes.decrement(_sizeBytes);
+    _sizeBytes = 0;
     _cache.clear();
 }
 
+void PlanCache::chargeEntrySize_inlock(const PlanCacheKey& key, PlanCacheEntry* entry) {
+    releaseEntrySize_inlock(entry);
+
+    // The key is stored twice: in the LRU list and in the map that indexes it.
+    entry->estimatedEntrySizeBytes = entry->estimateObjectSizeInBytes() + 2 * key.size();
+    _sizeBytes += entry->estimatedEntrySizeBytes;
+    planCacheTotalSizeBytes.increment(entry->estimatedEntrySizeBytes);
+}
+
+void PlanCache::releaseEntrySize_inlock(const PlanCacheEntry* entry) {
+    invariant(_sizeBytes >= entry->estimatedEntrySizeBytes);
+    _sizeBytes -= entry->estimatedEntrySizeBytes;
+    planCacheTotalSizeBytes.decrement(entry->estimatedEntrySizeBytes);
+}
+
+bool PlanCache::evictLeastRecentlyUsed(uint64_t accessTick) {
+    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    if (_cache.size() == 0) {
+        return false;
+    }
+
+    const auto& leastRecentlyUsed = *std::prev(_cache.end());
+    if (leastRecentlyUsed.second->lastAccessTick != accessTick) {
+        return false;
+    }
+
+    LOG(1) << _ns << ": plan cache total size budget exceeded - "
+           << "removed least recently used entry " << redact(leastRecentlyUsed.second->toString());
+    releaseEntrySize_inlock(leastRecentlyUsed.second);
+    planCacheEvictions.increment();
+
+    // Copy the key, as removing the entry destroys the list element that holds it.
+    const PlanCacheKey key = leastRecentlyUsed.first;
+    invariantOK(_cache.remove(key));
+    return true;
+}
+
+void PlanCache::enforceTotalSizeBudget() {
+    const long long maxTotalSizeBytes = internalQueryCacheMaxTotalSizeBytes.load();
+    if (planCacheTotalSizeBytes.get() <= maxTotalSizeBytes) {
+        return;
+    }
+
+    // Each eviction scans the tail of every plan cache. This is only reached after adding an
+    // entry or its feedback, both of which follow a trial execution of the query, so the scan is
+    // cheap by comparison.
+    auto& registry = getPlanCacheRegistry();
+    stdx::lock_guard<stdx::mutex> registryLock(registry.mutex);
+    while (planCacheTotalSizeBytes.get() > maxTotalSizeBytes) {
+        PlanCache* victim = nullptr;
+        uint64_t oldestAccessTick = std::numeric_limits<uint64_t>::max();
+        for (PlanCache* cache : registry.caches) {
+            stdx::lock_guard<stdx::mutex> cacheLock(cache->_cacheMutex);
+            if (cache->_cache.size() == 0) {
+                continue;
+            }
+            const uint64_t accessTick = std::prev(cache->_cache.end())->second->lastAccessTick;
+            if (accessTick < oldestAccessTick) {
+                oldestAccessTick = accessTick;
+                victim = cache;
+            }
+        }
+
+        if (!victim) {
+            break;
+        }
+
+        // If the chosen entry was used in the meantime, the next pass picks a new victim.
+        victim->evictLeastRecentlyUsed(oldestAccessTick);
+    }
+}
+
 //computeKey(cq)ΪgetPlansByQueryеĲѯdb.xx.getPlanCache().getPlansByQuery({"query" : {"create_time" : { "$gte" : "2020-12-27 00:00:00","$lte" : "2021-01-26 23:59:59"}},"sort" : { },"projection" : {}})
 //PlanCache::contains
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -926,6 +1141,7 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
         return cacheStatus;
     }
     invariant(entry);
+    entry->lastAccessTick = planCacheAccessClock.fetchAndAdd(1);
 
     *entryOut = entry->clone();
 
@@ -957,6 +1173,15 @@ size_t PlanCache::size() const {
     return _cache.size();
 }
 
+size_t PlanCache::sizeBytes() const {
+    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    return _sizeBytes;
+}
+
+long long PlanCache::getTotalSizeBytes() {
+    return planCacheTotalSizeBytes.get();
+}
+
 //CollectionInfoCacheImpl::updatePlanCacheIndexEntriesеã
 //CollectionInfoCacheImpl::updatePlanCacheIndexEntriesIndexEntryIndexDescriptorת
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
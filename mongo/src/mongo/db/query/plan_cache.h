@@ -518,6 +518,23 @@ public:
     //PlanCacheListPlans::listͨPlanCacheListPlans
     //ԴCachedPlanStage::updatePlanCache()
     std::vector<PlanCacheEntryFeedback*> feedback;
+
+    /**
+     * Returns an approximation of the memory used by this entry, including its planner data,
+     * ranking decision and feedback.
+     */
+    size_t estimateObjectSizeInBytes() const;
+
+    //
+    // Memory accounting, maintained by the owning PlanCache
+    //
+
+    // The size of this entry and its key as last charged against the plan cache size budget.
+    size_t estimatedEntrySizeBytes = 0;
+
+    // Value of the process-wide plan cache clock when this entry was last added or looked up.
+    // Used to find the least recently used entry across the plan caches of all collections.
+    uint64_t lastAccessTick = 0;
 };
 
 /**
@@ -701,6 +718,16 @@ public:
      */
     size_t size() const;
 
+    /**
+     * Returns the approximate number of bytes used by the entries in this cache.
+     */
+    size_t sizeBytes() const;
+
+    /**
+     * Returns the approximate number of bytes used by the plan caches of all collections.
+     */
+    static long long getTotalSizeBytes();
+
     /**
      * Updates internal state kept about the collection's indexes.  Must be called when the set
      * of indexes on the associated collection have changed.
@@ -713,6 +740,31 @@ private:
     void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
+
+    /**
+     * Charges the size of 'entry', stored under 'key', against this cache and against the
+     * process-wide total, replacing whatever was previously charged for it. Callers must hold
+     * _cacheMutex.
+     */
+    void chargeEntrySize_inlock(const PlanCacheKey& key, PlanCacheEntry* entry);
+
+    /**
+     * Releases the size charged for 'entry'. Callers must hold _cacheMutex.
+     */
+    void releaseEntrySize_inlock(const PlanCacheEntry* entry);
+
+    /**
+     * Evicts the least recently used entry of this cache, provided that it was last accessed at
+     * 'accessTick'. Returns false if that entry was accessed or removed in the meantime.
+     */
+    bool evictLeastRecentlyUsed(uint64_t accessTick);
+
+    /**
+     * Evicts the least recently used entries across the plan caches of all collections until
+     * their total size is within internalQueryCacheMaxTotalSizeBytes. Must not be called while
+     * holding the _cacheMutex of any plan cache.
+     */
+    static void enforceTotalSizeBudget();
     
     //PlanCacheEntryPlanCacheKey浽֧LRU
     //ĳPlanCacheEntry, οPlanCache::get  PlanCache::getAllEntries()
@@ -722,6 +774,9 @@ private:
     // Protects _cache.
     mutable stdx::mutex _cacheMutex;
 
+    // Approximate number of bytes used by the entries in _cache. Protected by _cacheMutex.
+    size_t _sizeBytes = 0;
+
     // Full namespace of collection.
     std::string _ns;
 
@@ -449,6 +449,64 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+TEST(PlanCacheTest, AddAndRemoveUpdateSizeBytes) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    const long long totalSizeBytesBefore = PlanCache::getTotalSizeBytes();
+    ASSERT_EQUALS(planCache.sizeBytes(), 0U);
+
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    ASSERT_GT(planCache.sizeBytes(), 0U);
+    ASSERT_EQUALS(PlanCache::getTotalSizeBytes(),
+                  totalSizeBytesBefore + static_cast<long long>(planCache.sizeBytes()));
+
+    ASSERT_OK(planCache.remove(*cq));
+    ASSERT_EQUALS(planCache.sizeBytes(), 0U);
+    ASSERT_EQUALS(PlanCache::getTotalSizeBytes(), totalSizeBytesBefore);
+}
+
+TEST(PlanCacheTest, TotalSizeBudgetEvictsLeastRecentlyUsedEntryAcrossCaches) {
+    PlanCache planCacheA("test.a");
+    PlanCache planCacheB("test.b");
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    unique_ptr<CanonicalQuery> cqC(canonicalize("{c: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCacheA.add(*cqA, solns, createDecision(1U), Date_t{}));
+    ASSERT_OK(planCacheB.add(*cqB, solns, createDecision(1U), Date_t{}));
+
+    // Looking up the entry in 'planCacheA' makes the entry in 'planCacheB' the least recently used.
+    CachedSolution* rawCS;
+    ASSERT_OK(planCacheA.get(*cqA, &rawCS));
+    unique_ptr<CachedSolution> cachedSolution(rawCS);
+
+    // Leave no room for another entry.
+    const long long oldMaxTotalSizeBytes = internalQueryCacheMaxTotalSizeBytes.load();
+    ON_BLOCK_EXIT([oldMaxTotalSizeBytes] {
+        internalQueryCacheMaxTotalSizeBytes.store(oldMaxTotalSizeBytes);
+    });
+    internalQueryCacheMaxTotalSizeBytes.store(PlanCache::getTotalSizeBytes());
+
+    ASSERT_OK(planCacheB.add(*cqC, solns, createDecision(1U), Date_t{}));
+    ASSERT_TRUE(planCacheA.contains(*cqA));
+    ASSERT_FALSE(planCacheB.contains(*cqB));
+    ASSERT_TRUE(planCacheB.contains(*cqC));
+    ASSERT_LTE(PlanCache::getTotalSizeBytes(), internalQueryCacheMaxTotalSizeBytes.load());
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -323,31 +323,51 @@ unique_ptr<PlanStageStats> PlanExecutor::getStats() const {
     return _root->getStats();
 }
 
-BSONObjSet PlanExecutor::getOutputSorts() const {
-    if (_qs && _qs->root) {
-        _qs->root->computeProperties();
-        return _qs->root->getSort();
+const QuerySolution* PlanExecutor::getWinningSolution() const {
+    // '_qs' holds the cached solution, which is no longer the one being run if the CachedPlanStage
+    // threw it away and planned the query again.
+    if (PlanStage* foundStage = getStageByType(_root.get(), STAGE_CACHED_PLAN)) {
+        auto cachedPlan = static_cast<CachedPlanStage*>(foundStage);
+        if (cachedPlan->replanned()) {
+            return cachedPlan->replannedSolution();
+        }
+    }
+
+    if (_qs) {
+        return _qs.get();
     }
 
     if (_root->stageType() == STAGE_MULTI_PLAN) {
         // If we needed a MultiPlanStage, the PlanExecutor does not own the QuerySolution. We
-        // must go through the MultiPlanStage to access the output sort.
-        auto multiPlanStage = static_cast<MultiPlanStage*>(_root.get());
-        if (multiPlanStage->bestSolution()) {
-            multiPlanStage->bestSolution()->root->computeProperties();
-            return multiPlanStage->bestSolution()->root->getSort();
-        }
+        // must go through the MultiPlanStage to access it.
+        return static_cast<MultiPlanStage*>(_root.get())->bestSolution();
     } else if (_root->stageType() == STAGE_SUBPLAN) {
-        auto subplanStage = static_cast<SubplanStage*>(_root.get());
-        if (subplanStage->compositeSolution()) {
-            subplanStage->compositeSolution()->root->computeProperties();
-            return subplanStage->compositeSolution()->root->getSort();
-        }
+        return static_cast<SubplanStage*>(_root.get())->compositeSolution();
+    }
+
+    return nullptr;
+}
+
+BSONObjSet PlanExecutor::getOutputSorts() const {
+    const QuerySolution* solution = getWinningSolution();
+    if (solution && solution->root) {
+        solution->root->computeProperties();
+        return solution->root->getSort();
     }
 
     return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
 }
 
+bool PlanExecutor::isCovered() const {
+    const QuerySolution* solution = getWinningSolution();
+    if (!solution || !solution->root) {
+        return false;
+    }
+
+    solution->root->computeProperties();
+    return !solution->root->fetched();
+}
+
 OperationContext* PlanExecutor::getOpCtx() const {
     return _opCtx;
 }
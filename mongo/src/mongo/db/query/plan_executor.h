@@ -435,6 +435,12 @@ public:
      */
     BSONObjSet getOutputSorts() const;
 
+    /**
+     * Returns true if the winning plan answers the query from index keys alone, without fetching
+     * any documents.
+     */
+    bool isCovered() const;
+
     /**
      * Communicate to this PlanExecutor that it is no longer registered with the CursorManager as a
      * 'non-cached PlanExecutor'.
@@ -546,6 +552,14 @@ private:
      */
     Status pickBestPlan(const Collection* collection);
 
+    /**
+     * Returns the solution that the execution tree was built from, or nullptr if it was not built
+     * by the query planner. The solution of a MultiPlanStage or SubplanStage is only known once
+     * plan selection has completed, and that of a replanned CachedPlanStage is the one replanning
+     * chose rather than the cached one.
+     */
+    const QuerySolution* getWinningSolution() const;
+
     /**
      * Given a non-OK status returned from a yield 'yieldError', checks if this PlanExecutor
      * represents a tailable, awaitData cursor and whether 'yieldError' is the error object
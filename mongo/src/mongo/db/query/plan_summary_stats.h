@@ -63,6 +63,24 @@ struct PlanSummaryStats { //
 
     // Was a replan triggered during the execution of this query?
     bool replanned = false;
+
+    // The approximate number of bytes, partitions, and partition re-reads spilled to disk by the
+    // $group stages of an aggregation.
+    long long groupSpilledBytes = 0;
+    long long groupSpilledPartitions = 0;
+    long long groupSpillPasses = 0;
+
+    // The number of localField/foreignField $lookup stages of an aggregation which joined with a
+    // hash table, and the number of foreign documents read into memory to build such tables.
+    long long lookupHashJoins = 0;
+    long long lookupForeignDocsMaterialized = 0;
+
+    // The queries, cache hits, documents returned and spills to disk of the $graphLookup stages of
+    // an aggregation.
+    long long graphLookupQueries = 0;
+    long long graphLookupCacheHits = 0;
+    long long graphLookupDocsReturned = 0;
+    long long graphLookupSpills = 0;
 };
 
 }  // namespace mongo
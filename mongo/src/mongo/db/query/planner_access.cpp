@@ -176,6 +176,12 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         }
     }
 
+    // A scan may start in the middle of the collection only if nothing asked for natural order.
+    csn->shareScan = (params.options & QueryPlannerParams::SHARE_COLLECTION_SCANS) && !tailable &&
+        !csn->shouldTrackLatestOplogTimestamp && 0 == csn->maxScan &&
+        dps::extractElementAtPath(query.getQueryRequest().getHint(), "$natural").eoo() &&
+        dps::extractElementAtPath(sortObj, "$natural").eoo();
+
     return std::move(csn);
 }
 
@@ -73,6 +73,10 @@ extern AtomicInt32 internalQueryCacheFeedbacksStored;
 // and replanning?
 extern AtomicDouble internalQueryCacheEvictionRatio;
 
+// The approximate number of bytes that the plan caches of all collections may use together
+// before the least recently used entries across all collections are evicted.
+extern AtomicInt64 internalQueryCacheMaxTotalSizeBytes;
+
 //
 // Planning and enumeration.
 //
@@ -117,6 +121,23 @@ extern AtomicInt32 internalQueryExecYieldIterations;
 //Ϸӳǵǰ̻߳ȡݵΪ˶Ҫ yield
 extern AtomicInt32 internalQueryExecYieldPeriodMS;
 
+// The maximum number of threads a single collection scan may use to evaluate its filter. A value
+// of 1 disables parallel filtering.
+extern AtomicInt32 internalQueryExecMaxCollectionScanParallelism;
+
+// The number of documents a collection scan tests serially before it starts filtering in parallel,
+// and the number of documents it then reads ahead and filters at a time.
+extern AtomicInt32 internalQueryExecCollectionScanParallelBatchSize;
+
+// Allow a find or aggregation that scans a collection in no particular order to start where other
+// scans of the collection have got to, and to wrap around at its end, so that concurrent scans
+// read each record while it is still cached.
+extern AtomicBool internalQueryExecEnableSharedCollectionScans;
+
+// The number of documents a fetch stage collects from its child and then reads in RecordId order,
+// once it has fetched that many documents one at a time. A value of 1 disables batched fetching.
+extern AtomicInt32 internalQueryExecFetchBatchSize;
+
 // Limit the size that we write without yielding to 16MB / 64 (max expected number of indexes)
 const int64_t insertVectorMaxBytes = 256 * 1024;
 
@@ -129,5 +150,23 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// The maximum number of bytes of foreign documents that a localField/foreignField $lookup may
+// materialize into an in-memory hash table. A value of 0 disables the hash join strategy.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMaxMemoryBytes;
+
+// The number of local documents a $lookup joins with per-document sub-pipelines before it
+// attempts to switch to the hash join strategy.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinInputThreshold;
+
+// The maximum number of frontier values a $graphLookup queries for with a single $in query.
+extern AtomicInt32 internalDocumentSourceGraphLookupMaxFrontierBatchSize;
+
+// Allow a $group whose _id and accumulator arguments are all field paths or constants to consume
+// its input in batches, evaluating each referenced field path once per document.
+extern AtomicBool internalDocumentSourceGroupEnableBatchedExecution;
+
+// The number of documents a batched $group consumes at a time.
+extern AtomicInt32 internalDocumentSourceGroupBatchSize;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
 }  // namespace mongo
@@ -111,6 +111,10 @@ struct QueryPlannerParams {
 
         // Set this to track the most recent timestamp seen by this cursor while scanning the oplog.
         TRACK_LATEST_OPLOG_TS = 1 << 12,
+
+        // Set this to allow a collection scan that need not return documents in natural order to
+        // join the scans of the same collection already in progress. See CollectionScanParams.
+        SHARE_COLLECTION_SCANS = 1 << 13,
     };
 
     // See Options enum above.
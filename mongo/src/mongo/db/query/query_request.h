@@ -234,6 +234,7 @@ db.runCommand(
       "noCursorTimeout": <bool>,
       "awaitData": <bool>,
       "allowPartialResults": <bool>,
+      "readAhead": <bool>,
       "collation": <document>
    }
 )
@@ -591,6 +592,14 @@ public:
         _allowPartialResults = allowPartialResults;
     }
 
+    bool isReadAhead() const {
+        return _readAhead;
+    }
+
+    void setReadAhead(bool readAhead) {
+        _readAhead = readAhead;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -728,6 +737,10 @@ private:
     bool _exhaust = false;
     bool _allowPartialResults = false;
 
+    // Whether each getMore on the cursor should have its following batch read ahead in the
+    // background. See CursorPrefetcher.
+    bool _readAhead = false;
+
     boost::optional<long long> _replicationTerm;
 };
 
@@ -335,6 +335,10 @@ struct CollectionScanNode : public QuerySolutionNode {
     // maxScan option to .find() limits how many docs we look at.
     //db.collection.find( { $query: { <query> }, $maxScan: <number> } )
     int maxScan;
+
+    // May the scan join the scans of the same collection in progress, and so return documents out
+    // of natural order?
+    bool shareScan = false;
 };
 
 
@@ -73,13 +73,16 @@
 #include "mongo/db/session_txn_record_gen.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/recovery_unit.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -88,6 +91,7 @@ using std::endl;
 namespace repl {
 
 AtomicInt32 SyncTail::replBatchLimitOperations{50 * 1000};
+AtomicInt32 SyncTail::replWriterPartitionsPerThread{4};
 
 namespace {
 
@@ -140,6 +144,25 @@ public:
     }
 } exportedBatchLimitOperationsParam;
 
+class ExportedWriterPartitionsPerThreadParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedWriterPartitionsPerThreadParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "replWriterPartitionsPerThread",
+              &SyncTail::replWriterPartitionsPerThread) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "replWriterPartitionsPerThread must be between 1 and 64, inclusive");
+        }
+
+        return Status::OK();
+    }
+} exportedWriterPartitionsPerThreadParam;
+
 // The oplog entries applied
 Counter64 opsAppliedStats;
 ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
@@ -153,6 +176,44 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+// Number of writer partitions applied
+Counter64 partitionsAppliedStats;
+ServerStatusMetricField<Counter64> displayPartitionsApplied("repl.apply.partitions",
+                                                            &partitionsAppliedStats);
+
+// Time writer threads which had work in a batch spent waiting for the other writers to finish
+Counter64 writerIdleMicrosStats;
+ServerStatusMetricField<Counter64> displayWriterIdleMicros("repl.apply.writerIdleMicros",
+                                                           &writerIdleMicrosStats);
+
+/**
+ * Reports the time each writer thread has spent applying operations as an array indexed by writer.
+ */
+class WriterBusyTimeMetric final : public ServerStatusMetric {
+public:
+    WriterBusyTimeMetric() : ServerStatusMetric("repl.apply.writerBusyMicros") {}
+
+    void record(size_t writerId, long long busyMicros) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_busyMicros.size() <= writerId) {
+            _busyMicros.resize(writerId + 1);
+        }
+        _busyMicros[writerId] += busyMicros;
+    }
+
+    void appendAtLeaf(BSONObjBuilder& b) const final {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        BSONArrayBuilder arr(b.subarrayStart(_leafName));
+        for (auto busyMicros : _busyMicros) {
+            arr.append(busyMicros);
+        }
+    }
+
+private:
+    mutable stdx::mutex _mutex;
+    std::vector<long long> _busyMicros;
+} writerBusyTimeMetric;
+
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -462,19 +523,69 @@ void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherP
 
 // Doles out all the work to the writer pool threads.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
+//
+// Each of the writer vectors is a dependency partition: operations which must be applied in order
+// (same namespace, and same _id on doc-locking engines) are always in the same partition, while
+// partitions may be applied in any order relative to each other. Rather than pinning each
+// partition to a thread, every writer thread repeatedly claims the largest remaining partition,
+// so that a thread which finishes early picks up more work instead of waiting on the slowest one.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
               OldThreadPool* writerPool,
               const MultiApplier::ApplyOperationFn& func,
               std::vector<Status>* statusVector) {
     invariant(writerVectors.size() == statusVector->size());
     TimerHolder timer(&applyBatchStats);
+
+    // Shared by the scheduled writers, which may outlive this function.
+    struct ApplyState {
+        std::vector<size_t> partitions;
+        AtomicWord<unsigned long long> nextPartition{0};
+        AtomicWord<unsigned long long> numRunningWriters{0};
+        AtomicInt64 totalBusyMicros{0};
+        Timer batchTimer;
+    };
+    auto state = std::make_shared<ApplyState>();
+
     for (size_t i = 0; i < writerVectors.size(); i++) {
         if (!writerVectors[i].empty()) {
-            writerPool->schedule([&func, &writerVectors, statusVector, i] {
-                (*statusVector)[i] = func(&writerVectors[i]);
-            });
+            state->partitions.push_back(i);
         }
     }
+    std::stable_sort(state->partitions.begin(),
+                     state->partitions.end(),
+                     [&writerVectors](size_t lhs, size_t rhs) {
+                         return writerVectors[lhs].size() > writerVectors[rhs].size();
+                     });
+
+    const size_t numWriters =
+        std::min(state->partitions.size(), static_cast<size_t>(writerPool->getNumThreads()));
+    state->numRunningWriters.store(numWriters);
+
+    for (size_t writerId = 0; writerId < numWriters; writerId++) {
+        writerPool->schedule([&func, &writerVectors, statusVector, state, numWriters, writerId] {
+            Timer busyTimer;
+            for (auto next = state->nextPartition.fetchAndAdd(1); next < state->partitions.size();
+                 next = state->nextPartition.fetchAndAdd(1)) {
+                const auto i = state->partitions[next];
+                (*statusVector)[i] = func(&writerVectors[i]);
+                partitionsAppliedStats.increment();
+            }
+
+            const long long busyMicros = busyTimer.micros();
+            writerBusyTimeMetric.record(writerId, busyMicros);
+            state->totalBusyMicros.fetchAndAdd(busyMicros);
+
+            // The last writer to finish accounts for the time the others spent waiting on it.
+            if (state->numRunningWriters.subtractAndFetch(1) == 0) {
+                const long long idleMicros = static_cast<long long>(numWriters) *
+                        state->batchTimer.micros() -
+                    state->totalBusyMicros.load();
+                if (idleMicros > 0) {
+                    writerIdleMicrosStats.increment(idleMicros);
+                }
+            }
+        });
+    }
 }
 
 void initializeWriterThread() {
@@ -626,7 +737,7 @@ private:
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * writerVectors - Set of dependency partitions of operations for the worker threads to apply.
  * latestSessionRecords - Populated map of the "latest" transaction table records for each logical
  *      session id present in the given operations. Each record represents the final state of the
  *      transaction table entry for that session id after the operations are applied.
@@ -1510,7 +1621,13 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
                 "attempting to replicate ops while primary"};
     }
 
-    std::vector<Status> statusVector(workerPool->getNumThreads(), Status::OK());
+    // Split the batch into more dependency partitions than there are writer threads, so that
+    // writers can balance the work dynamically. Using a multiple of the number of threads keeps
+    // the assignment of operations to partitions consistent with the assignment to threads.
+    const size_t numPartitions = workerPool->getNumThreads() *
+        static_cast<size_t>(SyncTail::replWriterPartitionsPerThread.load());
+
+    std::vector<Status> statusVector(numPartitions, Status::OK());
     {
         const bool pinOldestTimestamp = !serverGlobalParams.enableMajorityReadConcern;
         std::unique_ptr<RecoveryUnit> pinningTransaction;
@@ -1546,7 +1663,7 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
         consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
         scheduleWritesToOplog(opCtx, workerPool, ops);
 
-        std::vector<MultiApplier::OperationPtrs> writerVectors(workerPool->getNumThreads());
+        std::vector<MultiApplier::OperationPtrs> writerVectors(numPartitions);
         SessionRecordMap latestSessionRecords;
         fillWriterVectorsAndLatestSessionRecords(
             opCtx, &ops, &writerVectors, &latestSessionRecords);
@@ -223,6 +223,11 @@ public:
 
     static AtomicInt32 replBatchLimitOperations;
 
+    // Number of dependency partitions each writer thread's share of a batch is split into. Writer
+    // threads pull partitions dynamically, so a thread which finishes a cheap partition moves on
+    // to the next one rather than waiting for the slowest writer.
+    static AtomicInt32 replWriterPartitionsPerThread;
+
 protected:
     static const unsigned int replBatchLimitBytes = 100 * 1024 * 1024;
     static const int replBatchLimitSeconds = 1;
@@ -574,6 +574,77 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1].doc);
 }
 
+TEST_F(SyncTailTest, MultiApplyKeepsOperationsOnTheSameNamespaceInOnePartition) {
+    const int oldPartitionsPerThread = SyncTail::replWriterPartitionsPerThread.load();
+    ON_BLOCK_EXIT([oldPartitionsPerThread] {
+        SyncTail::replWriterPartitionsPerThread.store(oldPartitionsPerThread);
+    });
+    const int partitionsPerThread = 4;
+    SyncTail::replWriterPartitionsPerThread.store(partitionsPerThread);
+
+    OldThreadPool writerPool(2);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn = [&mutex, &operationsApplied](
+        MultiApplier::OperationPtrs* operationsForPartitionToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *operationsForPartitionToApply) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    // Two inserts into each of 16 namespaces.
+    MultiApplier::Operations ops;
+    for (int i = 0; i < 32; ++i) {
+        NamespaceString nss("test.t" + std::to_string(i % 16));
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i), 1LL}, nss, BSON("_id" << i << "x" << i)));
+    }
+
+    _storageInterface->insertDocumentsFn =
+        [](OperationContext*, const NamespaceString&, const std::vector<InsertStatement>&) {
+            return Status::OK();
+        };
+
+    auto lastOpTime =
+        unittest::assertGet(multiApply(_opCtx.get(), &writerPool, ops, applyOperationFn));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_LTE(operationsApplied.size(), 2U * partitionsPerThread);
+
+    // Every operation is applied exactly once, and operations on the same namespace are applied by
+    // the same call, in oplog order.
+    StringMap<size_t> partitionForNamespace;
+    size_t numApplied = 0;
+    for (size_t partition = 0; partition < operationsApplied.size(); ++partition) {
+        for (auto&& op : operationsApplied[partition]) {
+            ++numApplied;
+            auto it = partitionForNamespace.find(op.getNamespace().ns());
+            if (it == partitionForNamespace.end()) {
+                partitionForNamespace[op.getNamespace().ns()] = partition;
+            } else {
+                ASSERT_EQUALS(partition, it->second);
+            }
+        }
+    }
+    ASSERT_EQUALS(ops.size(), numApplied);
+
+    for (auto&& partitionOps : operationsApplied) {
+        StringMap<OpTime> lastOpTimeForNamespace;
+        for (auto&& op : partitionOps) {
+            auto it = lastOpTimeForNamespace.find(op.getNamespace().ns());
+            if (it != lastOpTimeForNamespace.end()) {
+                ASSERT_LT(it->second, op.getOpTime());
+            }
+            lastOpTimeForNamespace[op.getNamespace().ns()] = op.getOpTime();
+        }
+    }
+}
+
 TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     // Set up the transactions collection, which can only be done by the primary.
     ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
@@ -34,10 +34,13 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
@@ -53,7 +56,9 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/log.h"
@@ -66,6 +71,25 @@ namespace {
 using Deletion = CollectionRangeDeleter::Deletion;
 using DeleteNotification = CollectionRangeDeleter::DeleteNotification;
 
+// Number of orphaned documents removed together in one storage transaction. Larger groups amortize
+// the commit across many documents, at the cost of holding more uncommitted changes at once.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterDocsPerWriteUnit, int, 64);
+
+// Pause between successive batches of range deletion, to bound the rate at which a shard removes
+// orphaned documents. A value of 0 schedules the next batch immediately.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchDelayMS, int, 0);
+
+// The batches of range deletion, with the time spent in them, and the documents and bytes removed
+Counter64 rangeDeleterDocsDeleted;
+ServerStatusMetricField<Counter64> displayRangeDeleterDocsDeleted("rangeDeleter.docsDeleted",
+                                                                  &rangeDeleterDocsDeleted);
+Counter64 rangeDeleterBytesDeleted;
+ServerStatusMetricField<Counter64> displayRangeDeleterBytesDeleted("rangeDeleter.bytesDeleted",
+                                                                   &rangeDeleterBytesDeleted);
+TimerStats rangeDeleterBatches;
+ServerStatusMetricField<TimerStats> displayRangeDeleterBatches("rangeDeleter.batches",
+                                                               &rangeDeleterBatches);
+
 const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 WriteConcernOptions::SyncMode::UNSET,
                                                 Seconds(60));
@@ -266,6 +290,11 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     }
 
     notification.abandon();
+
+    const auto batchDelay = Milliseconds(rangeDeleterBatchDelayMS.load());
+    if (batchDelay > Milliseconds(0)) {
+        return Date_t::now() + batchDelay;
+    }
     return Date_t{};
 }
 
@@ -315,40 +344,94 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         saver.emplace("moveChunk", nss.ns(), "cleaning");
     }
 
+    // A single scan walks the range for the whole batch, so that each document does not pay for a
+    // fresh seek past the index entries of the documents deleted before it. The documents are
+    // removed in groups, each in one storage transaction; the scan is saved across each group. The
+    // scan only yields record ids, and each document is read once, when it is deleted.
+    auto exec = InternalPlanner::indexScan(opCtx,
+                                           collection,
+                                           descriptor,
+                                           min,
+                                           max,
+                                           BoundInclusion::kIncludeStartKeyOnly,
+                                           PlanExecutor::YIELD_MANUAL,
+                                           InternalPlanner::FORWARD,
+                                           InternalPlanner::IXSCAN_DEFAULT);
+
+    const int docsPerWriteUnit = std::max(rangeDeleterDocsPerWriteUnit.load(), 1);
+    std::vector<RecordId> group;
+    group.reserve(std::min(docsPerWriteUnit, maxToDelete));
+
+    TimerHolder batchTimer(&rangeDeleterBatches);
+
     int numDeleted = 0;
-    do {
-        auto halfOpen = BoundInclusion::kIncludeStartKeyOnly;
-        auto manual = PlanExecutor::YIELD_MANUAL;
-        auto forward = InternalPlanner::FORWARD;
-        auto fetch = InternalPlanner::IXSCAN_FETCH;
-
-        auto exec = InternalPlanner::indexScan(
-            opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
-
-        RecordId rloc;
-        BSONObj obj;
-        PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
-        if (state == PlanExecutor::IS_EOF) {
-            break;
+    bool exhausted = false;
+    while (!exhausted && numDeleted < maxToDelete) {
+        group.clear();
+        while (int(group.size()) < docsPerWriteUnit &&
+               numDeleted + int(group.size()) < maxToDelete) {
+            RecordId rloc;
+            BSONObj obj;
+            PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+            if (state == PlanExecutor::IS_EOF) {
+                exhausted = true;
+                break;
+            }
+            if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                warning() << PlanExecutor::statestr(state)
+                          << " - cursor error while trying to delete " << redact(min) << " to "
+                          << redact(max) << " in " << nss << ": "
+                          << WorkingSetCommon::toStatusString(obj)
+                          << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                exhausted = true;
+                break;
+            }
+            invariant(PlanExecutor::ADVANCED == state);
+            group.push_back(std::move(rloc));
         }
-        if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
-            warning() << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
-                      << redact(min) << " to " << redact(max) << " in " << nss << ": "
-                      << WorkingSetCommon::toStatusString(obj)
-                      << ", stats: " << Explain::getWinningPlanStats(exec.get());
+
+        if (group.empty()) {
             break;
         }
-        invariant(PlanExecutor::ADVANCED == state);
 
+        long long groupBytes = 0;
+        // The number of leading documents of the group already written to the RemoveSaver, which
+        // a retry after a write conflict must not write again.
+        size_t numSaved = 0;
+        exec->saveState();
         writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
+            groupBytes = 0;
             WriteUnitOfWork wuow(opCtx);
-            if (saver) {
-                uassertStatusOK(saver->goingToDelete(obj));
+            for (size_t i = 0; i < group.size(); ++i) {
+                const auto& rloc = group[i];
+                // A retry after a write conflict may find a document already removed by a
+                // concurrent writer.
+                Snapshotted<BSONObj> doc;
+                if (!collection->findDoc(opCtx, rloc, &doc)) {
+                    continue;
+                }
+                if (saver && i >= numSaved) {
+                    uassertStatusOK(saver->goingToDelete(doc.value()));
+                    numSaved = i + 1;
+                }
+                groupBytes += doc.value().objsize();
+                collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             }
-            collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             wuow.commit();
         });
-    } while (++numDeleted < maxToDelete);
+
+        numDeleted += group.size();
+        rangeDeleterDocsDeleted.increment(group.size());
+        rangeDeleterBytesDeleted.increment(groupBytes);
+
+        auto restoreStatus = exec->restoreState();
+        if (!restoreStatus.isOK()) {
+            // The next batch starts a fresh scan of whatever remains in the range
+            LOG(1) << "Ending range deletion batch in " << nss.ns() << " early: "
+                   << redact(restoreStatus);
+            break;
+        }
+    }
 
     return numDeleted;
 }
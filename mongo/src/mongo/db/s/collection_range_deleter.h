@@ -158,7 +158,8 @@ public:
      * it must be called without locks.
      *
      * If it should be scheduled to run again because there might be more documents to delete,
-     * returns the time to begin, or boost::none otherwise.
+     * returns the time to begin, or boost::none otherwise. After a pass that deleted documents, the
+     * next pass begins rangeDeleterBatchDelayMS later.
      *
      * Argument 'forTestOnly' is used in unit tests that exercise the CollectionRangeDeleter class,
      * so that they do not need to set up CollectionShardingState and MetadataManager objects.
@@ -171,8 +172,9 @@ public:
 
 private:
     /**
-     * Performs the deletion of up to maxToDelete entries within the range in progress. Must be
-     * called under the collection lock.
+     * Performs the deletion of up to maxToDelete entries within the range in progress, in groups of
+     * rangeDeleterDocsPerWriteUnit documents per storage transaction. Must be called under the
+     * collection lock.
      *
      * Returns the number of documents deleted, 0 if done with the range, or bad status if deleting
      * the range failed.
@@ -242,6 +242,33 @@ TEST_F(CollectionRangeDeleterTest, MultipleCleanupNextRangeCalls) {
     ASSERT_EQUALS(0ULL, dbclient.count(kAdminSysVer.ns(), BSON(kPattern << "startRangeDeletion")));
 }
 
+// Tests the case that a batch of the range deleter spans several storage transactions.
+TEST_F(CollectionRangeDeleterTest, BatchLargerThanOneWriteUnit) {
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 0; i < 300; ++i) {
+        dbclient.insert(kNss.toString(), BSON(kPattern << i));
+    }
+    ASSERT_EQUALS(300ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 300)));
+
+    std::list<Deletion> ranges;
+    auto deletion = Deletion{ChunkRange(BSON(kPattern << 50), BSON(kPattern << 250)), Date_t{}};
+    ranges.emplace_back(std::move(deletion));
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+
+    ASSERT_TRUE(next(rangeDeleter, 150));
+    ASSERT_EQUALS(150ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 300)));
+    ASSERT_EQUALS(50ULL,
+                  dbclient.count(kNss.toString(), BSON(kPattern << GTE << 200 << LT << 250)));
+
+    ASSERT_TRUE(next(rangeDeleter, 150));
+    ASSERT_TRUE(next(rangeDeleter, 150));
+    ASSERT_EQUALS(100ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 300)));
+    ASSERT_EQUALS(50ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 50)));
+    ASSERT_FALSE(next(rangeDeleter, 150));
+}
+
 // Tests the case that there are two ranges to clean, each containing multiple documents.
 TEST_F(CollectionRangeDeleterTest, MultipleDocumentsInMultipleRangesToClean) {
     CollectionRangeDeleter rangeDeleter;
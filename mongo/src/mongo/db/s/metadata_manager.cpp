@@ -38,10 +38,12 @@
 #include "mongo/db/bson/dotted_path_support.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/range_arithmetic.h"
 #include "mongo/db/s/collection_range_deleter.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/fail_point_service.h"
@@ -118,6 +120,10 @@ using CallbackArgs = TaskExecutor::CallbackArgs;
 
 MONGO_FP_DECLARE(suspendRangeDeletion);
 
+// Maximum number of orphaned documents removed by each scheduled pass of the range deleter. A value
+// of 0 falls back to internalQueryExecYieldIterations.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 0);
+
 /**
  * Deletes ranges, in background, until done, normally using a task executor attached to the
  * ShardingState.
@@ -136,7 +142,10 @@ void scheduleCleanup(executor::TaskExecutor* executor,
             auto uniqueOpCtx = Client::getCurrent()->makeOperationContext();
             auto opCtx = uniqueOpCtx.get();
 
-            const int maxToDelete = std::max(int(internalQueryExecYieldIterations.load()), 1);
+            const int batchSize = rangeDeleterBatchSize.load() > 0
+                ? rangeDeleterBatchSize.load()
+                : int(internalQueryExecYieldIterations.load());
+            const int maxToDelete = std::max(batchSize, 1);
 
             MONGO_FAIL_POINT_PAUSE_WHILE_SET(suspendRangeDeletion);
 
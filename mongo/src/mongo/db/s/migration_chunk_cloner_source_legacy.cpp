@@ -291,7 +291,7 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
 
         stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-        const std::size_t cloneLocsRemaining = _cloneLocs.size();
+        const std::size_t cloneLocsRemaining = _cloneLocs.size() + _numCloneLocsInFlight;
 
         log() << "moveChunk data transfer progress: " << redact(res) << " mem used: " << _memoryUsed
               << " documents remaining to clone: " << cloneLocsRemaining;
@@ -475,7 +475,7 @@ uint64_t MigrationChunkClonerSourceLegacy::getCloneBatchBufferAllocationSize() {
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     return std::min(static_cast<uint64_t>(BSONObjMaxUserSize),
-                    _averageObjectSizeForCloneLocs * _cloneLocs.size());
+                    _averageObjectSizeForCloneLocs * (_cloneLocs.size() + _numCloneLocsInFlight));
 }
 
 Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
@@ -487,35 +487,75 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
                            internalQueryExecYieldIterations.load(),
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
-    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    // We must always make progress in this method by at least one document because empty return
+    // indicates there is no more initial clone data. The record ids of deleted documents stay in
+    // _cloneLocs, so keep taking more until a document is found or none are left.
+    while (!arrBuilder->arrSize()) {
+        // Take the record ids of about as many documents as fit in the rest of the batch, so that
+        // concurrent calls fetch different documents without holding the mutex while they do so.
+        std::vector<RecordId> locs;
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+            // Another call may yet put back the record ids it took out, so the clone is only over
+            // once that call has returned.
+            opCtx->waitForConditionOrInterrupt(_cloneLocsInFlightCV, lk, [this] {
+                return !_cloneLocs.empty() || !_numCloneLocsInFlight;
+            });
+            if (_cloneLocs.empty()) {
+                break;
+            }
 
-    std::set<RecordId>::iterator it;
+            const uint64_t bytesLeft =
+                BSONObjMaxUserSize - std::min(arrBuilder->len(), BSONObjMaxUserSize);
+            const uint64_t numLocs = 1 +
+                bytesLeft / std::max(_averageObjectSizeForCloneLocs, static_cast<uint64_t>(1));
 
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
-        // We must always make progress in this method by at least one document because empty return
-        // indicates there is no more initial clone data.
-        if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
-            break;
+            auto it = _cloneLocs.begin();
+            for (; it != _cloneLocs.end() && locs.size() < numLocs; ++it) {
+                locs.push_back(*it);
+            }
+
+            _cloneLocs.erase(_cloneLocs.begin(), it);
+            _numCloneLocsInFlight += locs.size();
         }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(opCtx, *it, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so that we
-            // take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+        auto it = locs.begin();
+
+        for (; it != locs.end(); ++it) {
+            if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
                 break;
             }
 
-            arrBuilder->append(doc.value());
+            Snapshotted<BSONObj> doc;
+            if (collection->findDoc(opCtx, *it, &doc)) {
+                // Use the builder size instead of accumulating the document sizes directly so that
+                // we take into consideration the overhead of BSONArray indices.
+                if (arrBuilder->arrSize() &&
+                    (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+                    break;
+                }
+
+                arrBuilder->append(doc.value());
+            }
         }
+
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
+
+        // Put back the record ids of the documents which did not make it into this batch. Deletions
+        // do not remove them from _cloneLocs while they are taken out, but a deleted document is
+        // simply not found later: storage engines without document-level locking cannot delete
+        // while the caller holds the collection lock, and the others never reuse a record id.
+        _cloneLocs.insert(it, locs.end());
+        _numCloneLocsInFlight -= locs.size();
+        _cloneLocsInFlightCV.notify_all();
     }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     // If we have drained all the cloned data, there is no need to keep the delete notify executor
     // around
-    if (_cloneLocs.empty() && _deleteNotifyExec) {
+    if (_cloneLocs.empty() && !_numCloneLocsInFlight && _deleteNotifyExec) {
         // We have a different OperationContext than when we created the PlanExecutor, so need to
         // manually destroy it ourselves.
         _deleteNotifyExec->dispose(opCtx, collection->getCursorManager());
@@ -41,6 +41,7 @@
 #include "mongo/db/s/session_catalog_migration_source.h"
 #include "mongo/s/move_chunk_request.h"
 #include "mongo/s/shard_key_pattern.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
@@ -117,6 +118,9 @@ public:
      * give a chance to the caller to perform some form of yielding. It does not free or acquire any
      * locks on its own.
      *
+     * May be called concurrently by several clone streams of the recipient. Each call takes its own
+     * set of record ids, so the streams fetch different documents in parallel.
+     *
      * NOTE: Must be called with the collection lock held in at least IS mode.
      */
     Status nextCloneBatch(OperationContext* opCtx,
@@ -218,6 +222,13 @@ private:
     // List of record ids that needs to be transferred (initial clone)
     std::set<RecordId> _cloneLocs;
 
+    // Number of record ids taken out of _cloneLocs by nextCloneBatch calls which have not yet
+    // returned (initial clone)
+    uint64_t _numCloneLocsInFlight{0};
+
+    // Signalled whenever a nextCloneBatch call puts back the record ids it took out
+    stdx::condition_variable _cloneLocsInFlightCV;
+
     // The estimated average object size during the clone phase. Used for buffer size
     // pre-allocation (initial clone).
     uint64_t _averageObjectSizeForCloneLocs{0};
@@ -132,7 +132,8 @@ protected:
      * Shortcut to create BSON represenation of a moveChunk request for the specified range with
      * fixed kDonorConnStr and kRecipientConnStr, respectively.
      */
-    static MoveChunkRequest createMoveChunkRequest(const ChunkRange& chunkRange) {
+    static MoveChunkRequest createMoveChunkRequest(const ChunkRange& chunkRange,
+                                                   int64_t maxChunkSizeBytes = 1024 * 1024) {
         BSONObjBuilder cmdBuilder;
         MoveChunkRequest::appendAsCommand(
             &cmdBuilder,
@@ -142,7 +143,7 @@ protected:
             kDonorConnStr.getSetName(),
             kRecipientConnStr.getSetName(),
             chunkRange,
-            1024 * 1024,
+            maxChunkSizeBytes,
             MigrationSecondaryThrottleOptions::create(MigrationSecondaryThrottleOptions::kDefault),
             false);
 
@@ -294,6 +295,130 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
     futureCommit.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationChunkClonerSourceLegacyTest, DocumentsWhichDoNotFitInBatchAreFetchedLater) {
+    createShardedCollection({});
+
+    // Documents outside of the chunk range keep the average document size small enough for the
+    // chunk not to count as too big
+    for (int i = 0; i < 200; ++i) {
+        client()->insert(kNss.ns(), createCollectionDocument(i - 200));
+    }
+
+    // Only five of these fit in a batch
+    const std::string padding(3 * 1024 * 1024, 'x');
+    for (int i = 100; i < 108; ++i) {
+        client()->insert(kNss.ns(), BSON("_id" << i << "X" << i << "padding" << padding));
+    }
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+
+    {
+        auto futureStartClone = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+        });
+
+        ASSERT_OK(cloner.startClone(operationContext()));
+        futureStartClone.timed_get(kFutureTimeout);
+    }
+
+    {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IS);
+
+        std::set<int> clonedIds;
+        int numBatches = 0;
+        while (true) {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(
+                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            if (!arrBuilder.arrSize()) {
+                break;
+            }
+
+            ASSERT_LTE(arrBuilder.arrSize(), 5);
+            ++numBatches;
+
+            for (const auto& elem : arrBuilder.arr()) {
+                ASSERT(clonedIds.insert(elem.Obj()["_id"].numberInt()).second);
+            }
+        }
+
+        ASSERT_GTE(numBatches, 2);
+        ASSERT_EQ(8U, clonedIds.size());
+    }
+
+    auto futureCancel = launchAsync([&]() {
+        onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+    });
+
+    cloner.cancelClone(operationContext());
+    futureCancel.timed_get(kFutureTimeout);
+}
+
+TEST_F(MigrationChunkClonerSourceLegacyTest, DeletedDocumentsDoNotEndTheCloneEarly) {
+    createShardedCollection({});
+
+    // About 64 record ids are taken for a batch of these
+    const std::string padding(256 * 1024, 'x');
+    for (int i = 100; i < 200; ++i) {
+        client()->insert(kNss.ns(), BSON("_id" << i << "X" << i << "padding" << padding));
+    }
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200)), 64 * 1024 * 1024),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+
+    {
+        auto futureStartClone = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+        });
+
+        ASSERT_OK(cloner.startClone(operationContext()));
+        futureStartClone.timed_get(kFutureTimeout);
+    }
+
+    // The record ids of these stay in the clone set, so the first ones taken find no documents
+    client()->remove(kNss.ns(), BSON("X" << BSON("$lt" << 180)));
+
+    {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IS);
+
+        std::set<int> clonedIds;
+        int numBatches = 0;
+        while (true) {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(
+                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            if (!arrBuilder.arrSize()) {
+                break;
+            }
+
+            ++numBatches;
+
+            for (const auto& elem : arrBuilder.arr()) {
+                ASSERT(clonedIds.insert(elem.Obj()["_id"].numberInt()).second);
+            }
+        }
+
+        ASSERT_EQ(1, numBatches);
+        ASSERT_EQ(20U, clonedIds.size());
+        ASSERT_EQ(180, *clonedIds.begin());
+        ASSERT_EQ(199, *clonedIds.rbegin());
+    }
+
+    auto futureCancel = launchAsync([&]() {
+        onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+    });
+
+    cloner.cancelClone(operationContext());
+    futureCancel.timed_get(kFutureTimeout);
+}
+
 TEST_F(MigrationChunkClonerSourceLegacyTest, CollectionNotFound) {
     MigrationChunkClonerSourceLegacy cloner(
         createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
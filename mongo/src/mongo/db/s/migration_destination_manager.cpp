@@ -32,6 +32,7 @@
 
 #include "mongo/db/s/migration_destination_manager.h"
 
+#include <deque>
 #include <list>
 #include <vector>
 
@@ -43,11 +44,14 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/ops/delete.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_metadata.h"
@@ -56,6 +60,7 @@
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/move_timing_helper.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/client/shard_registry.h"
@@ -66,6 +71,7 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -74,6 +80,13 @@ using str::stream;
 
 namespace {
 
+// The number of streams which fetch the documents of a chunk from the donor at the same time
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneFetchStreams, int, 2);
+
+// The rate in bytes per second above which the initial clone of a chunk is slowed down. A value of
+// 0 leaves it unthrottled.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneMaxBytesPerSec, int, 0);
+
 const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 // Note: Even though we're setting UNSET here,
                                                 // kMajority implies JOURNAL if journaling is
@@ -207,6 +220,136 @@ BSONObj createTransferModsRequest(const NamespaceString& nss, const MigrationSes
     return builder.obj();
 }
 
+/**
+ * Hands the batches fetched by the clone streams of a migration to the thread which inserts them.
+ * Holds at most one batch per stream, so that the streams wait for the inserts to catch up instead
+ * of buffering the chunk in memory.
+ */
+class CloneBatchQueue {
+    MONGO_DISALLOW_COPYING(CloneBatchQueue);
+
+public:
+    explicit CloneBatchQueue(int numStreams) : _maxSize(numStreams), _numStreams(numStreams) {}
+
+    /**
+     * Waits for room and queues 'batch'. Returns false, dropping the batch, if the queue has been
+     * closed.
+     */
+    bool push(BSONObj batch) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _closed || _batches.size() < _maxSize; });
+        if (_closed) {
+            return false;
+        }
+
+        _batches.push_back(std::move(batch));
+        _cv.notify_all();
+        return true;
+    }
+
+    /**
+     * Called by each stream when it stops, with the error which stopped it, if any.
+     */
+    void streamDone(Status status) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_status.isOK()) {
+            _status = std::move(status);
+        }
+        --_numStreams;
+        _cv.notify_all();
+    }
+
+    /**
+     * Waits up to 'maxWait' for the next batch and moves it into 'batch'. Returns false if there
+     * was none, in which case isExhausted() tells whether there will be no more. Throws the error
+     * of a stream which failed.
+     */
+    bool pop(OperationContext* opCtx, Milliseconds maxWait, BSONObj* batch) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        opCtx->waitForConditionOrInterruptFor(_cv, lk, maxWait, [&] {
+            return !_status.isOK() || !_batches.empty() || !_numStreams;
+        });
+        uassertStatusOK(_status);
+
+        if (_batches.empty()) {
+            return false;
+        }
+
+        *batch = std::move(_batches.front());
+        _batches.pop_front();
+        _cv.notify_all();
+        return true;
+    }
+
+    bool isExhausted() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _batches.empty() && !_numStreams;
+    }
+
+    /**
+     * Makes the streams stop at their next push.
+     */
+    void close() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _closed = true;
+        _cv.notify_all();
+    }
+
+private:
+    const size_t _maxSize;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+
+    std::deque<BSONObj> _batches;
+
+    // Number of streams still fetching
+    int _numStreams;
+
+    // The first error reported by a stream
+    Status _status = Status::OK();
+
+    bool _closed = false;
+};
+
+/**
+ * Body of a clone stream. Keeps asking the donor for batches of documents with _migrateClone and
+ * queueing them until the donor has no documents left to hand out.
+ */
+void fetchCloneBatches(const ConnectionString& fromShardConnString,
+                       const BSONObj& migrateCloneRequest,
+                       CloneBatchQueue* batches) {
+    Client::initThread("migrateCloneFetcher");
+
+    try {
+        ScopedDbConnection conn(fromShardConnString);
+
+        while (true) {
+            BSONObj res;
+            if (!conn->runCommand("admin",
+                                  migrateCloneRequest,
+                                  res)) {  // gets array of objects to copy, in disk order
+                conn.done();
+                batches->streamDone({ErrorCodes::OperationFailed,
+                                     str::stream() << "_migrateClone failed: "
+                                                   << redact(res.toString())});
+                return;
+            }
+
+            if (res["objects"].Obj().isEmpty() || !batches->push(res)) {
+                break;
+            }
+        }
+
+        conn.done();
+    } catch (const DBException& ex) {
+        batches->streamDone(ex.toStatus());
+        return;
+    }
+
+    batches->streamDone(Status::OK());
+}
+
 // Enabling / disabling these fail points pauses / resumes MigrateStatus::_go(), the thread which
 // receives a chunk migration from the donor.
 MONGO_FP_DECLARE(migrateThreadHangAtStep1);
@@ -734,79 +877,50 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
 
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
-        while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                setStateFail(str::stream() << "_migrateClone failed: " << redact(res.toString()));
-                conn.done();
-                return;
-            }
-
-            BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
+        // Several streams fetch batches from the donor, which hands each of them different
+        // documents, while this thread inserts the batches they have fetched.
+        const int numFetchStreams = std::max(1, migrateCloneFetchStreams.load());
+        CloneBatchQueue batches(numFetchStreams);
 
-            BSONObjIterator i(arr);
-            while (i.more()) {
-                opCtx->checkForInterrupt();
+        std::vector<stdx::thread> fetchThreads;
+        ON_BLOCK_EXIT([&] {
+            batches.close();
+            for (auto& fetchThread : fetchThreads) {
+                fetchThread.join();
+            }
+        });
 
-                if (getState() == ABORT) {
-                    log() << "Migration aborted while copying documents";
-                    return;
-                }
+        for (int i = 0; i < numFetchStreams; ++i) {
+            fetchThreads.emplace_back([&] {
+                fetchCloneBatches(fromShardConnString, migrateCloneRequest, &batches);
+            });
+        }
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(opCtx, _nss.ns());
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(opCtx,
-                                            _nss,
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            docToClone,
-                                            &localDoc)) {
-                        string errMsg = str::stream() << "cannot migrate chunk, local document "
-                                                      << redact(localDoc)
-                                                      << " has same _id as cloned "
-                                                      << "remote document " << redact(docToClone);
-
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
+        const Timer cloneTimer;
 
-                    Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
-                }
-                thisTime++;
-
-                {
-                    stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
-                }
+        while (true) {
+            if (getState() == ABORT) {
+                log() << "Migration aborted while copying documents";
+                return;
+            }
 
-                if (writeConcern.shouldWaitForOtherNodes()) {
-                    repl::ReplicationCoordinator::StatusAndDuration replStatus =
-                        repl::getGlobalReplicationCoordinator()->awaitReplication(
-                            opCtx,
-                            repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp(),
-                            writeConcern);
-                    if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
-                        warning() << "secondaryThrottle on, but doc insert timed out; "
-                                     "continuing";
-                    } else {
-                        massertStatusOK(replStatus.status);
-                    }
+            BSONObj res;
+            if (!batches.pop(opCtx, Seconds(1), &res)) {
+                if (batches.isExhausted()) {
+                    break;
                 }
+                continue;
             }
 
-            if (thisTime == 0)
-                break;
+            if (!_insertClonedBatch(opCtx,
+                                    res["objects"].Obj(),
+                                    min,
+                                    max,
+                                    shardKeyPattern,
+                                    writeConcern,
+                                    cloneTimer)) {
+                return;
+            }
         }
 
         timing.done(3);
@@ -975,6 +1089,119 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
     conn.done();
 }
 
+bool MigrationDestinationManager::_insertClonedBatch(OperationContext* opCtx,
+                                                     const BSONObj& arr,
+                                                     const BSONObj& min,
+                                                     const BSONObj& max,
+                                                     const BSONObj& shardKeyPattern,
+                                                     const WriteConcernOptions& writeConcern,
+                                                     const Timer& cloneTimer) {
+    BSONObjIterator i(arr);
+    while (i.more()) {
+        opCtx->checkForInterrupt();
+
+        if (getState() == ABORT) {
+            log() << "Migration aborted while copying documents";
+            return false;
+        }
+
+        const size_t maxGroupSize = std::max(1, internalInsertMaxBatchSize.load());
+        std::vector<InsertStatement> inserts;
+        long long insertedBytes = 0;
+        while (i.more() && inserts.size() < maxGroupSize) {
+            BSONObj docToClone = i.next().Obj();
+            insertedBytes += docToClone.objsize();
+            inserts.emplace_back(docToClone);
+        }
+
+        {
+            OldClientWriteContext cx(opCtx, _nss.ns());
+
+            for (const auto& insert : inserts) {
+                BSONObj localDoc;
+                if (willOverrideLocalId(opCtx,
+                                        _nss,
+                                        min,
+                                        max,
+                                        shardKeyPattern,
+                                        cx.db(),
+                                        insert.doc,
+                                        &localDoc)) {
+                    string errMsg = str::stream() << "cannot migrate chunk, local document "
+                                                  << redact(localDoc)
+                                                  << " has same _id as cloned "
+                                                  << "remote document " << redact(insert.doc);
+
+                    warning() << errMsg;
+
+                    // Exception will abort migration cleanly
+                    uasserted(16976, errMsg);
+                }
+            }
+
+            // Insert the group in a single write unit of work. If that fails, for instance because
+            // one of the documents is already in the range, fall back to upserting them one by one.
+            Status status(ErrorCodes::NamespaceNotFound, "collection dropped during migration");
+            if (Collection* const collection = cx.getCollection()) {
+                status = writeConflictRetry(opCtx, "migrateClone", _nss.ns(), [&] {
+                    WriteUnitOfWork wuow(opCtx);
+                    Status insertStatus = collection->insertDocuments(opCtx,
+                                                                      inserts.begin(),
+                                                                      inserts.end(),
+                                                                      nullptr,
+                                                                      false /* enforceQuota */,
+                                                                      true /* fromMigrate */);
+                    if (insertStatus.isOK()) {
+                        wuow.commit();
+                    }
+                    return insertStatus;
+                });
+            }
+
+            if (!status.isOK()) {
+                for (const auto& insert : inserts) {
+                    Helpers::upsert(opCtx, _nss.ns(), insert.doc, true);
+                }
+            }
+        }
+
+        long long clonedBytes;
+        {
+            stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+            _numCloned += inserts.size();
+            _clonedBytes += insertedBytes;
+            clonedBytes = _clonedBytes;
+        }
+
+        if (writeConcern.shouldWaitForOtherNodes()) {
+            repl::ReplicationCoordinator::StatusAndDuration replStatus =
+                repl::getGlobalReplicationCoordinator()->awaitReplication(
+                    opCtx,
+                    repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp(),
+                    writeConcern);
+            if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
+                warning() << "secondaryThrottle on, but doc insert timed out; "
+                             "continuing";
+            } else {
+                massertStatusOK(replStatus.status);
+            }
+        }
+
+        // The limit is read for every group, so that it can be raised or lowered while the
+        // migration runs.
+        const long long maxBytesPerSec = migrateCloneMaxBytesPerSec.load();
+        if (maxBytesPerSec > 0) {
+            const Milliseconds minElapsed(clonedBytes * 1000 / maxBytesPerSec);
+            const Milliseconds elapsed(cloneTimer.millis());
+            if (minElapsed > elapsed) {
+                opCtx->sleepFor(minElapsed - elapsed);
+            }
+        }
+    }
+
+    return true;
+}
+
 //MigrationDestinationManager::_migrateDriver
 bool MigrationDestinationManager::_applyMigrateOp(OperationContext* opCtx,
                                                   const NamespaceString& nss,
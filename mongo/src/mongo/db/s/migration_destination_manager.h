@@ -148,6 +148,21 @@ private:
                         const OID& epoch,
                         const WriteConcernOptions& writeConcern);
 
+    /**
+     * Inserts a batch of documents cloned from the donor, a group of documents per write unit of
+     * work, and waits for 'writeConcern' after each group. Slows down as needed to keep the clone
+     * under migrateCloneMaxBytesPerSec since 'cloneTimer' was started.
+     *
+     * Returns false if the migration was aborted.
+     */
+    bool _insertClonedBatch(OperationContext* opCtx,
+                            const BSONObj& arr,
+                            const BSONObj& min,
+                            const BSONObj& max,
+                            const BSONObj& shardKeyPattern,
+                            const WriteConcernOptions& writeConcern,
+                            const Timer& cloneTimer);
+
     bool _applyMigrateOp(OperationContext* opCtx,
                          const NamespaceString& ns,
                          const BSONObj& min,
@@ -49,6 +49,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <snappy.h>
+#include <third_party/murmurhash3/MurmurHash3.h>
 #include <vector>
 
 #include "mongo/base/string_data.h"
@@ -102,6 +103,13 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+/** Returns the checksum stored ahead of each block of a spill file, covering its bytes on disk. */
+inline uint32_t blockChecksum(const char* data, size_t size) {
+    uint32_t checksum;
+    MurmurHash3_x86_32(data, size, 0, &checksum);
+    return checksum;
+}
+
 /** Ensures a named file is deleted when this object goes out of scope */
 class FileDeleter {
 public:
@@ -204,10 +212,18 @@ private:
         const bool compressed = rawSize < 0;
         int32_t blockSize = std::abs(rawSize);
 
+        uint32_t checksum;
+        read(&checksum, sizeof(checksum));
+        massert(16816, "file too short?", !_done);
+
         _buffer.reset(new char[blockSize]);
         read(_buffer.get(), blockSize);
         massert(16816, "file too short?", !_done);
 
+        massert(50780,
+                str::stream() << "checksum mismatch in sort file \"" << _fileName << "\"",
+                blockChecksum(_buffer.get(), blockSize) == checksum);
+
         auto encryptionHooks = EncryptionHooks::get(getGlobalServiceContext());
         if (encryptionHooks->enabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
@@ -282,39 +298,44 @@ public:
     typedef SortIteratorInterface<Key, Value> Input;
     typedef std::pair<Key, Value> Data;
 
-
+    /**
+     * Merges the inputs with a loser tree: a tournament whose internal nodes remember the loser of
+     * the match played there, while the overall winner sits above the root. Replacing the winner
+     * only replays the matches on the path from its leaf to the root, which takes a single
+     * comparison per level rather than the two a binary heap needs to sift an element down.
+     */
     MergeIterator(const std::vector<std::shared_ptr<Input>>& iters,
                   const SortOptions& opts,
                   const Comparator& comp)
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _comp(comp) {
+        _streams.reserve(iters.size());
         for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.emplace_back(iters[i]->next(), iters[i]);
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _liveStreams = _streams.size();
+        _tree.resize(_streams.size());
+        _tree[0] = _playMatches(1);
     }
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _liveStreams > 1 || _streams[_tree[0]].more()))
             return true;
 
         // We are done so clean up resources.
         // Can't do this in next() due to lifetime guarantees of unowned Data.
-        _heap.clear();
-        _current.reset();
+        _streams.clear();
+        _tree.clear();
         _remaining = 0;
 
         return false;
@@ -327,76 +348,106 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_tree[0]].current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
+        size_t winner = _tree[0];
+        if (!_streams[winner].advance()) {
+            verify(_liveStreams > 1);
+            _liveStreams--;
+        }
 
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        // Replay the matches the previous winner took part in, from its leaf up to the root.
+        for (size_t node = (winner + _streams.size()) / 2; node > 0; node /= 2) {
+            if (_less(_tree[node], winner)) {
+                std::swap(_tree[node], winner);
+            }
         }
+        _tree[0] = winner;
 
-        return _current->current();
+        return _streams[winner].current();
     }
 
-
 private:
     class Stream {  // Data + Iterator
     public:
-        Stream(size_t fileNum, const Data& first, std::shared_ptr<Input> rest)
-            : fileNum(fileNum), _current(first), _rest(rest) {}
+        Stream(const Data& first, std::shared_ptr<Input> rest)
+            : _current(first), _rest(std::move(rest)) {}
 
         const Data& current() const {
             return _current;
         }
+        bool exhausted() const {
+            return _exhausted;
+        }
         bool more() {
-            return _rest->more();
+            return !_exhausted && _rest->more();
         }
         bool advance() {
-            if (!_rest->more())
+            if (!more()) {
+                _exhausted = true;
                 return false;
+            }
 
             _current = _rest->next();
             return true;
         }
 
-        const size_t fileNum;
-
     private:
         Data _current;
         std::shared_ptr<Input> _rest;
+        bool _exhausted = false;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
+    /**
+     * Returns whether stream 'lhs' must be returned before stream 'rhs'. Exhausted streams sort
+     * after all others, and equal data is returned in the order of the inputs for stability.
+     */
+    bool _less(size_t lhs, size_t rhs) const {
+        const Stream& left = _streams[lhs];
+        const Stream& right = _streams[rhs];
+        if (left.exhausted() || right.exhausted()) {
+            return !left.exhausted() || (right.exhausted() && lhs < rhs);
+        }
+
+        dassertCompIsSane(_comp, left.current(), right.current());
+        int ret = _comp(left.current(), right.current());
+        if (ret)
+            return ret < 0;
 
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+        return lhs < rhs;
+    }
+
+    /**
+     * Plays the tournament below 'node', recording the loser of every match in '_tree', and
+     * returns the stream that wins it. Nodes [1, n) are internal and nodes [n, 2n) are the leaves
+     * for the n streams.
+     */
+    size_t _playMatches(size_t node) {
+        if (node >= _streams.size()) {
+            return node - _streams.size();
         }
 
-    private:
-        const Comparator _comp;
-    };
+        const size_t left = _playMatches(2 * node);
+        const size_t right = _playMatches(2 * node + 1);
+        if (_less(left, right)) {
+            _tree[node] = right;
+            return left;
+        }
+        _tree[node] = left;
+        return right;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    const Comparator _comp;
+    std::vector<Stream> _streams;
+    size_t _liveStreams = 0;  // streams whose current data has not all been returned
+
+    // _tree[0] is the stream whose data next() returns. _tree[i] for i > 0 is the loser of the
+    // match played at internal node i.
+    std::vector<size_t> _tree;
 };
 
 //IndexAccessMethod::BulkBuilder::BulkBuilder->Sorter<Key, Value>::makeйʹ
@@ -903,10 +954,13 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
+    const uint32_t checksum = sorter::blockChecksum(outBuffer, size);
+
     // negative size means compressed
     size = shouldCompress ? -size : size;
     try {
         _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
         _file.write(outBuffer, std::abs(size));
 
     } catch (const std::exception&) {
@@ -31,6 +31,7 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem.hpp>
+#include <fstream>
 
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/init.h"
@@ -276,6 +277,33 @@ public:
     }
 };
 
+class FileIteratorDetectsCorruptionTests {
+public:
+    void run() {
+        unittest::TempDir tempDir("fileIteratorCorruptionTests");
+        const SortOptions opts = SortOptions().TempDir(tempDir.path());
+
+        SortedFileWriter<IntWrapper, IntWrapper> writer(opts);
+        for (int i = 0; i < 1000; i++)
+            writer.addAlreadySorted(i, -i);
+        std::shared_ptr<IWIterator> iter(writer.done());
+
+        // Flip a byte of the first block, past its size and checksum.
+        boost::filesystem::directory_iterator file(tempDir.path());
+        ASSERT(file != boost::filesystem::directory_iterator());
+        {
+            std::fstream stream(file->path().string(),
+                                std::ios::in | std::ios::out | std::ios::binary);
+            stream.seekg(16);
+            char byte = stream.get();
+            stream.seekp(16);
+            stream.put(byte ^ 0x5a);
+        }
+
+        ASSERT_THROWS_CODE(iter->more(), AssertionException, 50780);
+    }
+};
+
 
 class MergeIteratorTests {
 public:
@@ -319,6 +347,27 @@ public:
             ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, DESC),
                                         make_shared<IntIterator>(30, 0, -1));
         }
+        {  // test more inputs than fit a complete tournament, with duplicates across inputs
+            std::shared_ptr<IWIterator> iterators[] = {make_shared<IntIterator>(0, 70, 7),
+                                                       make_shared<IntIterator>(1, 70, 7),
+                                                       make_shared<IntIterator>(2, 70, 7),
+                                                       make_shared<IntIterator>(3, 70, 7),
+                                                       make_shared<IntIterator>(4, 70, 7),
+                                                       make_shared<EmptyIterator>(),
+                                                       make_shared<IntIterator>(5, 70, 7),
+                                                       make_shared<IntIterator>(6, 70, 7),
+                                                       make_shared<IntIterator>(0, 70, 7)};
+
+            std::vector<IWPair> expected;
+            for (int i = 0; i < 70; i++) {
+                expected.push_back(IWPair(i, -i));
+                if (i % 7 == 0)
+                    expected.push_back(IWPair(i, -i));
+            }
+            std::shared_ptr<IWIterator> expectedIter =
+                make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(expected);
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC), expectedIter);
+        }
         {  // test Limit
             std::shared_ptr<IWIterator> iterators[] = {
                 make_shared<IntIterator>(1, 20, 2)  // 1, 3, ... 19
@@ -550,6 +599,7 @@ public:
     void setupTests() {
         add<InMemIterTests>();
         add<SortedFileWriterAndFileIteratorTests>();
+        add<FileIteratorDetectsCorruptionTests>();
         add<MergeIteratorTests>();
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
@@ -274,6 +274,71 @@ TEST_F(CursorManagerTest, ShouldNotBeAbleToKillPinnedCursor) {
               ErrorCodes::OperationFailed);
 }
 
+/**
+ * Test that a cursor returns the results read ahead for it, including one put back because it did
+ * not fit in a batch, before it runs its executor.
+ */
+TEST_F(CursorManagerTest, CursorReturnsPrefetchedResultsBeforeRunningItsExecutor) {
+    auto workingSet = stdx::make_unique<WorkingSet>();
+    auto queuedDataStage = stdx::make_unique<QueuedDataStage>(_opCtx.get(), workingSet.get());
+    auto id = workingSet->allocate();
+    workingSet->get(id)->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("_id" << 3));
+    workingSet->transitionToOwnedObj(id);
+    queuedDataStage->pushBack(id);
+    auto exec = unittest::assertGet(PlanExecutor::make(_opCtx.get(),
+                                                       std::move(workingSet),
+                                                       std::move(queuedDataStage),
+                                                       kTestNss,
+                                                       PlanExecutor::YieldPolicy::NO_YIELD));
+
+    auto cursorPin = useCursorManager()->registerCursor(
+        _opCtx.get(), {std::move(exec), kTestNss, {}, false, BSONObj()});
+    auto cursor = cursorPin.getCursor();
+
+    const auto bytesBefore = ClientCursor::totalPrefetchedBytes();
+    cursor->appendPrefetched(BSON("_id" << 1));
+    cursor->appendPrefetched(BSON("_id" << 2));
+    ASSERT_TRUE(cursor->hasPrefetchedResults());
+    ASSERT_EQ(2U, cursor->numPrefetched());
+    ASSERT_EQ(bytesBefore + cursor->prefetchedBytes(), ClientCursor::totalPrefetchedBytes());
+
+    BSONObj obj;
+    ASSERT_EQ(PlanExecutor::ADVANCED, cursor->getNext(&obj));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), obj);
+    cursor->stashNext(obj);
+
+    for (int i = 1; i <= 3; ++i) {
+        ASSERT_EQ(PlanExecutor::ADVANCED, cursor->getNext(&obj));
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i), obj);
+    }
+    ASSERT_EQ(PlanExecutor::IS_EOF, cursor->getNext(&obj));
+
+    ASSERT_FALSE(cursor->hasPrefetchedResults());
+    ASSERT_EQ(bytesBefore, ClientCursor::totalPrefetchedBytes());
+}
+
+/**
+ * Test that the error which stopped a read-ahead is returned after the results read before it.
+ */
+TEST_F(CursorManagerTest, CursorReturnsPrefetchErrorAfterPrefetchedResults) {
+    auto cursorPin = makeCursor(_opCtx.get());
+    auto cursor = cursorPin.getCursor();
+
+    cursor->appendPrefetched(BSON("_id" << 1));
+    cursor->setPrefetchError(PlanExecutor::FAILURE,
+                             WorkingSetCommon::buildMemberStatusObject(
+                                 {ErrorCodes::OperationFailed, "read-ahead failed"}));
+
+    BSONObj obj;
+    ASSERT_EQ(PlanExecutor::ADVANCED, cursor->getNext(&obj));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), obj);
+    ASSERT_EQ(PlanExecutor::FAILURE, cursor->getNext(&obj));
+    ASSERT_EQ(ErrorCodes::OperationFailed, WorkingSetCommon::getMemberObjectStatus(obj));
+
+    ASSERT_FALSE(cursor->hasPrefetchedResults());
+    ASSERT_EQ(PlanExecutor::IS_EOF, cursor->getNext(&obj));
+}
+
 /**
  * Test that client cursors time out and get deleted.
  */
@@ -35,6 +35,7 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/catalog/index_create_impl.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
@@ -42,6 +43,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/scopeguard.h"
 
 namespace IndexUpdateTests {
 
@@ -270,6 +272,125 @@ public:
     }
 };
 
+/** A foreground index build that generates keys on several threads indexes every document. */
+class InsertBuildInParallel : public IndexBuildBase {
+public:
+    void run() {
+        const int oldMaxThreads = maxIndexBuildThreads.load();
+        ON_BLOCK_EXIT([oldMaxThreads] { maxIndexBuildThreads.store(oldMaxThreads); });
+        maxIndexBuildThreads.store(4);
+
+        const int numDocs = 5000;
+        Database* db = _ctx.db();
+        Collection* coll;
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            db->dropCollection(&_opCtx, _ns).transitional_ignore();
+            coll = db->createCollection(&_opCtx, _ns);
+
+            OpDebug* const nullOpDebug = nullptr;
+            for (int i = 0; i < numDocs; ++i) {
+                // Every tenth document generates a second key far above all the others.
+                BSONObj doc = i % 10 ? BSON("_id" << i << "a" << i)
+                                     : BSON("_id" << i << "a" << BSON_ARRAY(i << numDocs + i));
+                ASSERT_OK(coll->insertDocument(&_opCtx, InsertStatement(doc), nullOpDebug, true));
+            }
+            wunit.commit();
+        }
+
+        MultiIndexBlock indexer(&_opCtx, coll);
+        const BSONObj spec = BSON("name"
+                                  << "a_1"
+                                  << "ns"
+                                  << coll->ns().ns()
+                                  << "key"
+                                  << BSON("a" << 1)
+                                  << "v"
+                                  << static_cast<int>(kIndexVersion));
+        ASSERT_OK(indexer.init(spec).getStatus());
+        ASSERT_OK(indexer.insertAllDocumentsInCollection());
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer.commit();
+            wunit.commit();
+        }
+
+        auto descriptor = coll->getIndexCatalog()->findIndexByName(&_opCtx, "a_1");
+        ASSERT(descriptor);
+        ASSERT(descriptor->isMultikey(&_opCtx));
+
+        auto countKeysFrom = [&](int min) {
+            auto cursor = _client.query(
+                _ns, Query(BSON("a" << BSON("$gte" << min))).hint(BSON("a" << 1)));
+            return cursor->itcount();
+        };
+        ASSERT_EQUALS(numDocs, countKeysFrom(0));
+        ASSERT_EQUALS(numDocs / 10, countKeysFrom(numDocs));
+    }
+};
+
+/** A v:2 index build sorts its keys as KeyStrings and decodes them back to their original types. */
+class InsertBuildRestoresKeyTypes : public IndexBuildBase {
+public:
+    void run() {
+        Database* db = _ctx.db();
+        Collection* coll;
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            db->dropCollection(&_opCtx, _ns).transitional_ignore();
+            coll = db->createCollection(&_opCtx, _ns);
+
+            OpDebug* const nullOpDebug = nullptr;
+            const std::vector<BSONObj> docs = {BSON("_id" << 0 << "a" << 2LL),
+                                               BSON("_id" << 1 << "a"
+                                                          << "str"),
+                                               BSON("_id" << 2 << "a" << 1),
+                                               BSON("_id" << 3 << "a" << -3.0),
+                                               BSON("_id" << 4 << "a" << 1.5)};
+            for (const auto& doc : docs) {
+                ASSERT_OK(coll->insertDocument(&_opCtx, InsertStatement(doc), nullOpDebug, true));
+            }
+            wunit.commit();
+        }
+
+        MultiIndexBlock indexer(&_opCtx, coll);
+        const BSONObj spec = BSON("name"
+                                  << "a_-1"
+                                  << "ns"
+                                  << coll->ns().ns()
+                                  << "key"
+                                  << BSON("a" << -1)
+                                  << "v"
+                                  << static_cast<int>(IndexDescriptor::IndexVersion::kV2));
+        ASSERT_OK(indexer.init(spec).getStatus());
+        ASSERT_OK(indexer.insertAllDocumentsInCollection());
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer.commit();
+            wunit.commit();
+        }
+
+        // The projection covers the query, so the values come from the decoded index keys.
+        const BSONObj projection = BSON("_id" << 0 << "a" << 1);
+        auto cursor = _client.query(_ns, Query().hint(BSON("a" << -1)), 0, 0, &projection);
+        const std::vector<BSONType> expectedTypes = {String, NumberLong, NumberDouble, NumberInt,
+                                                     NumberDouble};
+        const std::vector<BSONObj> expected = {BSON("a"
+                                                    << "str"),
+                                               BSON("a" << 2LL),
+                                               BSON("a" << 1.5),
+                                               BSON("a" << 1),
+                                               BSON("a" << -3.0)};
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT(cursor->more());
+            BSONObj next = cursor->next();
+            ASSERT_BSONOBJ_EQ(expected[i], next);
+            ASSERT_EQUALS(expectedTypes[i], next["a"].type());
+        }
+        ASSERT_FALSE(cursor->more());
+    }
+};
+
 /** Index creation is killed if mayInterrupt is true. */
 class InsertBuildIndexInterrupt : public IndexBuildBase {
 public:
@@ -814,6 +935,8 @@ public:
         add<InsertBuildEnforceUnique<false>>();
         add<InsertBuildFillDups<true>>();
         add<InsertBuildFillDups<false>>();
+        add<InsertBuildInParallel>();
+        add<InsertBuildRestoresKeyTypes>();
         add<InsertBuildIndexInterrupt>();
         add<InsertBuildIndexInterruptDisallowed>();
         add<InsertBuildIdIndexInterrupt>();
@@ -44,10 +44,15 @@
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageCollectionScan {
 
@@ -335,6 +340,129 @@ public:
     }
 };
 
+//
+// Filter in parallel once the first batch has been tested, and return the matches in order.
+//
+class QueryStageCollscanFilterInParallel : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        const int oldMaxParallelism = internalQueryExecMaxCollectionScanParallelism.load();
+        const int oldBatchSize = internalQueryExecCollectionScanParallelBatchSize.load();
+        ON_BLOCK_EXIT([oldMaxParallelism, oldBatchSize] {
+            internalQueryExecMaxCollectionScanParallelism.store(oldMaxParallelism);
+            internalQueryExecCollectionScanParallelBatchSize.store(oldBatchSize);
+        });
+        internalQueryExecMaxCollectionScanParallelism.store(4);
+        internalQueryExecCollectionScanParallelBatchSize.store(7);
+
+        // The same matches are found as when filtering serially.
+        BSONObj obj = BSON("foo" << BSON("$mod" << BSON_ARRAY(3 << 0)));
+        ASSERT_EQUALS(17, countResults(CollectionScanParams::FORWARD, obj));
+        ASSERT_EQUALS(17, countResults(CollectionScanParams::BACKWARD, obj));
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        params.tailable = false;
+
+        const CollatorInterface* collator = nullptr;
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, collator));
+        auto statusWithMatcher =
+            MatchExpressionParser::parse(BSON("foo" << BSON("$gte" << 10)), expCtx);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        unique_ptr<CollectionScan> scan =
+            make_unique<CollectionScan>(&_opCtx, params, &ws, filterExpr.get());
+
+        // The matches come back in the order of the scan.
+        int expected = 10;
+        while (!scan->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan->work(&id);
+            if (PlanStage::ADVANCED == state) {
+                ASSERT_EQUALS(expected, ws.get(id)->obj.value()["foo"].numberInt());
+                ++expected;
+            }
+        }
+        ASSERT_EQUALS(numObj(), expected);
+
+        auto stats = static_cast<const CollectionScanStats*>(scan->getSpecificStats());
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), stats->docsTested);
+        ASSERT_EQUALS(std::max(1U, std::min(4U, ProcessInfo().getNumCores())),
+                      static_cast<unsigned>(stats->parallelism));
+    }
+};
+
+//
+// A shared scan that starts while another is in progress joins it where it has got to, wraps
+// around at the end of the collection, and returns every object once.
+//
+class QueryStageCollscanSharedScan : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        // MMAPv1 does not return records in RecordId order, so shared scans are never planned.
+        if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
+            return;
+        }
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        params.shareScan = true;
+
+        // The first scan reads part of the collection, and records how far it has got when it
+        // yields.
+        WorkingSet firstWs;
+        unique_ptr<CollectionScan> first =
+            make_unique<CollectionScan>(&_opCtx, params, &firstWs, nullptr);
+        int lastSeen = -1;
+        while (lastSeen < 19) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED == first->work(&id)) {
+                lastSeen = firstWs.get(id)->obj.value()["foo"].numberInt();
+            }
+        }
+        first->saveState();
+        first->restoreState();
+
+        WorkingSet ws;
+        unique_ptr<CollectionScan> scan =
+            make_unique<CollectionScan>(&_opCtx, params, &ws, nullptr);
+        vector<int> seen;
+        while (!scan->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED == scan->work(&id)) {
+                seen.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+            }
+        }
+
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), seen.size());
+        ASSERT_EQUALS(lastSeen, seen.front());
+        ASSERT_EQUALS(numObj() - 1, seen[numObj() - 1 - lastSeen]);
+        ASSERT_EQUALS(0, seen[numObj() - lastSeen]);
+        std::sort(seen.begin(), seen.end());
+        for (int i = 0; i < numObj(); ++i) {
+            ASSERT_EQUALS(i, seen[i]);
+        }
+
+        auto stats = static_cast<const CollectionScanStats*>(scan->getSpecificStats());
+        ASSERT(stats->sharedScan);
+        ASSERT(stats->joinedSharedScan);
+        ASSERT(stats->sharedScanWrapped);
+
+        auto firstStats = static_cast<const CollectionScanStats*>(first->getSpecificStats());
+        ASSERT(firstStats->sharedScan);
+        ASSERT_FALSE(firstStats->joinedSharedScan);
+    }
+};
+
 //
 // Scan through half the objects, delete the one we're about to fetch, then expect to get the
 // "next" object we would have gotten after that.  But, do it in reverse!
@@ -413,6 +541,8 @@ public:
         add<QueryStageCollscanObjectsInOrderForward>();
         add<QueryStageCollscanObjectsInOrderBackward>();
         add<QueryStageCollscanInvalidateUpcomingObject>();
+        add<QueryStageCollscanFilterInParallel>();
+        add<QueryStageCollscanSharedScan>();
         add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
     }
 };
@@ -35,16 +35,22 @@
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageFetch {
 
@@ -72,6 +78,19 @@ public:
         _client.insert(ns(), obj);
     }
 
+    void addIndex(const BSONObj& obj) {
+        ASSERT_OK(dbtests::createIndex(&_opCtx, ns(), obj));
+    }
+
+    IndexDescriptor* getIndex(const BSONObj& obj, Collection* coll) {
+        std::vector<IndexDescriptor*> indexes;
+        coll->getIndexCatalog()->findIndexesByKeyPattern(&_opCtx, obj, false, &indexes);
+        if (indexes.empty()) {
+            FAIL(mongoutils::str::stream() << "Unable to find index with key pattern " << obj);
+        }
+        return indexes[0];
+    }
+
     void remove(const BSONObj& obj) {
         _client.remove(ns(), obj);
     }
@@ -219,6 +238,135 @@ public:
     }
 };
 
+//
+// Test that documents read in batches are returned in the order of the child's results.
+//
+class FetchStageBatched : public QueryStageFetchBase {
+public:
+    void run() {
+        // Storage engines without document-level locking never fetch in batches.
+        if (!supportsDocLocking()) {
+            return;
+        }
+
+        const int oldBatchSize = internalQueryExecFetchBatchSize.load();
+        ON_BLOCK_EXIT([oldBatchSize] { internalQueryExecFetchBatchSize.store(oldBatchSize); });
+        internalQueryExecFetchBatchSize.store(4);
+
+        OldClientWriteContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(&_opCtx, ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        for (int i = 0; i < 20; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(20), recordIds.size());
+
+        // The child returns the records in reverse order, the way a scan of a descending index
+        // might.
+        WorkingSet ws;
+        auto mockStage = make_unique<QueuedDataStage>(&_opCtx, &ws);
+        for (auto it = recordIds.rbegin(); it != recordIds.rend(); ++it) {
+            WorkingSetID id = ws.allocate();
+            ws.get(id)->recordId = *it;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+        }
+
+        unique_ptr<FetchStage> fetchStage(
+            new FetchStage(&_opCtx, &ws, mockStage.release(), NULL, coll));
+
+        int expected = 19;
+        while (!fetchStage->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = fetchStage->work(&id);
+            if (PlanStage::ADVANCED == state) {
+                ASSERT_EQUALS(expected, ws.get(id)->obj.value()["foo"].numberInt());
+                --expected;
+            }
+        }
+        ASSERT_EQUALS(-1, expected);
+
+        // The first four documents are fetched one at a time, and the rest in batches of four.
+        auto stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_EQUALS(size_t(20), stats->docsExamined);
+        ASSERT_EQUALS(size_t(4), stats->fetchBatches);
+        ASSERT_EQUALS(size_t(16), stats->docsFetchedInBatches);
+    }
+};
+
+//
+// Test that the last, partial batch is returned when the child only reports EOF once it is asked
+// for another result, as an index scan does.
+//
+class FetchStageBatchedPartialLastBatch : public QueryStageFetchBase {
+public:
+    void run() {
+        // Storage engines without document-level locking never fetch in batches.
+        if (!supportsDocLocking()) {
+            return;
+        }
+
+        const int oldBatchSize = internalQueryExecFetchBatchSize.load();
+        ON_BLOCK_EXIT([oldBatchSize] { internalQueryExecFetchBatchSize.store(oldBatchSize); });
+        internalQueryExecFetchBatchSize.store(4);
+
+        OldClientWriteContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(&_opCtx, ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        // 19 is not a multiple of the batch size, so the last batch holds three documents.
+        for (int i = 0; i < 19; ++i) {
+            insert(BSON("foo" << i));
+        }
+        addIndex(BSON("foo" << 1));
+
+        WorkingSet ws;
+        IndexScanParams params;
+        params.descriptor = getIndex(BSON("foo" << 1), coll);
+        params.bounds.isSimpleRange = true;
+        params.bounds.startKey = BSON("" << 0);
+        params.bounds.endKey = BSON("" << 100);
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        params.direction = 1;
+
+        unique_ptr<FetchStage> fetchStage(new FetchStage(
+            &_opCtx, &ws, new IndexScan(&_opCtx, params, &ws, NULL), NULL, coll));
+
+        int expected = 0;
+        while (!fetchStage->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = fetchStage->work(&id);
+            if (PlanStage::ADVANCED == state) {
+                ASSERT_EQUALS(expected, ws.get(id)->obj.value()["foo"].numberInt());
+                ++expected;
+            } else if (PlanStage::IS_EOF == state) {
+                break;
+            }
+        }
+        ASSERT_EQUALS(19, expected);
+
+        // The first four documents are fetched one at a time, then three full batches and the
+        // partial one.
+        auto stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_EQUALS(size_t(19), stats->docsExamined);
+        ASSERT_EQUALS(size_t(4), stats->fetchBatches);
+        ASSERT_EQUALS(size_t(15), stats->docsFetchedInBatches);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_fetch") {}
@@ -226,6 +374,8 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageBatched>();
+        add<FetchStageBatchedPartialLastBatch>();
     }
 };
 
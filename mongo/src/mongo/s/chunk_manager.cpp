@@ -32,6 +32,7 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <numeric>
 #include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -41,6 +42,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -49,6 +51,18 @@ namespace {
 // Used to generate sequence numbers to assign to each newly created ChunkManager
 AtomicUInt32 nextCMSequenceNumber(0);
 
+// Shard keys are always ascending, so their KeyStrings are encoded with an all-ascending ordering
+const Ordering kShardKeyOrdering = Ordering::make(BSONObj());
+
+// The number of chunks in each block of a routing table which is built from scratch. A block
+// which changes is split once it holds more than this many chunks, and a block which has shrunk
+// below half of this many is merged with the block after it.
+const size_t kChunksPerBlock = 256;
+
+bool keyLessThanChunkMax(const BSONObj& key, const std::shared_ptr<Chunk>& chunk) {
+    return SimpleBSONObjComparator::kInstance.evaluate(key < chunk->getMax());
+}
+
 //objǷtype
 void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
     for (const auto&& element : o) {
@@ -65,7 +79,7 @@ ChunkManager::ChunkManager(NamespaceString nss,
                            KeyPattern shardKeyPattern,
                            std::unique_ptr<CollatorInterface> defaultCollator,
                            bool unique,
-                           ChunkMap chunkMap,
+                           ChunkBlocks blocks,
                            ChunkVersion collectionVersion)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
@@ -74,8 +88,14 @@ ChunkManager::ChunkManager(NamespaceString nss,
       _defaultCollator(std::move(defaultCollator)),
       _unique(unique),
       ////·ɱ  ChunkManager::toStringԴӡmongos·ɱ
-      _chunkMap(std::move(chunkMap)),
-      _chunkMapViews(_constructChunkMapViews(collectionVersion.epoch(), _chunkMap)),
+      _blocks(std::move(blocks)),
+      _numChunks(std::accumulate(_blocks.begin(),
+                                 _blocks.end(),
+                                 0,
+                                 [](int sum, const std::shared_ptr<const ChunkBlock>& block) {
+                                     return sum + static_cast<int>(block->chunks.size());
+                                 })),
+      _chunkMapViews(_constructChunkMapViews(_blocks)),
       _collectionVersion(collectionVersion) {}
 
 //ͨshardkeyҵӦchunkϢ
@@ -93,12 +113,25 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardK
         }
     }
 
-    const auto it = _chunkMap.upper_bound(shardKey);
+    // The first block whose last chunk ends after the key holds the chunk which contains it
+    const auto blockIt = std::upper_bound(
+        _blocks.begin(),
+        _blocks.end(),
+        shardKey,
+        [](const BSONObj& key, const std::shared_ptr<const ChunkBlock>& block) {
+            return keyLessThanChunkMax(key, block->chunks.back());
+        });
+
+    std::shared_ptr<Chunk> chunk;
+    if (blockIt != _blocks.end()) {
+        const auto& chunks = (*blockIt)->chunks;
+        chunk = *std::upper_bound(chunks.begin(), chunks.end(), shardKey, keyLessThanChunkMax);
+    }
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
-            it != _chunkMap.end() && it->second->containsKey(shardKey));
+            chunk && chunk->containsKey(shardKey));
 
-    return it->second;
+    return chunk;
 }
 
 std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
@@ -167,8 +200,14 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
     //typedef std::vector<std::pair< BSONObj, BSONObj >> BoundList;
     BoundList ranges = _shardKeyPattern.flattenBounds(bounds);
 
+    // The ranges come out of the bounds in ascending order, so each one is looked up starting
+    // from where the previous one was found rather than from the first range.
+    RangeSweep sweep;
     for (BoundList::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
-        getShardIdsForRange(it->first /*min*/, it->second /*max*/, shardIds);
+        _addShardIdsForRange(_encodeShardKey(it->first /*min*/),
+                             _encodeShardKey(it->second /*max*/),
+                             &sweep,
+                             shardIds);
 
         // once we know we need to visit all shards no need to keep looping
         if (shardIds->size() == _chunkMapViews.shardVersions.size()) {
@@ -180,26 +219,75 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
     // For now, we satisfy that assumption by adding a shard with no matches rather than returning
     // an empty set of shards.
     if (shardIds->empty()) {
-        shardIds->insert(_chunkMapViews.chunkRangeMap.begin()->second.shardId);
+        shardIds->insert(_blocks.front()->rangeShardIds.front());
     }
 }
 
 void ChunkManager::getShardIdsForRange(const BSONObj& min,
                                        const BSONObj& max,
                                        std::set<ShardId>* shardIds) const {
-    auto it = _chunkMapViews.chunkRangeMap.upper_bound(min);
-    auto end = _chunkMapViews.chunkRangeMap.upper_bound(max);
+    RangeSweep sweep;
+    _addShardIdsForRange(_encodeShardKey(min), _encodeShardKey(max), &sweep, shardIds);
+}
+
+std::string ChunkManager::_encodeShardKey(const BSONObj& shardKey) {
+    const KeyString ks(KeyString::kLatestVersion, shardKey, kShardKeyOrdering);
+    return std::string(ks.getBuffer(), ks.getSize());
+}
+
+ChunkManager::RangePosition ChunkManager::_findRange(const std::string& encodedKey,
+                                                     const RangePosition& from) const {
+    // The first block whose last range ends after the key holds the range which contains it
+    const auto blockIt = std::upper_bound(
+        _blocks.begin() + from.block,
+        _blocks.end(),
+        encodedKey,
+        [](const std::string& key, const std::shared_ptr<const ChunkBlock>& block) {
+            return key < block->rangeMaxKeys.back();
+        });
+
+    RangePosition pos;
+    pos.block = blockIt - _blocks.begin();
+    if (blockIt != _blocks.end()) {
+        const auto& maxKeys = (*blockIt)->rangeMaxKeys;
+        const size_t start = (pos.block == from.block) ? from.range : 0;
+        pos.range =
+            std::upper_bound(maxKeys.begin() + start, maxKeys.end(), encodedKey) - maxKeys.begin();
+    }
+    return pos;
+}
 
-    // The chunk range map must always cover the entire key space
-    invariant(it != _chunkMapViews.chunkRangeMap.end());
+ChunkManager::RangePosition ChunkManager::_nextRange(RangePosition pos) const {
+    if (++pos.range == _blocks[pos.block]->rangeMaxKeys.size()) {
+        ++pos.block;
+        pos.range = 0;
+    }
+    return pos;
+}
+
+void ChunkManager::_addShardIdsForRange(const std::string& encodedMin,
+                                        const std::string& encodedMax,
+                                        RangeSweep* sweep,
+                                        std::set<ShardId>* shardIds) const {
+    if (encodedMin < sweep->lastEncodedMin) {
+        *sweep = RangeSweep();
+    }
+
+    const RangePosition first = _findRange(encodedMin, sweep->searchFrom);
+
+    // The ranges must always cover the entire key space
+    invariant(first.block < _blocks.size());
 
-    // We need to include the last chunk
-    if (end != _chunkMapViews.chunkRangeMap.cend()) {
-        ++end;
+    // We need to include the range which contains the max, since the bounds are inclusive
+    RangePosition last = _findRange(encodedMax, first);
+    if (last.block == _blocks.size()) {
+        last.block = _blocks.size() - 1;
+        last.range = _blocks.back()->rangeMaxKeys.size() - 1;
     }
 
-    for (; it != end; ++it) {
-        shardIds->insert(it->second.shardId);
+    for (RangePosition pos = std::max(first, sweep->nextUnvisited); !(last < pos);
+         pos = _nextRange(pos)) {
+        shardIds->insert(_blocks[pos.block]->rangeShardIds[pos.range]);
 
         // No need to iterate through the rest of the ranges, because we already know we need to use
         // all shards.
@@ -207,6 +295,10 @@ void ChunkManager::getShardIdsForRange(const BSONObj& min,
             break;
         }
     }
+
+    sweep->lastEncodedMin = encodedMin;
+    sweep->searchFrom = first;
+    sweep->nextUnvisited = std::max(sweep->nextUnvisited, _nextRange(last));
 }
 
 //Returns the ids of all shards on which the collection has any chunks.
@@ -362,33 +454,74 @@ std::string ChunkManager::toString() const {
     StringBuilder sb;
     sb << "ChunkManager: " << _nss.ns() << " key:" << _shardKeyPattern.toString() << '\n';
 
-    for (const auto& entry : _chunkMap) {
-        sb << "\t" << entry.second->toString() << '\n';
+    for (const auto& chunk : chunks()) {
+        sb << "\t" << chunk->toString() << '\n';
     }
 
     return sb.str();
 }
 
-ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epoch,
-                                                                  const ChunkMap& chunkMap) {
+ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const ChunkBlocks& blocks) {
+    ShardVersionMap shardVersions;
 
-	//¼ĳshard  max汾ı仯
-	ChunkRangeMap chunkRangeMap =
-        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ShardAndChunkRange>();
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const auto& block = *blocks[i];
 
-    ShardVersionMap shardVersions;
+        //ÿshardİ汾Ϊblockиshardchunk汾
+        for (const auto& blockShardVersion : block.shardVersions) {
+            auto shardVersionIt =
+                shardVersions.emplace(blockShardVersion.first, blockShardVersion.second).first;
+            if (blockShardVersion.second > shardVersionIt->second)
+                shardVersionIt->second = blockShardVersion.second;
+        }
+
+        if (i > 0) {
+            const auto& prevChunk = *blocks[i - 1]->chunks.back();
+            const auto& firstChunk = *block.chunks.front();
+
+            // Make sure there are no gaps between the blocks
+            uassert(ErrorCodes::ConflictingOperationInProgress,
+                    str::stream() << "Gap or an overlap between ranges "
+                                  << ChunkRange(firstChunk.getMin(), firstChunk.getMax()).toString()
+                                  << " and "
+                                  << ChunkRange(prevChunk.getMin(), prevChunk.getMax()).toString(),
+                    SimpleBSONObjComparator::kInstance.evaluate(prevChunk.getMax() ==
+                                                                firstChunk.getMin()));
+        }
+    }
+
+    if (!blocks.empty()) {
+        invariant(!shardVersions.empty());
+
+        checkAllElementsAreOfType(MinKey, blocks.front()->chunks.front()->getMin());
+        checkAllElementsAreOfType(MaxKey, blocks.back()->chunks.back()->getMax());
+    }
+
+    return {std::move(shardVersions)};
+}
+
+std::shared_ptr<const ChunkManager::ChunkBlock> ChunkManager::_makeBlock(
+    const OID& epoch, std::vector<std::shared_ptr<Chunk>> chunks) {
+    invariant(!chunks.empty());
 
-    ChunkMap::const_iterator current = chunkMap.cbegin();
+    auto block = std::make_shared<ChunkBlock>();
+    block->chunks = std::move(chunks);
 
-    while (current != chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
+    BSONObj prevRangeMin;
+    BSONObj prevRangeMax;
+
+    auto current = block->chunks.cbegin();
+
+    while (current != block->chunks.cend()) {
+        const auto& firstChunkInRange = *current;
 
         // Tracks the max shard version for the shard on which the current range will reside
-        auto shardVersionIt = shardVersions.find(firstChunkInRange->getShardId());
-        if (shardVersionIt == shardVersions.end()) {
+        auto shardVersionIt = block->shardVersions.find(firstChunkInRange->getShardId());
+        if (shardVersionIt == block->shardVersions.end()) {
             shardVersionIt =
 				//ԿShardVersionMapм¼KVΪ: <shardid, ChunkVersion>
-                shardVersions.emplace(firstChunkInRange->getShardId(), ChunkVersion(0, 0, epoch))
+                block->shardVersions
+                    .emplace(firstChunkInRange->getShardId(), ChunkVersion(0, 0, epoch))
                     .first;
         }
 
@@ -398,10 +531,8 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
 		//shardidӦchunkversionΪshardchunkа汾ǸlastmodeҲconfig.chunks
         current = std::find_if(
             current,
-            chunkMap.cend(),
-            [&firstChunkInRange, &maxShardVersion](const ChunkMap::value_type& chunkMapEntry) {
-                const auto& currentChunk = chunkMapEntry.second;
-
+            block->chunks.cend(),
+            [&firstChunkInRange, &maxShardVersion](const std::shared_ptr<Chunk>& currentChunk) {
                 if (currentChunk->getShardId() != firstChunkInRange->getShardId())
                     return true;
 
@@ -411,49 +542,33 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
                 return false;
             });
 
-        const auto rangeLast = std::prev(current);
-
-        const BSONObj rangeMin = firstChunkInRange->getMin();
-        const BSONObj rangeMax = rangeLast->second->getMax();
-
-        const auto oldSize = chunkRangeMap.size();
-        const auto insertIterator = chunkRangeMap.insert(
-            chunkRangeMap.end(),
-            //ChunkRangeMapжӦKVΪ<max汾, ShardAndChunkRange>
-            std::make_pair(
-                rangeMax,
-                ShardAndChunkRange{{rangeMin, rangeMax}, firstChunkInRange->getShardId()}));
-        uassert(ErrorCodes::ConflictingOperationInProgress,
-                str::stream() << "Metadata contains two chunks with the same max value "
-                              << rangeMax,
-                oldSize + 1 == chunkRangeMap.size());
+        const auto& rangeLast = *std::prev(current);
 
+        const BSONObj& rangeMin = firstChunkInRange->getMin();
+        const BSONObj& rangeMax = rangeLast->getMax();
 
-        if (insertIterator != chunkRangeMap.begin()) {
+        if (!block->rangeMaxKeys.empty()) {
             // Make sure there are no gaps in the ranges
             uassert(ErrorCodes::ConflictingOperationInProgress,
                     str::stream() << "Gap or an overlap between ranges "
-                                  << insertIterator->second.range.toString()
+                                  << ChunkRange(rangeMin, rangeMax).toString()
                                   << " and "
-                                  << std::prev(insertIterator)->second.range.toString(),
-                    SimpleBSONObjComparator::kInstance.evaluate(std::prev(insertIterator)->first ==
-                                                                rangeMin));
+                                  << ChunkRange(prevRangeMin, prevRangeMax).toString(),
+                    SimpleBSONObjComparator::kInstance.evaluate(prevRangeMax == rangeMin));
         }
 
+        //rangeMaxKeysм¼ÿrangemaxKeyString룬rangeShardIdsм¼Ӧshardid
+        block->rangeMaxKeys.push_back(_encodeShardKey(rangeMax));
+        block->rangeShardIds.push_back(firstChunkInRange->getShardId());
+        prevRangeMin = rangeMin;
+        prevRangeMax = rangeMax;
+
         // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
         // somewhere, which should have been caught at chunk load time
         invariant(maxShardVersion.isSet());
     }
 
-    if (!chunkMap.empty()) {
-        invariant(!chunkRangeMap.empty());
-        invariant(!shardVersions.empty());
-
-        checkAllElementsAreOfType(MinKey, chunkRangeMap.begin()->second.min());
-        checkAllElementsAreOfType(MaxKey, chunkRangeMap.rbegin()->first);
-    }
-
-    return {std::move(chunkRangeMap), std::move(shardVersions)};
+    return block;
 }
 
 //ȡһChunkManager
@@ -473,7 +588,7 @@ std::shared_ptr<ChunkManager> ChunkManager::makeNew(
                std::move(shardKeyPattern),
                std::move(defaultCollator),
                std::move(unique),
-               SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>(),
+               ChunkBlocks{},
                {0, 0, epoch})
         .makeUpdated(chunks);
 }
@@ -484,9 +599,6 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
     //ȡ_collectionVersionҲshardchunkϢ
     const auto startingCollectionVersion = getVersion();
-	//ػchunkϢб
-    auto chunkMap = _chunkMap;
-
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
 		//ChunkType::getVersion
@@ -501,21 +613,6 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         // Chunks must always come in incrementally sorted order
         invariant(chunkVersion >= collectionVersion);
         collectionVersion = chunkVersion;
-
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunk.getMin());
-
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunk.getMax());
-
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
-
-        // Insert only the chunk itself
-        //map keyΪchunk.getMax()valueΪchunk
-        chunkMap.insert(std::make_pair(chunk.getMax(), std::make_shared<Chunk>(chunk)));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -536,9 +633,147 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
                          KeyPattern(getShardKeyPattern().getKeyPattern()),
                          CollatorInterface::cloneCollator(getDefaultCollator()),
                          isUnique(),
-                         std::move(chunkMap),
+                         _applyChanges(changedChunks),
                          collectionVersion));
 }
+
+ChunkManager::ChunkBlocks ChunkManager::_applyChanges(
+    const std::vector<ChunkType>& changedChunks) const {
+    const OID& epoch = _collectionVersion.epoch();
+
+    ChunkBlocks newBlocks;
+
+    if (changedChunks.size() * kChunksPerBlock > static_cast<size_t>(_numChunks)) {
+        // So many chunks changed that most blocks would be rebuilt anyway, so build the routing
+        // table from scratch.
+        auto chunkMap =
+            SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>();
+        for (const auto& chunk : chunks()) {
+            chunkMap.emplace_hint(chunkMap.end(), chunk->getMax(), chunk);
+        }
+
+        for (const auto& chunk : changedChunks) {
+            // Returns the first chunk with a max key that is > min - implies that the chunk
+            // overlaps min
+            const auto low = chunkMap.upper_bound(chunk.getMin());
+
+            // Returns the first chunk with a max key that is > max - implies that the next chunk
+            // cannot not overlap max
+            const auto high = chunkMap.upper_bound(chunk.getMax());
+
+            // Erase all chunks from the map, which overlap the chunk we got from the persistent
+            // store
+            chunkMap.erase(low, high);
+
+            // Insert only the chunk itself
+            //map keyΪchunk.getMax()valueΪchunk
+            chunkMap.insert(std::make_pair(chunk.getMax(), std::make_shared<Chunk>(chunk)));
+        }
+
+        std::vector<std::shared_ptr<Chunk>> blockChunks;
+        for (const auto& entry : chunkMap) {
+            blockChunks.push_back(entry.second);
+            if (blockChunks.size() == kChunksPerBlock) {
+                newBlocks.push_back(_makeBlock(epoch, std::move(blockChunks)));
+                blockChunks.clear();
+            }
+        }
+        if (!blockChunks.empty()) {
+            newBlocks.push_back(_makeBlock(epoch, std::move(blockChunks)));
+        }
+
+        return newBlocks;
+    }
+
+    // Each slot is either a block which no change has touched yet, or the chunks of the blocks
+    // which the changes have touched so far, merged together.
+    struct Slot {
+        const std::shared_ptr<Chunk>& lastChunk() const {
+            return block ? block->chunks.back() : chunks.back();
+        }
+
+        std::shared_ptr<const ChunkBlock> block;
+        std::vector<std::shared_ptr<Chunk>> chunks;
+    };
+
+    std::vector<Slot> slots;
+    slots.reserve(_blocks.size());
+    for (const auto& block : _blocks) {
+        slots.push_back({block, {}});
+    }
+
+    const auto keyLessThanSlotMax = [](const BSONObj& key, const Slot& slot) {
+        return keyLessThanChunkMax(key, slot.lastChunk());
+    };
+    const auto slotMaxLessThanKey = [](const Slot& slot, const BSONObj& key) {
+        return SimpleBSONObjComparator::kInstance.evaluate(slot.lastChunk()->getMax() < key);
+    };
+
+    for (const auto& chunk : changedChunks) {
+        if (slots.empty()) {
+            slots.push_back({nullptr, {std::make_shared<Chunk>(chunk)}});
+            continue;
+        }
+
+        // The chunks which overlap the changed chunk are those with a max key in (min, max]. They
+        // are held by the slots from the first one which ends after min to the first one which
+        // ends at or after max.
+        auto first =
+            std::upper_bound(slots.begin(), slots.end(), chunk.getMin(), keyLessThanSlotMax);
+        auto last = std::lower_bound(first, slots.end(), chunk.getMax(), slotMaxLessThanKey);
+        if (first == slots.end()) {
+            --first;
+        }
+        if (last == slots.end()) {
+            --last;
+        }
+
+        std::vector<std::shared_ptr<Chunk>> merged;
+        for (auto it = first; it != std::next(last); ++it) {
+            const auto& slotChunks = it->block ? it->block->chunks : it->chunks;
+            merged.insert(merged.end(), slotChunks.begin(), slotChunks.end());
+        }
+
+        // Erase all chunks which overlap the chunk we got from the persistent store and insert
+        // only the chunk itself in their place
+        const auto low =
+            std::upper_bound(merged.begin(), merged.end(), chunk.getMin(), keyLessThanChunkMax);
+        const auto high = std::upper_bound(low, merged.end(), chunk.getMax(), keyLessThanChunkMax);
+        merged.insert(merged.erase(low, high), std::make_shared<Chunk>(chunk));
+
+        first->block = nullptr;
+        first->chunks = std::move(merged);
+        slots.erase(std::next(first), std::next(last));
+    }
+
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        if (it->block) {
+            newBlocks.push_back(std::move(it->block));
+            continue;
+        }
+
+        // Merge a block which has shrunk with the next one, so that the blocks do not fragment
+        auto blockChunks = std::move(it->chunks);
+        while (blockChunks.size() < kChunksPerBlock / 2 && std::next(it) != slots.end()) {
+            ++it;
+            const auto& slotChunks = it->block ? it->block->chunks : it->chunks;
+            blockChunks.insert(blockChunks.end(), slotChunks.begin(), slotChunks.end());
+        }
+
+        // Split a block which has grown into blocks of about the same size
+        const size_t numBlocks = (blockChunks.size() + kChunksPerBlock - 1) / kChunksPerBlock;
+        for (size_t i = 0; i < numBlocks; ++i) {
+            const size_t begin = blockChunks.size() * i / numBlocks;
+            const size_t end = blockChunks.size() * (i + 1) / numBlocks;
+            newBlocks.push_back(
+                _makeBlock(epoch,
+                           std::vector<std::shared_ptr<Chunk>>(blockChunks.begin() + begin,
+                                                               blockChunks.begin() + end)));
+        }
+    }
+
+    return newBlocks;
+}
 }  // namespace mongo
 
 
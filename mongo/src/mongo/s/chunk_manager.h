@@ -31,6 +31,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
@@ -47,10 +48,6 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-//map keyΪchunk.getMax()valueΪchunkοChunkManager::makeUpdated
-using ChunkMap = BSONObjIndexedMap<std::shared_ptr<Chunk>>;
-
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
 
@@ -73,33 +70,44 @@ using ShardVersionMap = std::map<ShardId, ChunkVersion>;
 class ChunkManager : public std::enable_shared_from_this<ChunkManager> {
     MONGO_DISALLOW_COPYING(ChunkManager);
 
+    struct ChunkBlock;
+    using ChunkBlocks = std::vector<std::shared_ptr<const ChunkBlock>>;
+
 public:
     //
     class ConstChunkIterator {
     public:
         ConstChunkIterator() = default;
-        explicit ConstChunkIterator(ChunkMap::const_iterator iter) : _iter{iter} {}
+        ConstChunkIterator(const ChunkBlocks* blocks, size_t block)
+            : _blocks{blocks}, _block{block} {}
 
         //
         ConstChunkIterator& operator++() {
-            ++_iter;
+            if (++_chunk == (*_blocks)[_block]->chunks.size()) {
+                ++_block;
+                _chunk = 0;
+            }
             return *this;
         }
         ConstChunkIterator operator++(int) {
-            return ConstChunkIterator{_iter++};
+            ConstChunkIterator old = *this;
+            ++*this;
+            return old;
         }
         bool operator==(const ConstChunkIterator& other) const {
-            return _iter == other._iter;
+            return _blocks == other._blocks && _block == other._block && _chunk == other._chunk;
         }
         bool operator!=(const ConstChunkIterator& other) const {
             return !(*this == other);
         }
-        const ChunkMap::mapped_type& operator*() const {
-            return _iter->second;
+        const std::shared_ptr<Chunk>& operator*() const {
+            return (*_blocks)[_block]->chunks[_chunk];
         }
 
     private:
-        ChunkMap::const_iterator _iter;
+        const ChunkBlocks* _blocks{nullptr};
+        size_t _block{0};
+        size_t _chunk{0};
     };
 
     class ConstRangeOfChunks {
@@ -177,11 +185,11 @@ public:
     ChunkVersion getVersion(const ShardId& shardId) const;
 
     ConstRangeOfChunks chunks() const {
-        return {ConstChunkIterator{_chunkMap.cbegin()}, ConstChunkIterator{_chunkMap.cend()}};
+        return {ConstChunkIterator{&_blocks, 0}, ConstChunkIterator{&_blocks, _blocks.size()}};
     }
 
     int numChunks() const {
-        return _chunkMap.size();
+        return _numChunks;
     }
 
     /**
@@ -258,36 +266,33 @@ public:
 
 private:
     /**
-     * Represents a range of chunk keys [getMin(), getMax()) and the id of the shard on which they
-     * reside according to the metadata.
+     * A run of consecutive chunks of the routing table, and the transformations of them which are
+     * used for targeting. A block is never modified once it is built, so a chunk manager made by
+     * makeUpdated() shares every block which the changed chunks did not touch with the chunk
+     * manager it was made from, and an update costs time in proportion to the number of changed
+     * chunks rather than to the size of the routing table.
      */
-    struct ShardAndChunkRange {
-        const BSONObj& min() const {
-            return range.getMin();
-        }
-
-        const BSONObj& max() const {
-            return range.getMax();
-        }
-
-        ChunkRange range;
-        ShardId shardId;
+    struct ChunkBlock {
+        // The chunks of the block, in ascending order of their max keys.
+        std::vector<std::shared_ptr<Chunk>> chunks;
+
+        // Transformation of the chunks containing what range of keys reside on which shard.
+        // Consecutive chunks on the same shard are merged into a single range. Entry i of
+        // 'rangeMaxKeys' is the KeyString encoding of the max key of range i, so that targeting
+        // compares keys with memcmp rather than element by element, and entry i of 'rangeShardIds'
+        // is the shard on which range i resides.
+        std::vector<std::string> rangeMaxKeys;
+        std::vector<ShardId> rangeShardIds;
+
+        // Map from shard id to the maximum version of the chunks of the block on that shard.
+        ShardVersionMap shardVersions;
     };
 
-    //οChunkManager::_constructChunkMapViews
-    using ChunkRangeMap = BSONObjIndexedMap<ShardAndChunkRange>;
-
     /**
      * Contains different transformations of the chunk map for efficient querying
      */
     //ChunkManager::_constructChunkMapViews
     struct ChunkMapViews {
-        // Transformation of the chunk map containing what range of keys reside on which shard. The
-        // index is the max key of the respective range and the union of all ranges in a such
-        // constructed map must cover the complete space from [MinKey, MaxKey).
-         
-        const ChunkRangeMap chunkRangeMap;
-
         // Map from shard id to the maximum chunk version for that shard. If a shard contains no
         // chunks, it won't be present in this map.
         //ÿshardİ汾ϢȡֵΪshardchunk汾Ϣ
@@ -296,16 +301,84 @@ private:
     };
 
     /**
-     * Does a single pass over the chunkMap and constructs the ChunkMapViews object.
+     * Does a single pass over the blocks, checks that together they cover the complete space from
+     * [MinKey, MaxKey) and constructs the ChunkMapViews object.
+     */
+    static ChunkMapViews _constructChunkMapViews(const ChunkBlocks& blocks);
+
+    /**
+     * Builds a block out of 'chunks', which must be in ascending order of their max keys.
+     */
+    static std::shared_ptr<const ChunkBlock> _makeBlock(const OID& epoch,
+                                                        std::vector<std::shared_ptr<Chunk>> chunks);
+
+    /**
+     * Returns the blocks of this chunk manager with 'changedChunks' applied. Only the blocks which
+     * hold a chunk overlapping one of the changed chunks are rebuilt, unless there are so many
+     * changes that rebuilding all of them is cheaper.
+     */
+    ChunkBlocks _applyChanges(const std::vector<ChunkType>& changedChunks) const;
+
+    /**
+     * Returns the KeyString encoding of 'shardKey' which is compared against the entries of
+     * ChunkMapViews::rangeMaxKeys.
      */
-    static ChunkMapViews _constructChunkMapViews(const OID& epoch, const ChunkMap& chunkMap);
+    static std::string _encodeShardKey(const BSONObj& shardKey);
+
+    /**
+     * Identifies range 'range' of block 'block'. Positions order the ranges by their keys.
+     */
+    struct RangePosition {
+        bool operator<(const RangePosition& other) const {
+            return block < other.block || (block == other.block && range < other.range);
+        }
+
+        size_t block = 0;
+        size_t range = 0;
+    };
+
+    /**
+     * Returns the position of the first range whose max key is greater than 'encodedKey',
+     * searching only the ranges from position 'from' onwards, or the position one past the last
+     * block if there is none.
+     */
+    RangePosition _findRange(const std::string& encodedKey, const RangePosition& from) const;
+
+    /**
+     * Returns the position of the range which follows the range at 'pos'.
+     */
+    RangePosition _nextRange(RangePosition pos) const;
+
+    /**
+     * Position of a sweep over the ranges for a sequence of key ranges in ascending order, which
+     * lets each lookup start where the previous one ended instead of at the first range.
+     */
+    struct RangeSweep {
+        // The min key of the previous key range. A key range below it restarts the sweep.
+        std::string lastEncodedMin;
+
+        // No range before this position contains a key at or above 'lastEncodedMin'.
+        RangePosition searchFrom;
+
+        // The shards of the ranges before this position have already been added.
+        RangePosition nextUnvisited;
+    };
+
+    /**
+     * Adds the shards of the ranges overlapping [encodedMin, encodedMax] to 'shardIds', skipping
+     * the ranges which 'sweep' has already visited, and advances 'sweep'.
+     */
+    void _addShardIdsForRange(const std::string& encodedMin,
+                              const std::string& encodedMax,
+                              RangeSweep* sweep,
+                              std::set<ShardId>* shardIds) const;
 
     ChunkManager(NamespaceString nss,
                  boost::optional<UUID>,
                  KeyPattern shardKeyPattern,
                  std::unique_ptr<CollatorInterface> defaultCollator,
                  bool unique,
-                 ChunkMap chunkMap,
+                 ChunkBlocks blocks,
                  ChunkVersion collectionVersion);
 
     // The shard versioning mechanism hinges on keeping track of the number of times we reload
@@ -327,11 +400,13 @@ private:
     // Whether the sharding key is unique
     const bool _unique;
 
-    // Map from the max for each chunk to an entry describing the chunk. The union of all chunks'
+    // The chunks in ascending order of their max keys, split into blocks. The union of all chunks'
     // ranges must cover the complete space from [MinKey, MaxKey).
     //·ɱ  ChunkManager::toStringԴӡmongos·ɱ
-    ////map keyΪchunk.getMax()valueΪchunkοChunkManager::makeUpdated
-    const ChunkMap _chunkMap;
+    const ChunkBlocks _blocks;
+
+    // The number of chunks across all blocks
+    const int _numChunks;
 
     // Different transformations of the chunk map for efficient querying
     ////ÿshardİ汾ϢȡֵΪshardchunk汾Ϣ
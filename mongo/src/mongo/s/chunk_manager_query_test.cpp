@@ -335,6 +335,73 @@ TEST_F(ChunkManagerQueryTest, InMultiShard) {
                  {ShardId("0"), ShardId("1"), ShardId("2")});
 }
 
+TEST_F(ChunkManagerQueryTest, InManyValuesMultiShard) {
+    std::vector<BSONObj> splitPoints;
+    for (int i = 1; i < 10; ++i) {
+        splitPoints.push_back(BSON("a" << i * 10));
+    }
+
+    // Values on a chunk boundary belong to the chunk which starts there.
+    runQueryTest(BSON("a" << 1),
+                 nullptr,
+                 false,
+                 splitPoints,
+                 fromjson("{a: {$in: [5, 7, 10, 30, 55, 56, 95]}}"),
+                 BSONObj(),
+                 {ShardId("0"), ShardId("1"), ShardId("3"), ShardId("5"), ShardId("9")});
+}
+
+TEST_F(ChunkManagerQueryTest, InMixedNumericTypesMultiShard) {
+    runQueryTest(BSON("a" << 1),
+                 nullptr,
+                 false,
+                 {BSON("a" << 10), BSON("a" << 20), BSON("a" << 30)},
+                 BSON("a" << BSON("$in" << BSON_ARRAY(10.0 << 15LL << 29.5))),
+                 BSONObj(),
+                 {ShardId("1"), ShardId("2")});
+}
+
+TEST_F(ChunkManagerQueryTest, IncrementalUpdateOfManyChunks) {
+    const ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+
+    // Chunk i covers [10 * i, 10 * (i + 1)) and resides on shard i.
+    std::vector<BSONObj> splitPoints;
+    for (int i = 1; i < 1000; ++i) {
+        splitPoints.push_back(BSON("a" << i * 10));
+    }
+    auto cm = makeChunkManager(kNss, shardKeyPattern, nullptr, false, splitPoints);
+
+    // Split the chunk [5000, 5010) and move its upper half to shard 0.
+    ChunkVersion version = cm->getVersion();
+    version.incMajor();
+    ChunkType lower(kNss, {BSON("a" << 5000), BSON("a" << 5005)}, version, {"500"});
+    version.incMinor();
+    ChunkType upper(kNss, {BSON("a" << 5005), BSON("a" << 5010)}, version, {"0"});
+
+    auto updated = cm->makeUpdated({lower, upper});
+    ASSERT_EQ(1001, updated->numChunks());
+    ASSERT(updated->getVersion(ShardId("0")).equals(version));
+    ASSERT_EQ(ShardId("0"),
+              updated->findIntersectingChunkWithSimpleCollation(BSON("a" << 5007))->getShardId());
+
+    std::set<ShardId> shardIds;
+    updated->getShardIdsForRange(BSON("a" << 4995), BSON("a" << 5006), &shardIds);
+    ASSERT(shardIds == std::set<ShardId>({ShardId("0"), ShardId("499"), ShardId("500")}));
+
+    // The chunk manager which was updated is left as it was.
+    ASSERT_EQ(1000, cm->numChunks());
+    ASSERT_EQ(ShardId("500"),
+              cm->findIntersectingChunkWithSimpleCollation(BSON("a" << 5007))->getShardId());
+
+    // The chunks are still in order and cover the whole key space.
+    BSONObj prevMax = shardKeyPattern.getKeyPattern().globalMin();
+    for (const auto& chunk : updated->chunks()) {
+        ASSERT_BSONOBJ_EQ(prevMax, chunk->getMin());
+        prevMax = chunk->getMax();
+    }
+    ASSERT_BSONOBJ_EQ(shardKeyPattern.getKeyPattern().globalMax(), prevMax);
+}
+
 TEST_F(ChunkManagerQueryTest, CollationStringsMultiShard) {
     runQueryTest(BSON("a" << 1),
                  nullptr,
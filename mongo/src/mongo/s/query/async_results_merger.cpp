@@ -38,10 +38,12 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/cluster_query_knobs.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 
@@ -51,6 +53,9 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// The largest number of sort key fields an Ordering can describe.
+const int kMaxEncodedSortKeyFields = 32;
+
 /**
  * Returns the sort key out of the $sortKey metadata field in 'obj'. This object is of the form
  * {'': 'firstSortKey', '': 'secondSortKey', ...}.
@@ -72,6 +77,17 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+/**
+ * Returns the ordering with which to encode the sort keys of a merge on 'sort', or boost::none if
+ * the merge is unsorted or has too many sort fields, and must compare the BSON sort keys instead.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const BSONObj& sort) {
+    if (sort.isEmpty() || sort.nFields() > kMaxEncodedSortKeyFields) {
+        return boost::none;
+    }
+    return Ordering::make(sort);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -80,7 +96,8 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
     : _opCtx(opCtx),
       _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort)) {
+      _sortKeyOrdering(makeSortKeyOrdering(_params->sort)),
+      _mergeQueue(MergingComparator(_remotes, _params->sort, static_cast<bool>(_sortKeyOrdering))) {
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort,
@@ -104,6 +121,15 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
 AsyncResultsMerger::~AsyncResultsMerger() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     invariant(_remotesExhausted(lk) || _lifecycleState == kKillComplete);
+
+    if (shouldLog(logger::LogSeverity::Debug(1))) {
+        str::stream waitTimes;
+        for (const auto& remote : _remotes) {
+            waitTimes << " " << remote.getTargetHost().toString() << ": " << remote.waitTime;
+        }
+        LOG(1) << "Time spent waiting on each remote while merging results:"
+               << std::string(waitTimes);
+    }
 }
 
 bool AsyncResultsMerger::remotesExhausted() {
@@ -268,7 +294,7 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return hasSort ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_params->tailableMode != TailableMode::kTailable);
 
@@ -282,8 +308,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _popNextResult(lk, smallestRemote);
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
@@ -294,15 +319,14 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popNextResult(lk, _gettingFromRemote);
 
             if (_params->tailableMode == TailableMode::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -325,6 +349,29 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
+ClusterQueryResult AsyncResultsMerger::_popNextResult(WithLock, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    ClusterQueryResult front = std::move(remote.docBuffer.front());
+    remote.docBuffer.pop();
+    if (!remote.encodedSortKeys.empty()) {
+        remote.encodedSortKeys.pop();
+    }
+    remote.bufferedBytes -= front.getResult()->objsize();
+    _bufferedBytes -= front.getResult()->objsize();
+
+    if (!remote.hasNext() && remote.cbHandle.isValid()) {
+        remote.waitStart = _executor->now();
+    }
+
+    return front;
+}
+
+bool AsyncResultsMerger::_shouldPrefetch(WithLock) {
+    return !_params->sort.isEmpty() && _params->tailableMode == TailableMode::kNormal &&
+        _bufferedBytes < internalQueryMaxPrefetchedBytesPerMerge.load();
+}
+
 Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
@@ -361,6 +408,9 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    if (!remote.hasNext()) {
+        remote.waitStart = _executor->now();
+    }
     return Status::OK();
 }
 
@@ -396,9 +446,12 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
             return remote.status;
         }
 
-        if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
+        if ((!remote.hasNext() || _shouldPrefetch(lk)) && !remote.exhausted() &&
+            !remote.cbHandle.isValid()) {
             // If this remote is not exhausted and there is no outstanding request for it, schedule
-            // work to retrieve the next batch.
+            // work to retrieve the next batch. A sorted merge also asks the remotes which still
+            // have results buffered, so that their next batches are on the way by the time the
+            // merge needs them.
             auto nextBatchStatus = _askForNextBatch(lk, i);
             if (!nextBatchStatus.isOK()) {
                 return nextBatchStatus;
@@ -487,7 +540,12 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
                                               CbData const& cbData,
                                               size_t remoteIndex) {
     // Got a response from remote, so indicate we are no longer waiting for one.
-    _remotes[remoteIndex].cbHandle = executor::TaskExecutor::CallbackHandle();
+    auto& remote = _remotes[remoteIndex];
+    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    if (remote.waitStart) {
+        remote.waitTime += _executor->now() - *remote.waitStart;
+        remote.waitStart = boost::none;
+    }
 
     //  On shutdown, there is no need to process the response.
     if (_lifecycleState != kAlive) {
@@ -498,7 +556,7 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
     try {
         _processBatchResults(lk, cbData.response, remoteIndex);
     } catch (DBException const& e) {
-        _remotes[remoteIndex].status = e.toStatus();
+        remote.status = e.toStatus();
     }
     _signalCurrentEventIfReady(lk);  // Wake up anyone waiting on '_currentEvent'.
 }
@@ -533,6 +591,10 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         // Clear the results buffer and cursor id.
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        std::queue<std::string> emptyEncodedSortKeys;
+        std::swap(remote.encodedSortKeys, emptyEncodedSortKeys);
+        _bufferedBytes -= remote.bufferedBytes;
+        remote.bufferedBytes = 0;
         remote.cursorId = 0;
     }
 }
@@ -570,9 +632,12 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
     if (_params->tailableMode == TailableMode::kTailable && !remote.hasNext()) {
         invariant(_remotes.size() == 1);
         _eofNext = true;
-    } else if (!remote.hasNext() && !remote.exhausted() && _lifecycleState == kAlive) {
+    } else if ((!remote.hasNext() || _shouldPrefetch(lk)) && !remote.exhausted() &&
+               _lifecycleState == kAlive) {
         // If this is normal or tailable-awaitData cursor and we still don't have anything buffered
         // after receiving this batch, we can schedule work to retrieve the next batch right away.
+        // A sorted merge asks for the next batch as soon as this one arrives, unless the results
+        // buffered by the whole merge already use up the prefetch budget.
         remote.status = _askForNextBatch(lk, remoteIndex);
     }
 }
@@ -582,6 +647,10 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     updateRemoteMetadata(&remote, response);
+
+    // A prefetched batch may arrive while the remote still has results buffered, in which case
+    // the remote is already on the merge queue.
+    const bool hadBufferedResults = remote.hasNext();
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (!_params->sort.isEmpty() &&
@@ -594,14 +663,22 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
             return false;
         }
 
+        if (_sortKeyOrdering) {
+            const KeyString encodedSortKey(
+                KeyString::kLatestVersion, extractSortKey(obj), *_sortKeyOrdering);
+            remote.encodedSortKeys.emplace(encodedSortKey.getBuffer(), encodedSortKey.getSize());
+        }
+
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
+        remote.bufferedBytes += obj.objsize();
+        _bufferedBytes += obj.objsize();
         ++remote.fetchedCount;
     }
 
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the
     // merge queue.
-    if (!_params->sort.isEmpty() && !response.getBatch().empty()) {
+    if (!_params->sort.isEmpty() && !response.getBatch().empty() && !hadBufferedResults) {
         _mergeQueue.push(remoteIndex);
     }
     return true;
@@ -680,6 +757,15 @@ executor::TaskExecutor::EventHandle AsyncResultsMerger::kill(OperationContext* o
     return _killCursorsScheduledEvent;
 }
 
+std::vector<Milliseconds> AsyncResultsMerger::getRemoteWaitTimes() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    std::vector<Milliseconds> waitTimes;
+    for (const auto& remote : _remotes) {
+        waitTimes.push_back(remote.waitTime);
+    }
+    return waitTimes;
+}
+
 //
 // AsyncResultsMerger::RemoteCursorData
 //
@@ -712,6 +798,10 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 //
 
 bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+    if (_compareEncodedSortKeys) {
+        return _remotes[lhs].encodedSortKeys.front() > _remotes[rhs].encodedSortKeys.front();
+    }
+
     const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
     const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
 
@@ -35,6 +35,7 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
@@ -66,6 +67,9 @@ class CursorResponse;
  * must be sorted, we pass the sort through to the remote nodes and then merge the sorted streams.
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
+ * So that the merge does not stall on every batch of the slowest remote, a sorted merge asks each
+ * remote for its next batch as soon as the previous one arrives, for as long as the results
+ * buffered across all remotes stay under internalQueryMaxPrefetchedBytesPerMerge.
  *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
@@ -202,6 +206,12 @@ public:
      */
     executor::TaskExecutor::EventHandle kill(OperationContext* opCtx);
 
+    /**
+     * Returns, for each remote in the order in which they were added, the total time the merge has
+     * spent with no results buffered from that remote while waiting for its next batch.
+     */
+    std::vector<Milliseconds> getRemoteWaitTimes();
+
 private:
     /**
      * We instantiate one of these per remote host. It contains the buffer of results we've
@@ -255,6 +265,13 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // If the merge compares encoded sort keys, the KeyString encoding of the sort key of each
+        // result in 'docBuffer', in the same order.
+        std::queue<std::string> encodedSortKeys;
+
+        // The total BSON size of the results in 'docBuffer'.
+        long long bufferedBytes = 0;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -265,12 +282,21 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // Set while 'docBuffer' is empty and a request for the next batch is outstanding, to the
+        // time at which the merge started waiting on this remote.
+        boost::optional<Date_t> waitStart;
+
+        // The total time the merge has spent waiting on this remote.
+        Milliseconds waitTime{0};
     };
 
     class MergingComparator {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
-            : _remotes(remotes), _sort(sort) {}
+        MergingComparator(const std::vector<RemoteCursorData>& remotes,
+                          const BSONObj& sort,
+                          bool compareEncodedSortKeys)
+            : _remotes(remotes), _sort(sort), _compareEncodedSortKeys(compareEncodedSortKeys) {}
 
         bool operator()(const size_t& lhs, const size_t& rhs);
 
@@ -278,6 +304,9 @@ private:
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj& _sort;
+
+        // Whether to compare the KeyString encodings of the sort keys rather than the sort keys.
+        bool _compareEncodedSortKeys;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -300,6 +329,19 @@ private:
      */
     Status _askForNextBatch(WithLock, size_t remoteIndex);
 
+    /**
+     * Returns true if we should ask a remote for its next batch even though it still has buffered
+     * results, because the merge is sorted and the results buffered by the merge are under the
+     * prefetch budget.
+     */
+    bool _shouldPrefetch(WithLock);
+
+    /**
+     * Removes the next buffered result of the remote at 'remoteIndex' and returns it. Starts timing
+     * the wait on that remote if this empties its buffer while its next batch is outstanding.
+     */
+    ClusterQueryResult _popNextResult(WithLock, size_t remoteIndex);
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -392,10 +434,17 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
+    // Set if there is a sort and its sort keys can be encoded as KeyStrings, in which case the
+    // merge compares the encoded keys with memcmp instead of comparing the BSON sort keys.
+    const boost::optional<Ordering> _sortKeyOrdering;
+
     // The top of this priority queue is the index into '_remotes' for the remote host that has the
     // next document to return, according to the sort order. Used only if there is a sort.
     std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
 
+    // The total BSON size of the results buffered across all remotes, which bounds prefetching.
+    long long _bufferedBytes = 0;
+
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
@@ -45,4 +45,9 @@ extern AtomicBool internalQueryAlwaysMergeOnPrimaryShard;
 // of merging on mongoS will always do so.
 extern AtomicBool internalQueryProhibitMergingOnMongoS;
 
+// The number of bytes of results a sorted merge on mongos may buffer, across all of its remote
+// cursors, before it stops asking them for their next batches ahead of need. A value of 0 disables
+// prefetching, so that each remote is only asked for a batch once its previous one is used up.
+extern AtomicInt32 internalQueryMaxPrefetchedBytesPerMerge;
+
 }  // namespace mongo
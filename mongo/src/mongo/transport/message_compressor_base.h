@@ -32,6 +32,7 @@
 #include "mongo/base/status_with.h"
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/util/duration.h"
 
 #include <type_traits>
 
@@ -40,6 +41,9 @@ enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
+    // Compressor ids are part of the OP_COMPRESSED wire format. Upstream hands them out from 3
+    // upwards (3 is zstd), so ids added only in this tree start at 128 to stay clear of them.
+    kZlibDictionary = 128,
     kExtended = 255,
 };
 
@@ -114,6 +118,31 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the total time spent in compressData
+     */
+    Microseconds getCompressorTime() const {
+        return Microseconds(_compressMicros.loadRelaxed());
+    }
+
+    /*
+     * This returns the total time spent in decompressData
+     */
+    Microseconds getDecompressorTime() const {
+        return Microseconds(_decompressMicros.loadRelaxed());
+    }
+
+    /*
+     * Called by the MessageCompressorManager to account for the time spent in compressData and
+     * decompressData
+     */
+    void counterHitCompressTime(Microseconds elapsed) {
+        _compressMicros.addAndFetch(durationCount<Microseconds>(elapsed));
+    }
+
+    void counterHitDecompressTime(Microseconds elapsed) {
+        _decompressMicros.addAndFetch(durationCount<Microseconds>(elapsed));
+    }
 
 protected:
     /*
@@ -148,5 +177,8 @@ private:
 
     AtomicInt64 _decompressBytesIn;
     AtomicInt64 _decompressBytesOut;
+
+    AtomicInt64 _compressMicros;
+    AtomicInt64 _decompressMicros;
 };
 }  // namespace mongo
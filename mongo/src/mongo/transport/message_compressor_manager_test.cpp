@@ -233,6 +233,11 @@ TEST(ZlibMessageCompressor, Fidelity) {
     checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>());
 }
 
+TEST(ZlibDictionaryMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZlibDictionaryMessageCompressor>());
+}
+
 TEST(SnappyMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<SnappyMessageCompressor>());
 }
@@ -241,6 +246,32 @@ TEST(ZlibMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
 }
 
+TEST(ZlibDictionaryMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZlibDictionaryMessageCompressor>());
+}
+
+TEST(ZlibDictionaryMessageCompressor, SmallCommandsCompressBetterThanWithoutDictionary) {
+    const auto command = BSON("find"
+                              << "coll"
+                              << "filter"
+                              << BSON("_id" << OID::gen())
+                              << "lsid"
+                              << BSON("id" << BSONBinData("0123456789abcdef", 16, newUUID))
+                              << "$db"
+                              << "test");
+    ConstDataRange input(command.objdata(), command.objsize());
+
+    auto compressedSize = [&](MessageCompressorBase& compressor) {
+        std::vector<char> buffer(compressor.getMaxCompressedSize(input.length()));
+        return assertOk(compressor.compressData(input, DataRange(buffer.data(), buffer.size())));
+    };
+
+    ZlibMessageCompressor zlib;
+    ZlibDictionaryMessageCompressor zlibDictionary;
+    ASSERT_LT(compressedSize(zlibDictionary), compressedSize(zlib));
+    ASSERT_EQ(zlibDictionary.getCompressorBytesIn(), command.objsize());
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
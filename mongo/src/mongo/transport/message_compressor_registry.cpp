@@ -54,6 +54,8 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "snappy"_sd;
         case MessageCompressor::kZlib:
             return "zlib"_sd;
+        case MessageCompressor::kZlibDictionary:
+            return "zlibDictionary"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
@@ -31,13 +31,60 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/init.h"
+#include "mongo/bson/bsontypes.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/util/scopeguard.h"
 
 #include <zlib.h>
 
 namespace mongo {
+namespace {
+
+/*
+ * The preset dictionary of the "zlibDictionary" compressor. Both ends of a connection must use the
+ * same bytes, so they are part of the wire protocol: a different dictionary needs a new compressor
+ * id and name rather than an edit here.
+ */
+const std::string& presetDictionary() {
+    static const std::string dictionary = [] {
+        // The type each field usually holds and its name, as they appear in a BSON element. zlib
+        // finds matches near the end of the dictionary most cheaply, so the most common come last.
+        const std::pair<BSONType, const char*> fields[] = {
+            {Object, "writeConcern"},   {NumberInt, "w"},          {NumberInt, "wtimeout"},
+            {Object, "$readPreference"}, {String, "mode"},         {String, "aggregate"},
+            {Array, "pipeline"},        {NumberInt, "batchSize"},  {Object, "projection"},
+            {Object, "sort"},           {NumberLong, "limit"},     {String, "delete"},
+            {Array, "deletes"},         {String, "update"},        {Array, "updates"},
+            {Object, "q"},              {Object, "u"},             {Bool, "upsert"},
+            {Bool, "multi"},            {NumberInt, "nModified"},  {String, "insert"},
+            {Array, "documents"},       {Bool, "ordered"},         {NumberInt, "n"},
+            {String, "find"},           {Object, "filter"},        {NumberLong, "getMore"},
+            {String, "collection"},     {Object, "cursor"},        {Array, "firstBatch"},
+            {Array, "nextBatch"},       {NumberLong, "id"},        {NumberLong, "txnNumber"},
+            {Object, "lsid"},           {BinData, "id"},           {Object, "o2"},
+            {Object, "o"},              {BinData, "ui"},           {Date, "wall"},
+            {NumberInt, "v"},           {NumberLong, "h"},         {NumberLong, "t"},
+            {bsonTimestamp, "ts"},      {String, "op"},            {String, "ns"},
+            {Object, "$clusterTime"},   {bsonTimestamp, "clusterTime"},
+            {Object, "signature"},      {BinData, "hash"},         {NumberLong, "keyId"},
+            {bsonTimestamp, "operationTime"},
+            {String, "$db"},            {NumberDouble, "ok"},      {jstOID, "_id"},
+        };
+
+        std::string out;
+        for (const auto& field : fields) {
+            out.push_back(static_cast<char>(field.first));
+            out.append(field.second);
+            out.push_back('\0');
+        }
+        return out;
+    }();
+    return dictionary;
+}
+
+}  // namespace
 
 ZlibMessageCompressor::ZlibMessageCompressor() : MessageCompressorBase(MessageCompressor::kZlib) {}
 
@@ -77,6 +124,75 @@ StatusWith<std::size_t> ZlibMessageCompressor::decompressData(ConstDataRange inp
     return {output.length()};
 }
 
+ZlibDictionaryMessageCompressor::ZlibDictionaryMessageCompressor()
+    : MessageCompressorBase(MessageCompressor::kZlibDictionary) {}
+
+std::size_t ZlibDictionaryMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    // The zlib header grows by the id of the dictionary.
+    return ::compressBound(inputSize) + sizeof(uint32_t);
+}
+
+StatusWith<std::size_t> ZlibDictionaryMessageCompressor::compressData(ConstDataRange input,
+                                                                      DataRange output) {
+    const auto& dictionary = presetDictionary();
+
+    z_stream stream{};
+    if (::deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return Status{ErrorCodes::BadValue, "Could not compress input"};
+    }
+    ON_BLOCK_EXIT([&] { ::deflateEnd(&stream); });
+
+    if (::deflateSetDictionary(&stream,
+                               reinterpret_cast<const Bytef*>(dictionary.data()),
+                               dictionary.size()) != Z_OK) {
+        return Status{ErrorCodes::BadValue, "Could not compress input"};
+    }
+
+    stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+    stream.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    stream.avail_out = output.length();
+    if (::deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        return Status{ErrorCodes::BadValue, "Could not compress input"};
+    }
+
+    counterHitCompress(input.length(), stream.total_out);
+    return {stream.total_out};
+}
+
+StatusWith<std::size_t> ZlibDictionaryMessageCompressor::decompressData(ConstDataRange input,
+                                                                        DataRange output) {
+    const auto& dictionary = presetDictionary();
+
+    z_stream stream{};
+    stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+    if (::inflateInit(&stream) != Z_OK) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+    ON_BLOCK_EXIT([&] { ::inflateEnd(&stream); });
+
+    stream.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    stream.avail_out = output.length();
+
+    // inflate() asks for the dictionary once it has read the zlib header.
+    int ret = ::inflate(&stream, Z_FINISH);
+    if (ret == Z_NEED_DICT) {
+        if (::inflateSetDictionary(&stream,
+                                   reinterpret_cast<const Bytef*>(dictionary.data()),
+                                   dictionary.size()) != Z_OK) {
+            return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+        }
+        ret = ::inflate(&stream, Z_FINISH);
+    }
+
+    if (ret != Z_STREAM_END) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+
+    counterHitDecompress(input.length(), stream.total_out);
+    return {stream.total_out};
+}
 
 MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
                           ("EndStartupOptionHandling"),
@@ -84,6 +200,8 @@ MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
 (InitializerContext* context) {
     auto& compressorRegistry = MessageCompressorRegistry::get();
     compressorRegistry.registerImplementation(stdx::make_unique<ZlibMessageCompressor>());
+    compressorRegistry.registerImplementation(
+        stdx::make_unique<ZlibDictionaryMessageCompressor>());
     return Status::OK();
 }
 }  // namespace mongo
@@ -40,5 +40,21 @@ public:
     StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
 };
 
+/*
+ * Compresses with zlib, primed with a preset dictionary of the field names that commands, their
+ * replies and oplog entries are made of. Small messages, which gain little from being compressed
+ * on their own, then compress about as well as the middle of a large one.
+ */
+class ZlibDictionaryMessageCompressor final : public MessageCompressorBase {
+public:
+    ZlibDictionaryMessageCompressor();
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+};
+
 
 }  // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/service_context_noop.h"
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -105,6 +106,23 @@ protected:
     std::unique_ptr<ServiceExecutorSynchronous> executor;
 };
 
+class ServiceExecutorThreadPerCoreFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = stdx::make_unique<ServiceContextNoop>();
+        setGlobalServiceContext(std::move(scOwned));
+
+        std::vector<std::shared_ptr<asio::io_context>> ioContexts;
+        for (int i = 0; i < 2; i++) {
+            ioContexts.push_back(std::make_shared<asio::io_context>());
+        }
+        executor = stdx::make_unique<ServiceExecutorThreadPerCore>(getGlobalServiceContext(),
+                                                                   std::move(ioContexts));
+    }
+
+    std::unique_ptr<ServiceExecutorThreadPerCore> executor;
+};
+
 void scheduleBasicTask(ServiceExecutor* exec, bool expectSuccess) {
     stdx::condition_variable cond;
     stdx::mutex mutex;
@@ -145,6 +163,58 @@ TEST_F(ServiceExecutorSynchronousFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorThreadPerCoreFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, IdleWorkerStealsFromBlockedWorker) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool blockerRunning = false;
+    bool releaseBlocker = false;
+    bool followUpRan = false;
+
+    // The blocking task queues a follow-up task on its own worker and waits for it to run, which
+    // only happens if the other worker steals it.
+    auto followUp = [&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        followUpRan = true;
+        cond.notify_all();
+    };
+    ASSERT_OK(executor->schedule(
+        [&] {
+            ASSERT_OK(executor->schedule(followUp, ServiceExecutor::kEmptyFlags));
+
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            blockerRunning = true;
+            cond.notify_all();
+            cond.wait(lk, [&] { return releaseBlocker; });
+        },
+        ServiceExecutor::kEmptyFlags));
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    cond.wait(lk, [&] { return blockerRunning; });
+    cond.wait(lk, [&] { return followUpRan; });
+    releaseBlocker = true;
+    cond.notify_all();
+    lk.unlock();
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    auto stats = bob.obj()["serviceExecutorTaskStats"].Obj();
+    ASSERT_EQ(2, stats["workers"].Array().size());
+    ASSERT_GTE(stats["totalStolen"].numberLong(), 1);
+}
 
 }  // namespace
 }  // namespace mongo
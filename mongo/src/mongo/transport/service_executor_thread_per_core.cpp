@@ -0,0 +1,376 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_thread_per_core.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/stringutils.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// The number of workers, and of io_contexts accepted connections are spread across. -1 means one
+// per available core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(threadPerCoreServiceExecutorNumWorkers, int, -1);
+
+// Whether each worker thread is bound to a core of its own.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(threadPerCoreServiceExecutorPinThreads, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(threadPerCoreServiceExecutorRecursionLimit, int, 8);
+
+// How long an idle worker sleeps in its io_context before it looks for work to steal again. Idle
+// workers are woken up early when there is work for them.
+constexpr Milliseconds kIdleWait{10};
+
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "threadPerCore"_sd;
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kTasksQueued = "tasksQueued"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kWorkers = "workers"_sd;
+constexpr auto kQueueDepth = "queueDepth"_sd;
+constexpr auto kExecuted = "executed"_sd;
+constexpr auto kStolen = "stolen"_sd;
+
+}  // namespace
+
+thread_local ServiceExecutorThreadPerCore* ServiceExecutorThreadPerCore::_localExecutor = nullptr;
+thread_local ServiceExecutorThreadPerCore::Worker* ServiceExecutorThreadPerCore::_localWorker =
+    nullptr;
+thread_local int ServiceExecutorThreadPerCore::_localRecursionDepth = 0;
+
+size_t ServiceExecutorThreadPerCore::numWorkersFromConfig() {
+    int value = threadPerCoreServiceExecutorNumWorkers;
+    if (value <= 0) {
+        ProcessInfo pi;
+        value = pi.getNumAvailableCores().value_or(pi.getNumCores());
+        value = std::max(value, 1);
+        threadPerCoreServiceExecutorNumWorkers = value;
+        log() << "No worker count configured for executor. Using number of cores: " << value;
+    }
+    return static_cast<size_t>(value);
+}
+
+ServiceExecutorThreadPerCore::ServiceExecutorThreadPerCore(
+    ServiceContext* ctx, std::vector<std::shared_ptr<asio::io_context>> ioContexts) {
+    invariant(!ioContexts.empty());
+    for (auto& ioContext : ioContexts) {
+        _workers.push_back(stdx::make_unique<Worker>(std::move(ioContext)));
+    }
+}
+
+ServiceExecutorThreadPerCore::~ServiceExecutorThreadPerCore() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorThreadPerCore::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    for (size_t i = 0; i < _workers.size(); i++) {
+        _numRunningWorkerThreads.addAndFetch(1);
+        Status status = launchServiceWorkerThread([this, i] { _workerThreadRoutine(i); });
+        if (!status.isOK()) {
+            _numRunningWorkerThreads.subtractAndFetch(1);
+            return status;
+        }
+    }
+
+    return Status::OK();
+}
+
+Status ServiceExecutorThreadPerCore::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+    for (auto& worker : _workers) {
+        worker->ioContext->stop();
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_shutdownMutex);
+    bool result = _shutdownCondition.wait_for(lk, timeout.toSystemDuration(), [this] {
+        return _numRunningWorkerThreads.load() == 0;
+    });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "threadPerCore executor couldn't shutdown all worker threads within time limit.");
+}
+
+Status ServiceExecutorThreadPerCore::schedule(Task task, ScheduleFlags flags) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    _totalQueued.addAndFetch(1);
+
+    const bool onWorker = (_localExecutor == this);
+    if (onWorker && (flags & kMayRecurse) &&
+        (_localRecursionDepth < threadPerCoreServiceExecutorRecursionLimit.loadRelaxed())) {
+        _runTask(_localWorker, task);
+        return Status::OK();
+    }
+
+    // Tasks scheduled by a worker, usually from the completion of a network operation on a
+    // socket it owns, stay with it. Others, such as the first task of a new connection, are
+    // handed out round robin.
+    Worker* worker =
+        onWorker ? _localWorker : _workers[_nextWorker.fetchAndAdd(1) % _workers.size()].get();
+    _enqueue(worker, std::move(task));
+    return Status::OK();
+}
+
+void ServiceExecutorThreadPerCore::_enqueue(Worker* worker, Task task) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+        worker->queue.push_back(std::move(task));
+    }
+    const int queueDepth = worker->queueDepth.addAndFetch(1);
+
+    if (worker->sleeping.load()) {
+        _wakeUp(worker);
+        return;
+    }
+
+    // The worker is busy. Unless it queued the task for itself and has nothing else waiting, let a
+    // sleeping worker steal the task rather than wait for the busy one.
+    if (_sleepingWorkers.load() > 0 && (_localWorker != worker || queueDepth > 1)) {
+        for (auto& other : _workers) {
+            if (other->sleeping.load()) {
+                _wakeUp(other.get());
+                break;
+            }
+        }
+    }
+}
+
+void ServiceExecutorThreadPerCore::_wakeUp(Worker* worker) {
+    worker->ioContext->post([] {});
+}
+
+bool ServiceExecutorThreadPerCore::_popTask(Worker* worker, Task* task) {
+    if (worker->queueDepth.load() == 0)
+        return false;
+
+    stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+    if (worker->queue.empty())
+        return false;
+
+    *task = std::move(worker->queue.front());
+    worker->queue.pop_front();
+    worker->queueDepth.subtractAndFetch(1);
+    return true;
+}
+
+bool ServiceExecutorThreadPerCore::_stealTask(size_t workerId, Task* task) {
+    for (size_t i = 1; i < _workers.size(); i++) {
+        Worker* victim = _workers[(workerId + i) % _workers.size()].get();
+        if (_popTask(victim, task)) {
+            _workers[workerId]->stolen.addAndFetch(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ServiceExecutorThreadPerCore::_pollBusyWorker(size_t workerId) {
+    // A worker that is running a task isn't watching its io_context, so network completions for
+    // its other connections would wait for the task to finish. Any thread may run them instead.
+    for (size_t i = 1; i < _workers.size(); i++) {
+        Worker* victim = _workers[(workerId + i) % _workers.size()].get();
+        if (!victim->sleeping.load() && victim->ioContext->poll_one() > 0) {
+            _workers[workerId]->stolen.addAndFetch(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ServiceExecutorThreadPerCore::_hasQueuedTasks() const {
+    for (const auto& worker : _workers) {
+        if (worker->queueDepth.load() > 0)
+            return true;
+    }
+    return false;
+}
+
+void ServiceExecutorThreadPerCore::_runTask(Worker* worker, const Task& task) {
+    ++_localRecursionDepth;
+    const auto guard = MakeGuard([worker] {
+        --_localRecursionDepth;
+        worker->executed.addAndFetch(1);
+    });
+    task();
+}
+
+void ServiceExecutorThreadPerCore::_pinToCore(size_t workerId) {
+#if defined(__linux__)
+    // Pick the workerId'th of the cores this process may run on.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        warning() << "Couldn't pin worker " << workerId << " to a core: " << errnoWithDescription();
+        return;
+    }
+
+    const int numAllowed = CPU_COUNT(&allowed);
+    if (numAllowed == 0)
+        return;
+
+    int target = static_cast<int>(workerId % numAllowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed) || target-- > 0)
+            continue;
+
+        cpu_set_t pinned;
+        CPU_ZERO(&pinned);
+        CPU_SET(cpu, &pinned);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned);
+        if (err != 0) {
+            warning() << "Couldn't pin worker " << workerId << " to core " << cpu << ": "
+                      << errnoWithDescription(err);
+        }
+        return;
+    }
+#endif
+}
+
+void ServiceExecutorThreadPerCore::_workerThreadRoutine(size_t workerId) {
+    {
+        std::string threadName = str::stream() << "worker-core-" << workerId;
+        setThreadName(threadName);
+    }
+
+    if (threadPerCoreServiceExecutorPinThreads) {
+        _pinToCore(workerId);
+    }
+
+    Worker* const worker = _workers[workerId].get();
+    _localExecutor = this;
+    _localWorker = worker;
+
+    const auto guard = MakeGuard([this] {
+        _localExecutor = nullptr;
+        _localWorker = nullptr;
+
+        stdx::lock_guard<stdx::mutex> lk(_shutdownMutex);
+        if (_numRunningWorkerThreads.subtractAndFetch(1) == 0) {
+            _shutdownCondition.notify_all();
+        }
+    });
+
+    asio::io_context::work work(*worker->ioContext);
+    while (_isRunning.load()) {
+        try {
+            Task task;
+            if (_popTask(worker, &task) || _stealTask(workerId, &task)) {
+                _runTask(worker, task);
+                continue;
+            }
+
+            // Run whatever network completions are ready without blocking.
+            if (worker->ioContext->poll() > 0 || _pollBusyWorker(workerId)) {
+                continue;
+            }
+
+            // Going to sleep is announced before checking for queued tasks one last time, so that
+            // a task queued concurrently either is seen here or wakes this worker up.
+            worker->sleeping.store(true);
+            _sleepingWorkers.addAndFetch(1);
+            const auto sleepGuard = MakeGuard([this, worker] {
+                _sleepingWorkers.subtractAndFetch(1);
+                worker->sleeping.store(false);
+            });
+
+            if (!_hasQueuedTasks()) {
+                worker->ioContext->run_one_for(kIdleWait.toSystemDuration());
+            }
+        } catch (const std::exception& e) {
+            log() << "Exception escaped worker thread " << workerId << ": " << e.what();
+        } catch (...) {
+            log() << "Unknown exception escaped worker thread " << workerId;
+        }
+
+        if (worker->ioContext->stopped() && _isRunning.load()) {
+            worker->ioContext->restart();
+        }
+    }
+}
+
+void ServiceExecutorThreadPerCore::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+
+    int64_t totalExecuted = 0;
+    int64_t totalStolen = 0;
+    int tasksQueued = 0;
+    BSONArrayBuilder workers;
+    for (const auto& worker : _workers) {
+        const auto queueDepth = worker->queueDepth.load();
+        const auto executed = worker->executed.load();
+        const auto stolen = worker->stolen.load();
+        workers.append(BSON(kQueueDepth << queueDepth << kExecuted << executed << kStolen
+                                        << stolen));
+        tasksQueued += queueDepth;
+        totalExecuted += executed;
+        totalStolen += stolen;
+    }
+
+    section << kExecutorLabel << kExecutorName                                        //
+            << kTotalQueued << _totalQueued.load()                                    //
+            << kTotalExecuted << totalExecuted                                        //
+            << kTotalStolen << totalStolen                                            //
+            << kTasksQueued << tasksQueued                                            //
+            << kThreadsRunning << static_cast<int>(_numRunningWorkerThreads.load())  //
+            << kWorkers << workers.arr();
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/service_executor.h"
+
+namespace asio {
+class io_context;
+}  // namespace asio
+
+namespace mongo {
+namespace transport {
+
+/**
+ * An ASIO-based ServiceExecutor that runs one worker thread per core. Each worker owns an
+ * io_context, which the transport layer spreads accepted connections across, and a queue of
+ * tasks. Tasks scheduled from a worker stay on that worker, so a connection's I/O completions and
+ * the tasks they schedule run on the core that owns its socket. Idle workers steal queued tasks
+ * from the other workers and poll the io_contexts of busy workers before they go to sleep.
+ *
+ * The number of workers is fixed, so a task that blocks for a long time holds up the
+ * connections of its worker until other workers steal them.
+ */
+class ServiceExecutorThreadPerCore final : public ServiceExecutor {
+public:
+    /**
+     * Returns the number of workers, and of io_contexts the transport layer should create, as
+     * configured by the threadPerCoreServiceExecutorNumWorkers server parameter.
+     */
+    static size_t numWorkersFromConfig();
+
+    ServiceExecutorThreadPerCore(ServiceContext* ctx,
+                                 std::vector<std::shared_ptr<asio::io_context>> ioContexts);
+    ~ServiceExecutorThreadPerCore();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+private:
+    struct Worker {
+        explicit Worker(std::shared_ptr<asio::io_context> ioCtx) : ioContext(std::move(ioCtx)) {}
+
+        const std::shared_ptr<asio::io_context> ioContext;
+
+        stdx::mutex mutex;
+        std::deque<Task> queue;  // Guarded by 'mutex'.
+
+        AtomicWord<int> queueDepth{0};
+        AtomicWord<bool> sleeping{false};
+        AtomicWord<int64_t> executed{0};
+        AtomicWord<int64_t> stolen{0};
+    };
+
+    void _workerThreadRoutine(size_t workerId);
+    void _pinToCore(size_t workerId);
+    void _enqueue(Worker* worker, Task task);
+    void _wakeUp(Worker* worker);
+    bool _popTask(Worker* worker, Task* task);
+    bool _stealTask(size_t workerId, Task* task);
+    bool _pollBusyWorker(size_t workerId);
+    bool _hasQueuedTasks() const;
+    void _runTask(Worker* worker, const Task& task);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    AtomicWord<bool> _isRunning{false};
+    AtomicWord<size_t> _nextWorker{0};
+    AtomicWord<int> _sleepingWorkers{0};
+    AtomicWord<int64_t> _totalQueued{0};
+
+    stdx::mutex _shutdownMutex;
+    stdx::condition_variable _shutdownCondition;
+    AtomicWord<size_t> _numRunningWorkerThreads{0};
+
+    static thread_local ServiceExecutorThreadPerCore* _localExecutor;
+    static thread_local Worker* _localWorker;
+    static thread_local int _localRecursionDepth;
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -80,13 +80,16 @@ TransportLayerASIO::Options::Options(const ServerGlobalParams* params)
 TransportLayerASIO::TransportLayerASIO(const TransportLayerASIO::Options& opts,
                                        ServiceEntryPoint* sep)
     //boost::asio::io_contextIO¼ѭ
-    : _workerIOContext(std::make_shared<asio::io_context>()),
-      _acceptorIOContext(stdx::make_unique<asio::io_context>()),
+    : _acceptorIOContext(stdx::make_unique<asio::io_context>()),
 #ifdef MONGO_CONFIG_SSL
       _sslContext(nullptr),
 #endif
       _sep(sep),
       _listenerOptions(opts) {
+    invariant(opts.numWorkerIOContexts > 0);
+    for (size_t i = 0; i < opts.numWorkerIOContexts; i++) {
+        _workerIOContexts.push_back(std::make_shared<asio::io_context>());
+    }
 }
 
 TransportLayerASIO::~TransportLayerASIO() = default;
@@ -376,7 +379,11 @@ void TransportLayerASIO::shutdown() {
 //TransportLayerManager::createWithConfig
 const std::shared_ptr<asio::io_context>& TransportLayerASIO::getIOContext() {
 	//IOģTransportLayerManager::createWithConfigиƸadaptivesynchronous
-    return _workerIOContext; 
+    return _workerIOContexts.front();
+}
+
+const std::vector<std::shared_ptr<asio::io_context>>& TransportLayerASIO::getIOContexts() {
+    return _workerIOContexts;
 }
 
 //TransportLayerASIO::start  acceptorTransportLayerASIO::startе_acceptorIOContextǹ
@@ -407,7 +414,9 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
 
 	//ӵյacceptCbTransportLayerASIO::start  listen߳
 	//basic_socket_acceptor::async_acceptacceptCbصTransportLayerASIO::start ->io_context::run
-    acceptor.async_accept(*_workerIOContext, std::move(acceptCb)); //첽մӵlisten̵߳acceptCbص
+    auto& workerIOContext =
+        _workerIOContexts[_nextWorkerIOContext.fetchAndAdd(1) % _workerIOContexts.size()];
+    acceptor.async_accept(*workerIOContext, std::move(acceptCb)); //첽մӵlisten̵߳acceptCbص
 }
 
 #ifdef MONGO_CONFIG_SSL
@@ -30,6 +30,7 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "mongo/config.h"
 #include "mongo/db/server_options.h"
@@ -89,6 +90,7 @@ public:
         Mode transportMode = Mode::kSynchronous;  // whether accepted sockets should be put into
         //Ĭƣnet.maxIncomingConnections                                         // non-blocking mode after they're accepted
         size_t maxConns = DEFAULT_MAX_CONN;       // maximum number of active connections
+        size_t numWorkerIOContexts = 1;           // io_contexts to spread accepted sockets over
     };
 
     TransportLayerASIO(const Options& opts, ServiceEntryPoint* sep);
@@ -116,6 +118,12 @@ public:
 
     const std::shared_ptr<asio::io_context>& getIOContext();
 
+    /**
+     * Returns the io_contexts that accepted sockets are spread across, one per worker of the
+     * threadPerCore service executor.
+     */
+    const std::vector<std::shared_ptr<asio::io_context>>& getIOContexts();
+
 private:
     class ASIOSession;
     class ASIOTicket;
@@ -133,11 +141,12 @@ private:
 
     stdx::mutex _mutex;
 
-    // There are two IO contexts that are used by TransportLayerASIO. The _workerIOContext
-    // contains all the accepted sockets and all normal networking activity. The
-    // _acceptorIOContext contains all the sockets in _acceptors.
+    // There are two kinds of IO contexts that are used by TransportLayerASIO. The
+    // _workerIOContexts contain all the accepted sockets and all normal networking activity,
+    // spread round robin across them. There is only one unless the service executor runs one
+    // per core. The _acceptorIOContext contains all the sockets in _acceptors.
     //
-    // TransportLayerASIO should never call run() on the _workerIOContext.
+    // TransportLayerASIO should never call run() on the _workerIOContexts.
     // In synchronous mode, this will cause a massive performance degradation due to
     // unnecessary wakeups on the asio thread for sockets we don't intend to interact
     // with asynchronously. The additional IO context avoids registering those sockets
@@ -192,7 +201,8 @@ private:
     //TransportLayerASIO::TransportLayerASIOй  
     //worker IO fd2ģTransportLayerManager::createWithConfigбֵServiceExecutorAdaptive._ioContext   
     //fd2շServiceExecutorAdaptive::schedule, ServiceExecutorSynchronous߳ģʽҪ_workerIOContextΪһ̺߳һsessionӦServiceExecutorAdaptiveģʽǶ̸߳IOҪ
-    std::shared_ptr<asio::io_context> _workerIOContext; 
+    std::vector<std::shared_ptr<asio::io_context>> _workerIOContexts;
+    AtomicWord<size_t> _nextWorkerIOContext{0};
 
     // ЧµӼTransportLayerASIO::start    
     //_acceptorIOContext_acceptorsTransportLayerASIO::setup 
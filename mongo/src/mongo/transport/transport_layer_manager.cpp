@@ -36,6 +36,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
 #include "mongo/transport/transport_layer_legacy.h"
@@ -160,6 +161,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         } else if (config->serviceExecutor == "synchronous") {
             //һһ߳ģͣҲͬģʽ
             opts.transportMode = transport::Mode::kSynchronous;
+        } else if (config->serviceExecutor == "threadPerCore") {
+            opts.transportMode = transport::Mode::kAsynchronous;
+            opts.numWorkerIOContexts = ServiceExecutorThreadPerCore::numWorkersFromConfig();
         } else {
             MONGO_UNREACHABLE;
         }
@@ -175,6 +179,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         } else if (config->serviceExecutor == "synchronous") { //ͬʽ
         	//һһ߳ģͶӦִServiceExecutorSynchronous
             ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorSynchronous>(ctx));
+        } else if (config->serviceExecutor == "threadPerCore") {
+            ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorThreadPerCore>(
+                ctx, transportLayerASIO->getIOContexts()));
         }
 		//transportLayerASIOתΪtransportLayer
         transportLayer = std::move(transportLayerASIO);
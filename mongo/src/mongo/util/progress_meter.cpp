@@ -48,6 +48,7 @@ void ProgressMeter::reset(unsigned long long total, int secondsBetween, int chec
     _done = 0;
     _hits = 0;
     _lastTime = (int)time(0);
+    _timer.reset();
 
     _active = true;
 }
@@ -87,6 +88,11 @@ bool ProgressMeter::hit(int n) {
     return true;
 }
 
+double ProgressMeter::ratePerSecond() const {
+    const long long micros = _timer.micros();
+    return micros > 0 ? _done * 1000000.0 / micros : 0;
+}
+
 string ProgressMeter::toString() const {
     if (!_active)
         return "";
@@ -40,4 +40,14 @@ TEST(ProgressMeterTest, ToString) {
     ASSERT_FALSE(ProgressMeter(1).toString().empty());
 }
 
+TEST(ProgressMeterTest, RateStartsOverOnReset) {
+    ProgressMeter pm(100);
+    pm.hit(50);
+    ASSERT_GTE(pm.ratePerSecond(), 0);
+
+    pm.reset(100);
+    ASSERT_EQUALS(0U, pm.done());
+    ASSERT_EQUALS(0, pm.ratePerSecond());
+}
+
 }  // namespace